@@ -0,0 +1,43 @@
+#version 450
+
+// . PackedVertex_t : see its VertexLayout_t for the formats, the fixed function does the unorm / snorm / half
+layout(location = 0) in vec4 position; // xyz inside the mesh bounds, w is the bitangent sign (0 : negative)
+layout(location = 1) in vec2 uv;
+layout(location = 2) in vec2 normalOct;
+layout(location = 3) in vec2 tangentOct;
+layout(location = 4) in vec4 color;
+// . MeshBounds_t : instance rate, picked by 'firstInstance'
+layout(location = 5) in vec3 boundsMin;
+layout(location = 6) in vec3 boundsExtent;
+
+layout(location = 0) out vec3 fVertex;
+layout(location = 1) out vec2 fUv;
+layout(location = 2) out vec3 fNormal;
+layout(location = 3) out vec3 fTangent;
+layout(location = 4) out vec3 fBitanget;
+layout(location = 5) out vec3 fColor;
+
+vec3 octDecode(vec2 e)
+{
+  vec3  n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+  float t = max(-n.z, 0.0);
+  n.x += n.x >= 0.0 ? -t : t;
+  n.y += n.y >= 0.0 ? -t : t;
+  return normalize(n);
+}
+
+void main()
+{
+  vec3 vertex  = boundsMin + position.xyz * boundsExtent;
+  vec3 normal  = octDecode(normalOct);
+  vec3 tangent = octDecode(tangentOct);
+
+  gl_Position = vec4(vertex, 1.0);
+
+  fVertex   = vertex;
+  fUv       = uv;
+  fNormal   = normal;
+  fTangent  = tangent;
+  fBitanget = cross(normal, tangent) * (position.w * 2.0 - 1.0);
+  fColor    = color.rgb;
+}
@@ -0,0 +1,4 @@
+#version 450
+
+// . Depth only : there's no color output, so the pass should not rely on the color attachment
+void main() {}
@@ -0,0 +1,9 @@
+#version 450
+
+// . Depth / shadow passes : 'positionsOnly' pipelines, only the position stream is fetched
+layout(location = 0) in vec3 vertex;
+
+void main()
+{
+  gl_Position = vec4(vertex, 1.0);
+}
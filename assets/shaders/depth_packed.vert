@@ -0,0 +1,11 @@
+#version 450
+
+// . Depth / shadow passes on packed arenas : the position and its mesh bounds, nothing else
+layout(location = 0) in vec4 position;
+layout(location = 1) in vec3 boundsMin;
+layout(location = 2) in vec3 boundsExtent;
+
+void main()
+{
+  gl_Position = vec4(boundsMin + position.xyz * boundsExtent, 1.0);
+}
@@ -2,7 +2,10 @@
 
 #include <algorithm>
 
+#include <functional>
 #include <set>
+#include <string>
+#include <utility>
 #include <vector>
 #include <unordered_map>
 
@@ -36,9 +39,55 @@ std::set<T2> mapValsUnique(std::unordered_map<T1, T2> m)
   return std::set { o.begin(), o.end() };
 }
 
+// . 64-bit content hash, 8 bytes per step : for change detection, not cryptographic
+uint64_t hash64(void const *data, size_t bytes, uint64_t seed = 0xcbf29ce484222325ull);
+
 }  // namespace vo::algo
 
 namespace vo::files
 {
 std::vector<char> read(std::string const &filepath);
+
+// . Read-only view of a whole file, paged in on demand by the OS and unmapped on destruction : no copies
+class Mapping_t
+{
+public:
+  Mapping_t() = default;
+  ~Mapping_t();
+  Mapping_t(Mapping_t &&other) noexcept;
+  Mapping_t &operator=(Mapping_t &&other) noexcept;
+  Mapping_t(Mapping_t const &)            = delete;
+  Mapping_t &operator=(Mapping_t const &) = delete;
+
+  inline char const *data() const { return mData; }
+  inline size_t      size() const { return mSize; }
+  inline explicit    operator bool() const { return mData != nullptr; }
+
+private:
+  friend Mapping_t map(std::string const &filepath);
+  void             reset();
+
+  char const *mData   = nullptr;
+  size_t      mSize   = 0u;
+  void       *mHandle = nullptr;  // Windows : the mapping object
+};
+
+// . Empty mapping when the file can't be opened or is empty. Hinted for a sequential read-ahead
+Mapping_t map(std::string const &filepath);
 }  // namespace vo::files
+
+namespace vo::jobs
+{
+// . Runs 'fn(i)' for every i in [0, count) across the hardware threads, the caller included.
+//   Items are handed out one at a time, so uneven items (i.e. meshes of different sizes) balance.
+//   Nested calls run on the calling thread : the outer loop already keeps every thread busy.
+//   The threads are started once and reused. Loops started from several threads at once are queued side by
+//   side : each caller works on its own items, the threads on the oldest loop with items left.
+void parallelFor(size_t count, std::function<void(size_t)> const &fn);
+
+// . [first, last) of the 'chunk'-th of 'chunkCount' even parts of 'count' items
+inline std::pair<size_t, size_t> chunkRange(size_t count, size_t chunk, size_t chunkCount)
+{
+  return { count * chunk / chunkCount, count * (chunk + 1) / chunkCount };
+}
+}  // namespace vo::jobs
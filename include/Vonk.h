@@ -1,11 +1,20 @@
 #pragma once
 
-#include <stack>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <span>
 #include <vector>
 #include <unordered_map>
 
 #include "_vulkan.h"
+#include "VonkAllocator.h"
+#include "VonkCooked.h"
+#include "VonkGraph.h"
+#include "VonkRegistry.h"
+#include "VonkResidency.h"
 #include "VonkTypes.h"
+#include "VonkUploader.h"
 
 namespace vonk
 {  //
@@ -19,55 +28,207 @@ public:
   void cleanup();
   void drawFrame();
   void waitDevice();
-  void addPipeline(DrawPipelineData_t const &ci);
+  void waitUploads();
+
+  // . Transient data : valid until this frame's submit is done
+  StagingSlice_t allocateTransient(VkDeviceSize size);
+  // . Pipelines : recreated with the swapchain from the data given here
+  //   'ci.recordPerFrame' : its commands are recorded again each frame, from the frame's own command pool
+  PipelineHandle_t addPipeline(DrawPipelineData_t const &ci);
+  void             removePipeline(PipelineHandle_t handle);
+  // . Inside a render graph pass's 'record' : its pipelines have no commands of their own
+  void             bindPipeline(VkCommandBuffer cmd, PipelineHandle_t handle);
+
+  // . Render graph : once set, 'drawFrame' records its passes instead of the active pipeline. Compiled here and
+  //   again with the swapchain. From the thread calling 'drawFrame', before adding the pipelines of its passes
+  //   The passes' 'record' may draw evicted meshes : restored on the way, their uploads go out before the frame's submit
+  void         setRenderGraph(RenderGraph_t graph);
+  VkRenderPass graphRenderPass(uint32_t pass) const;
+  // . Culled or backbuffer : VK_NULL_HANDLE. Stale after the swapchain changes
+  VkImageView  graphImageView(GraphImage_t image) const;
 
   inline auto currentFormat() const { return mSwapChain.colorFormat; }
+  inline auto memoryStats() const { return vonk::getAllocatorStats(mAllocator); }
+  inline auto memoryBudget() const { return vonk::getMemoryBudget(mAllocator); }
+  inline auto memoryReport() const { return vonk::getMemoryReport(mAllocator); }
+  inline auto uploadStats() const { return mUploader.stats; }
+  inline auto vertexFormat() const { return mGeometry.format; }
+  // . Before 'init' : the geometry arena is created with it, pipelines drawing meshes have to use the same
+  //   'splitStreams' : positions on their own stream, for the 'positionsOnly' pipelines (depth / shadows)
+  inline void setVertexFormat(VertexFormat_t format, bool splitStreams = false)
+  {
+    sVertexFormat = format;
+    sSplitStreams = splitStreams;
+  }
+
+  // . Mesh optimization logs : the overdraw after every pass too, not just around them (slower loads)
+  inline void setPassOverdraw(bool enabled) { sPassOverdraw = enabled; }
 
   inline void iterScenes() { mActivePipeline = (mActivePipeline + 1) % mPipelines.size(); }
 
-  // . Meshes
-  std::vector<Mesh_t> read3DFile(
+  // . Meshes : 'optimizationLevel' 1 dedup, 2 + vertex cache, 3 + overdraw, 4 + vertex fetch
+  //   'lodLevels' : levels of detail built for each mesh, the base one included (1 : none)
+  //   Safe from loader threads : the CPU passes run unlocked, the arena / uploads under 'mGeometryMutex'
+  std::vector<MeshHandle_t> read3DFile(
     std::string const &filepath,
     uint32_t           optimizationLevel               = 3,
     bool               recalculateUVs                  = false,
     bool               recalculateNormals              = false,
-    bool               recalculateTangentsAndBitangets = false);
-  Mesh_t const &createMesh(std::vector<uint32_t> const &indices, std::vector<Vertex_t> const &vertices);
-  void          drawMesh(VkCommandBuffer cmd, Mesh_t const &mesh);
-  void          drawMeshes(VkCommandBuffer cmd, std::vector<Mesh_t> const &meshes);
-
-  // . Shaders
-  DrawShader_t const &
+    bool               recalculateTangentsAndBitangets = false,
+    uint32_t           lodLevels                       = sMaxMeshLods);
+  // . Cooked meshes : 'read3DFile' done once, stored in the arena's vertex format (see 'setVertexFormat')
+  //   'readCookedFile' maps the file and uploads it as is. Empty if it is missing or stale : cook it again
+  bool                      cook3DFile(
+    std::string const &filepath,
+    std::string const &cookedPath,
+    uint32_t           optimizationLevel               = 3,
+    bool               recalculateUVs                  = false,
+    bool               recalculateNormals              = false,
+    bool               recalculateTangentsAndBitangets = false,
+    uint32_t           lodLevels                       = sMaxMeshLods);
+  std::vector<MeshHandle_t> readCookedFile(std::string const &cookedPath);
+  // . Meshes are evictable : they keep a CPU copy and come back on their next draw
+  //   'createMesh' keeps the indices in the order given, for 'updateMeshIndices' : no meshlets, drawn whole
+  //   Handles of destroyed meshes go stale : 'getMesh' is empty for them and drawing them aborts
+  MeshHandle_t          createMesh(std::vector<uint32_t> const &indices, std::vector<Vertex_t> const &vertices);
+  void                  destroyMesh(MeshHandle_t handle);
+  std::optional<Mesh_t> getMesh(MeshHandle_t handle) const;
+  // . 'positionsOnly' : for the pipelines created with it, only the position stream gets bound
+  //   'drawMesh' only draws : 'bindMeshes' once on 'cmd' before, and again after any other draw call of these
+  void          bindMeshes(VkCommandBuffer cmd, bool positionsOnly = false);
+  void          drawMesh(VkCommandBuffer cmd, MeshHandle_t mesh);
+  void          drawMeshes(VkCommandBuffer cmd, std::vector<MeshHandle_t> const &meshes, bool positionsOnly = false);
+  // . Cluster culling : the meshlets of every mesh are tested on the GPU before the pipeline's commands, on the frames
+  //   a pipeline created with 'DrawPipelineData_t::clusterCulling' is drawn
+  //   'drawMeshClusters' draws just the survivors (the meshes without meshlets whole), from the last camera given
+  void          drawMeshClusters(VkCommandBuffer cmd, std::vector<MeshHandle_t> const &meshes, bool positionsOnly = false);
+  // . Split passes (see 'CommandBufferData_t::chunkCommands') : 'touchMeshes' on the calling thread, once per frame
+  //   before 'drawFrame', then each chunk draws its part of the copies. No locks : they stay valid for the frame
+  std::vector<Mesh_t> touchMeshes(std::vector<MeshHandle_t> const &meshes);
+  void                drawMeshes(VkCommandBuffer cmd, std::span<Mesh_t const> touched, bool positionsOnly = false);
+  void                drawMeshClusters(VkCommandBuffer cmd, std::span<Mesh_t const> touched, bool positionsOnly = false);
+  void          setClusterCulling(glm::mat4 const &viewProj, glm::vec3 const &eye, bool cones = true);
+  // . Levels of detail : 'drawMeshes' / 'drawMeshClusters' pick the coarsest one whose error stays under 'maxPixels'
+  //   on screen, from the distance of 'eye' to each mesh's bounding sphere. 'maxPixels' 0 : always the base level
+  //   The meshlets only cover the base level : the coarser ones are drawn whole
+  void          setLodSelection(glm::vec3 const &eye, float fovY, float viewportHeight, float maxPixels = 1.f);
+  // . GPU-driven draws : one mesh per instance, repeats welcome. Every frame the instances are culled against the
+  //   'setClusterCulling' camera and get their level as 'setLodSelection' says, all on the GPU : 'drawInstances'
+  //   draws the survivors with one indirect count draw per index width, the CPU cost stays the same however many
+  //   there are. Full arenas get the instance's index as 'firstInstance', for per-instance data of the shaders' own
+  void          setInstances(std::vector<MeshHandle_t> const &instances);
+  //   'late' : inside 'DrawPipelineData_t::lateCommands', the instances the second occlusion test let through
+  void          drawInstances(VkCommandBuffer cmd, bool positionsOnly = false, bool late = false) const;
+  // . Occlusion culling of the instances, on a depth pyramid : first against the previous frame's depth, then the
+  //   occluded ones again against this frame's, once the active pipeline has drawn. Only with the swapchain's render
+  //   pass and a pipeline with 'lateCommands', from the second frame drawn that way on
+  void          setOcclusionCulling(bool enabled);
+  // . Of the last frame done : how many instances each test rejected
+  inline auto   instanceStats() const { return mInstanceStats; }
+  // . Textures : sampled, evictable as the meshes when their heap gets close to its budget. 'texels' tightly packed
+  //   'touchTexture' on every frame sampling it, before its descriptors are used : it is restored first when evicted,
+  //   and the view changes then (i.e. write them again when it differs from the last one)
+  TextureHandle_t createTexture(VkExtent2D extent, VkFormat format, std::vector<uint8_t> texels);
+  void            destroyTexture(TextureHandle_t handle);
+  Texture_t       touchTexture(TextureHandle_t handle);
+  // . Dynamic meshes : 'byteOffset' is relative to the mesh's first vertex / index, copied on the next frame
+  //   Vertices go in the arena's format : packed ones relative to the bounds the mesh was created with
+  //   Split arenas : 'updateMeshVertices' writes the attributes stream and 'updateMeshPositions' the positions
+  void          updateMeshVertices(MeshHandle_t mesh, VkDeviceSize byteOffset, DataInfo_t di);
+  void          updateMeshPositions(MeshHandle_t mesh, VkDeviceSize byteOffset, DataInfo_t di);
+  //   Indices go in the mesh's 'indexType' : uint16_t when it was created with up to 65536 vertices
+  void          updateMeshIndices(MeshHandle_t mesh, VkDeviceSize byteOffset, DataInfo_t di);
+
+  // . Shaders : the names point to the last one created with them
+  DrawShaderHandle_t
     createDrawShader(std::string const &keyName, std::string const &vertexName, std::string const &fragmentName);
-  DrawShader_t const &getDrawShader(std::string const &keyName);
-  Shader_t const &    createComputeShader(std::string const &name);
-  Shader_t const &    getComputeShader(std::string const &name);
+  DrawShaderHandle_t getDrawShader(std::string const &keyName);
+  ShaderHandle_t     createComputeShader(std::string const &name);
+  ShaderHandle_t     getComputeShader(std::string const &name);
 
 private:
-  void recreateSwapChain();
-  void destroySwapChainDependencies();
+  // . The creation data is kept : the pipeline is built again with the swapchain
+  struct PipelineEntry_t
+  {
+    DrawPipeline_t     pipeline;
+    DrawPipelineData_t ci;
+  };
+
+  void         recreateSwapChain();
+  void         destroySwapChainDependencies();
+  void         createDepthPyramid();
+  void         buildPipeline(PipelineEntry_t &entry);
+  void         makeRoomForMesh(uint32_t indexSlots, uint32_t vertexCount, uint32_t meshletCount);
+  MeshHandle_t addMesh(Mesh_t const &created, MeshData_t data);
+  MeshHandle_t addMesh(Mesh_t const &created, CookedMeshes_t const &cooked, uint32_t index);
+  MeshHandle_t addMesh(Mesh_t const &created, std::function<Mesh_t()> recreate);
+  Mesh_t       touchMesh(MeshHandle_t handle);
+  void         unbindMeshes(std::span<VkCommandBuffer const> cmds);
+  void         refreshInstanceMeshes();
+  void     recordMeshDraws(VkCommandBuffer cmd, std::span<Mesh_t const> touched, bool positionsOnly, bool clusters) const;
+  uint32_t selectLod(Mesh_t const &mesh) const;
 
   // Context:
-  Instance_t  mInstance;
-  Gpu_t       mGpu;
-  Device_t    mDevice;
-  SwapChain_t mSwapChain;
+  Instance_t    mInstance;
+  Gpu_t         mGpu;
+  Device_t      mDevice;
+  Allocator_t   mAllocator;
+  Uploader_t    mUploader;
+  Residency_t   mResidency;
+  StagingRing_t mStagingRing;
+  SwapChain_t   mSwapChain;
 
   // Meshes:
-  std::unordered_map<uint32_t, Mesh_t> mMeshes;
-  std::stack<uint32_t>                 mRemovedMeshes;
+  // . 'mGeometryMutex' : arena, uploader, staging, residency and updates. Recursive, reclaiming space evicts
+  //   meshes / textures from inside an allocation. Taken before any registry lock
+  GeometryArena_t       mGeometry;
+  Registry_t<Mesh_t>    mMeshes;
+  Registry_t<Texture_t> mTextures;
+  std::recursive_mutex  mGeometryMutex;
+  BufferUpdates_t       mMeshUpdates;
+  ComputePipeline_t     mClusterCullPipeline;
+  ClusterCull_t         mClusterCull;
+  ComputePipeline_t     mInstanceCullPipeline;
+  InstanceDraws_t       mInstanceDraws;
+  InstanceStats_t       mInstanceStats;
+  glm::mat4             mCullViewProj     = glm::mat4(1.f);
+  ComputePipeline_t     mDepthPyramidPipeline;
+  DepthPyramid_t        mDepthPyramid;
+  VkRenderPass          mLateRenderPass   = VK_NULL_HANDLE; // Loads what the swapchain's one left
+  bool                  mOcclusion        = false;
+  bool                  mOcclusionPrimed  = false;          // The last frame left a depth to test against
+  glm::vec3             mLodEye           = glm::vec3(0.f);
+  float                 mLodPixelsPerUnit = 0.f;
+  float                 mLodMaxPixels     = 0.f;
 
   // Shaders:
-  std::unordered_map<std::string, DrawShader_t> mDrawShaders;
-  std::unordered_map<std::string, Shader_t>     mComputeShaders;
+  Registry_t<DrawShader_t>                            mDrawShaders;
+  Registry_t<Shader_t>                                mComputeShaders;
+  std::unordered_map<std::string, DrawShaderHandle_t> mDrawShaderNames;
+  std::unordered_map<std::string, ShaderHandle_t>     mComputeShaderNames;
+  std::mutex                                          mShaderNamesMutex;
 
   // Pipelines:
-  std::vector<DrawPipeline_t>     mPipelines;
-  std::vector<DrawPipelineData_t> mPipelinesCI;
-  uint32_t                        mActivePipeline = 0u;
+  Registry_t<PipelineEntry_t, DrawPipeline_t> mPipelines;
+  uint32_t                                    mActivePipeline = 0u; // Into the packed pipelines
+  RenderGraph_t                               mRenderGraph;
+
+  // Frames:
+  uint32_t                                         mCurrFrame = 0u;
+  std::vector<FrameCommands_t>                     mFrameCommands;   // One per frame in flight
+  std::unordered_map<VkCommandBuffer, VkIndexType> mBoundIndexTypes; // Since each one's last 'bindMeshes', until reset : geometry lock
 
   // Settings:
-  uint32_t sInFlightMaxFrames = 3;
+  uint32_t       sInFlightMaxFrames    = 3;
+  uint32_t       sGeometryMaxVertices  = 1u << 20;
+  uint32_t       sGeometryMaxIndices   = 1u << 22;
+  uint32_t       sMaxDrawInstances     = 1u << 18;
+  uint32_t       sMaxInstanceMeshes    = 1u << 12; // Distinct meshes among the instances
+  uint32_t       sStagingBytesPerFrame = 8u * 1024u * 1024u;
+  uint32_t       sMaxRecordingThreads  = 8u; // Worker pools per frame for the split passes, the hardware threads at most
+  VertexFormat_t sVertexFormat         = VertexFormat_t::Full;
+  bool           sSplitStreams         = false;
+  bool           sPassOverdraw         = false;
 
   // Resources:
 
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "_vulkan.h"
+#include "VonkTypes.h"
+
+#include "Macros.h"
+
+namespace vonk
+{ //
+
+//-----------------------------------------------
+
+// ALLOCATOR
+//  Big per-memory-type blocks split with a buddy scheme, so a resource costs a
+//  node on an existing block instead of a 'vkAllocateMemory' call. Resources the
+//  driver wants on its own memory (or bigger than half a block) get a dedicated one.
+
+Allocator_t createAllocator(Device_t const &device, VkDeviceSize blockSize = Allocator_t::sDefaultBlockSize);
+
+void destroyAllocator(Allocator_t &allocator);
+
+// . 'preferred' flags are dropped when no memory type has them along with the required ones
+Allocation_t allocateBufferMemory(
+    Allocator_t          &allocator,
+    VkBuffer              buffer,
+    MemoryCategory_t      category,
+    VkMemoryPropertyFlags properties,
+    VkMemoryPropertyFlags preferred = 0);
+Allocation_t allocateImageMemory(
+    Allocator_t          &allocator,
+    VkImage               image,
+    MemoryCategory_t      category,
+    VkMemoryPropertyFlags properties,
+    VkMemoryPropertyFlags preferred = 0);
+
+// . Not bound : for several images placed at offsets of it, i.e. aliased transient attachments
+//   'reqs' : the union of theirs, the size covering the highest offset + size
+Allocation_t allocateAliasedMemory(
+    Allocator_t                &allocator,
+    VkMemoryRequirements const &reqs,
+    MemoryCategory_t            category,
+    VkMemoryPropertyFlags       properties);
+
+void freeMemory(Allocator_t &allocator, Allocation_t &allocation);
+
+// . The memory heap it lives on : what freeing it gives room back to
+uint32_t allocationHeap(Allocator_t const &allocator, Allocation_t const &allocation);
+
+AllocatorStats_t getAllocatorStats(Allocator_t const &allocator);
+
+// . Per-heap budget and usage : from VK_EXT_memory_budget when available, our own bookkeeping otherwise
+MemoryBudget_t getMemoryBudget(Allocator_t const &allocator);
+
+void logAllocatorStats(Allocator_t const &allocator);
+
+// . Live bytes and counts per category and per memory type
+MemoryReport_t getMemoryReport(Allocator_t const &allocator);
+
+void logMemoryReport(Allocator_t const &allocator);
+
+// . Lists every allocation still alive (i.e. at shutdown). Returns how many
+uint32_t logMemoryLeaks(Allocator_t const &allocator);
+
+//-----------------------------------------------
+
+} // namespace vonk
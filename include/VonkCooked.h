@@ -0,0 +1,84 @@
+#pragma once
+
+#include "VonkTypes.h"
+
+#include "Macros.h"
+#include "Utils.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace vonk
+{ //
+
+//-----------------------------------------------
+
+// COOKED MESHES
+//  Meshes after the whole import pipeline, stored the way the geometry arena
+//  holds them : indices in their 32-bit slots (16-bit pairs when they fit),
+//  vertices already in the VertexFormat_t, meshlets and LODs local to each mesh.
+//  Loading maps the file and hands its payloads straight to the upload path.
+//  Layout : header, mesh table, then the index / vertex / position / meshlet
+//  payloads, each one contiguous for all the meshes and 'sCookedAlignment' aligned.
+
+constexpr uint32_t sCookedMagic     = 0x434D4B56u; // "VKMC"
+constexpr uint32_t sCookedVersion   = 1u;
+constexpr uint64_t sCookedAlignment = 64u;
+
+struct CookedHeader_t
+{
+    uint32_t magic           = sCookedMagic;
+    uint32_t version         = sCookedVersion;
+    uint32_t format          = 0u; // VertexFormat_t
+    uint32_t split           = 0u;
+    uint32_t stride          = 0u; // Checked against the reader's : catches layout changes without a version bump
+    uint32_t positionStride  = 0u;
+    uint32_t meshCount       = 0u;
+    uint32_t indexSlots      = 0u;
+    uint32_t vertexCount     = 0u;
+    uint32_t meshletCount    = 0u;
+    uint64_t meshesOffset    = 0u; // Bytes from the start of the file
+    uint64_t indicesOffset   = 0u;
+    uint64_t verticesOffset  = 0u;
+    uint64_t positionsOffset = 0u;
+    uint64_t meshletsOffset  = 0u;
+};
+
+// . Ranges inside the payloads of the file
+struct CookedMesh_t
+{
+    uint32_t                            firstSlot    = 0u;
+    uint32_t                            indexCount   = 0u; // All the levels
+    uint32_t                            firstVertex  = 0u;
+    uint32_t                            vertexCount  = 0u;
+    uint32_t                            firstMeshlet = 0u;
+    uint32_t                            meshletCount = 0u;
+    uint32_t                            lodCount     = 1u;
+    uint32_t                            pad          = 0u;
+    std::array<MeshLod_t, sMaxMeshLods> lods         = {}; // Relative to the mesh's first index
+    MeshBounds_t                        bounds;            // The packed vertices are relative to it
+    glm::vec4                           sphere = glm::vec4(0.f);
+};
+
+// . A mapped file, shared : the evicted meshes are restored from it
+struct CookedMeshes_t
+{
+    std::shared_ptr<vo::files::Mapping_t const> file;
+    CookedHeader_t const                       *header = nullptr;
+    CookedMesh_t const                         *meshes = nullptr;
+
+    inline explicit operator bool() const { return header != nullptr; }
+    inline char const *payload(uint64_t offset) const { return file->data() + offset; }
+};
+
+// . Written next to 'filepath' and renamed over it, false if it can't be written
+bool cookMeshes(std::string const &filepath, std::vector<MeshData_t> const &meshes, VertexFormat_t format, bool split);
+
+// . Empty when missing, truncated, or cooked by another version or for another 'format' / 'split' than the
+//   geometry arena's : the source is to be imported or cooked again
+CookedMeshes_t openCookedMeshes(std::string const &filepath, VertexFormat_t format, bool split);
+
+//-----------------------------------------------
+
+} // namespace vonk
@@ -0,0 +1,150 @@
+#pragma once
+
+#include "_vulkan.h"
+#include "VonkTypes.h"
+
+#include "Macros.h"
+
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace vonk
+{ //
+
+//-----------------------------------------------
+
+// RENDER GRAPH
+//  Passes declare the images they use, the graph works out the rest when compiled :
+//  passes whose writes reach nothing the frame keeps (the backbuffer, images marked
+//  'keep', passes marked 'keep') are dropped, the others run after the writers of
+//  what they use, each one behind a single barrier batch with the layout transitions
+//  it needs, and the transient images share one allocation, overlapping whenever
+//  their lifetimes don't. Each pass with attachments gets a render pass of its own :
+//  the first write of a frame clears, the store is skipped when nothing reads after.
+//  An image is read once all its writes are done, in their declaration order.
+
+using GraphImage_t = uint32_t; // Index into RenderGraph_t::images
+
+enum class GraphUse_t : uint32_t
+{
+    ColorAttachment, // Written
+    DepthAttachment, // Written, depth tested
+    DepthRead,       // Depth tested only, still as attachment
+    Sampled,         // Fragment / compute shaders
+    StorageRead,     // Compute
+    StorageWrite,    // Compute
+    TransferSrc,
+    TransferDst,
+};
+
+struct GraphImageDesc_t
+{
+    std::string           name;
+    VkFormat              format  = VK_FORMAT_UNDEFINED;
+    VkExtent2D            extent  = {0u, 0u}; // {0, 0} : the swapchain's, times 'scale'
+    float                 scale   = 1.f;
+    VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT;
+    VkClearValue          clear   = {};
+    bool                  keep    = false; // Read outside the graph or on the next frame : never culled nor aliased
+};
+
+// . What a pass does to one of its images, from the barrier's point of view
+struct GraphAccess_t
+{
+    VkImageLayout        layout = VK_IMAGE_LAYOUT_UNDEFINED;
+    VkPipelineStageFlags stages = 0u;
+    VkAccessFlags        access = 0u;
+};
+
+struct GraphBarrier_t
+{
+    GraphImage_t  image     = UINT32_MAX;
+    VkImageLayout oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    VkImageLayout newLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    VkAccessFlags srcAccess = 0u;
+    VkAccessFlags dstAccess = 0u;
+};
+
+// . Its barriers run before it (or after the last pass, for the final ones) : one vkCmdPipelineBarrier
+struct GraphBarriers_t
+{
+    std::vector<GraphBarrier_t> barriers;
+    VkPipelineStageFlags        srcStages = 0u;
+    VkPipelineStageFlags        dstStages = 0u;
+};
+
+struct GraphPass_t
+{
+    std::string                                      name;
+    std::vector<std::pair<GraphImage_t, GraphUse_t>> uses;
+    std::function<void(VkCommandBuffer)>             record = nullptr; // Inside its render pass when it has attachments
+    bool                                             keep   = false;   // Side effects out of the graph (i.e. buffers)
+
+    // . Compiled
+    VkRenderPass               renderPass = VK_NULL_HANDLE;
+    std::vector<VkFramebuffer> frameBuffers; // One per swapchain image when it draws on the backbuffer
+    std::vector<VkClearValue>  clears;
+    VkExtent2D                 extent = {0u, 0u};
+    GraphBarriers_t            before;
+};
+
+struct GraphImageState_t
+{
+    VkImage              image      = VK_NULL_HANDLE;
+    VkImageView          view       = VK_NULL_HANDLE;
+    VkExtent2D           extent     = {0u, 0u};
+    VkFormat             format     = VK_FORMAT_UNDEFINED;
+    VkImageAspectFlags   aspect     = 0u;
+    VkImageUsageFlags    usage      = 0u;
+    VkMemoryRequirements reqs       = {};
+    VkDeviceSize         offset     = 0u;         // Into RenderGraph_t::memory
+    uint32_t             firstUse   = UINT32_MAX; // Into RenderGraph_t::order
+    uint32_t             lastUse    = 0u;
+    GraphAccess_t        lastAccess;              // Where the next frame finds it
+    bool                 primed     = false;      // 'keep' images : written on a previous frame already
+};
+
+struct RenderGraph_t
+{
+    std::vector<GraphImageDesc_t> images;
+    std::vector<GraphPass_t>      passes;
+    GraphImage_t                  backbuffer = UINT32_MAX;
+
+    // . Compiled
+    std::vector<uint32_t>          order; // The passes kept, in execution order
+    std::vector<GraphImageState_t> states;
+    Allocation_t                   memory;
+    GraphBarriers_t                after; // The backbuffer to present, at least
+    VkDeviceSize                   unaliasedBytes = 0u;
+};
+
+// . The swapchain image being drawn : its format and extent are the swapchain's
+GraphImage_t graphBackbuffer(RenderGraph_t &graph);
+
+GraphImage_t addGraphImage(RenderGraph_t &graph, GraphImageDesc_t desc);
+
+// . Returns its index, for 'RenderGraph_t::passes'
+uint32_t addGraphPass(
+    RenderGraph_t                                   &graph,
+    std::string                                      name,
+    std::vector<std::pair<GraphImage_t, GraphUse_t>> uses,
+    std::function<void(VkCommandBuffer)>             record,
+    bool                                             keep = false);
+
+// . Culls, orders, places the images and creates them along with the render passes and framebuffers
+//   Again after the swapchain changes : the views and render passes handed out before go stale
+void compileRenderGraph(Device_t const &device, SwapChain_t const &swapchain, RenderGraph_t &graph);
+
+// . Every pass kept, in order, with its barriers, on the swapchain image 'imageIndex'
+void recordRenderGraph(VkCommandBuffer cmd, RenderGraph_t &graph, SwapChain_t const &swapchain, uint32_t imageIndex);
+
+// . What 'compileRenderGraph' created : the passes and images stay declared, for the next compile
+void destroyRenderGraph(Device_t const &device, RenderGraph_t &graph);
+
+void logRenderGraph(RenderGraph_t const &graph);
+
+//-----------------------------------------------
+
+} // namespace vonk
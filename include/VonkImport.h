@@ -0,0 +1,24 @@
+#pragma once
+
+#include "VonkTypes.h"
+
+#include "Macros.h"
+
+#include <string>
+#include <vector>
+
+namespace vonk
+{ //
+
+//-----------------------------------------------
+
+// IMPORT
+//  glTF 2.0 (.gltf / .glb) into MeshData_t : one per primitive instanced by the
+//  default scene, with the node transforms baked in. Accessors are decoded on
+//  worker threads, straight into Vertex_t. Images are not decoded.
+
+std::vector<MeshData_t> importGltf(std::string const &filepath);
+
+//-----------------------------------------------
+
+} // namespace vonk
@@ -0,0 +1,121 @@
+#pragma once
+
+#include "VonkTypes.h"
+
+#include "Macros.h"
+
+#include <vector>
+
+namespace vonk
+{ //
+
+//-----------------------------------------------
+
+// MESH OPs
+//  CPU passes over MeshData_t, meant for load time. The optimizations keep the
+//  rendered result and only change the order / sharing of the data, the
+//  generators rebuild vertex attributes.
+
+// . Raw counts, so several meshes can be added up before computing the ratios
+struct MeshMetrics_t
+{
+    uint64_t triangles     = 0u;
+    uint64_t cacheMisses   = 0u; // Post-transform FIFO cache of 'sCacheSize' entries
+    uint64_t pixelsShaded  = 0u; // Software raster from the 6 axis directions, depth-tested
+    uint64_t pixelsCovered = 0u;
+
+    static constexpr uint32_t sCacheSize = 16u;
+
+    inline float acmr() const { return triangles ? float(cacheMisses) / float(triangles) : 0.f; }
+    inline float overdraw() const { return pixelsCovered ? float(pixelsShaded) / float(pixelsCovered) : 0.f; }
+};
+
+// . 'overdraw' false : ACMR alone, skipping the rasters (the pixel counts stay 0)
+MeshMetrics_t analyzeMesh(MeshData_t const &mesh, bool overdraw = true);
+
+// . Level 1 : merges bit-identical vertices
+void deduplicateVertices(MeshData_t &mesh);
+
+// . Level 2 : Tipsify triangle order, for the post-transform vertex cache
+void optimizeVertexCache(MeshData_t &mesh);
+
+// . Level 3 : sorts clusters of the cache-optimized order outside-in, bounded ACMR loss ('threshold')
+void optimizeOverdraw(MeshData_t &mesh, float threshold = 1.05f);
+
+// . Level 4 : vertices renumbered in first-use order, unused ones dropped
+void optimizeVertexFetch(MeshData_t &mesh);
+
+// . Applies the first 'level' passes in order, on worker threads, logging the ACMR after each one
+//   The overdraw is logged on the input and after the last pass, after each one too with 'passOverdraw' (it
+//   rasterizes every mesh 6 times, about the cost of a pass)
+void optimizeMeshes(std::vector<MeshData_t> &meshes, uint32_t level, bool passOverdraw = false);
+
+//-----------------------------------------------
+
+// GENERATORs
+//  Face terms are computed a SIMD register of triangles at a time (AVX, SSE or
+//  scalar, whatever the build targets), on corners gathered as SoA blocks first
+//  (in hardware with AVX2), and the vertices gather them from their triangles,
+//  in chunks. 'threaded' spreads the chunks on the worker threads,
+//  false when the caller already runs on one.
+
+// . Smooth, area-weighted : vertices sharing a position share the normal
+void generateNormals(MeshData_t &mesh, bool threaded = true);
+
+// . Box projection over the bounds, the plane picked by the normal
+void generateUVs(MeshData_t &mesh, bool threaded = true);
+
+// . MikkTSpace-style frame around the normal, the handedness as the bitangent direction
+void generateTangents(MeshData_t &mesh, bool threaded = true);
+
+// . Normals, then uvs, then tangents, the ones requested
+void generateAttributes(std::vector<MeshData_t> &meshes, bool uvs, bool normals, bool tangents);
+
+//-----------------------------------------------
+
+// MESHLETs
+//  Clusters for the GPU culling, see 'assets/shaders/cluster_cull.comp'. The
+//  triangles get reordered so each meshlet is a contiguous run of indices : it
+//  grows from its seed over the triangles adding the fewest new vertices, the
+//  earliest in the input on ties. Inside a meshlet the triangles keep their input
+//  order, and the meshlets follow their first triangle's : the vertex cache and
+//  overdraw orders of the optimization passes survive them.
+
+// . Into 'mesh.meshlets' : bounding sphere and normal cone of each one
+void buildMeshlets(MeshData_t &mesh, uint32_t maxVertices = 64u, uint32_t maxTriangles = 124u);
+
+// . One mesh per worker thread
+void buildMeshlets(std::vector<MeshData_t> &meshes);
+
+//-----------------------------------------------
+
+// LODs
+//  Quadric error edge collapses onto the existing vertices, so every level shares
+//  the mesh's vertex range. Borders only slide along themselves and the vertices
+//  on uv / normal seams stay, so the levels keep their outline and attributes.
+
+// . Indices of about 'targetRatio' of the base level triangles, 'outError' the deviation reached (mesh units)
+std::vector<uint32_t> simplifyMesh(MeshData_t const &mesh, float targetRatio, float *outError = nullptr);
+
+// . Appends to 'mesh.indices' up to 'maxLevels' levels (the base included), each at half the triangles of the
+//   previous one, vertex cache optimized. After 'buildMeshlets' : they stay on the base level
+void buildLods(MeshData_t &mesh, uint32_t maxLevels = sMaxMeshLods);
+
+// . One mesh per worker thread
+void buildLods(std::vector<MeshData_t> &meshes, uint32_t maxLevels = sMaxMeshLods);
+
+//-----------------------------------------------
+
+// . The whole import pipeline : attributes -> optimizations up to 'optimizationLevel' -> meshlets -> LODs
+void prepareMeshes(
+    std::vector<MeshData_t> &meshes,
+    uint32_t                 optimizationLevel,
+    bool                     uvs,
+    bool                     normals,
+    bool                     tangents,
+    uint32_t                 lodLevels,
+    bool                     passOverdraw = false);
+
+//-----------------------------------------------
+
+} // namespace vonk
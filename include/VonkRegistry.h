@@ -0,0 +1,184 @@
+#pragma once
+
+#include "VonkTypes.h"
+
+#include "Macros.h"
+
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <utility>
+#include <vector>
+
+namespace vonk
+{ //
+
+//-----------------------------------------------
+
+// REGISTRY
+//  Slot map : the values live packed in insertion order (a removal moves the
+//  last one into the hole), the handles go through a slot that knows where its
+//  value is. Removing bumps the slot's generation, so the handles still around
+//  fail their lookups instead of reaching whatever takes the slot next.
+//  Every operation takes the registry's lock : inserts / removes from loader
+//  threads are safe, and values are read as copies or inside a callback.
+//  'Tag' : the handles' type, when the values carry more than the resource.
+
+template <typename T, typename Tag = T>
+class Registry_t
+{
+public:
+    using Handle = Handle_t<Tag>;
+
+    Handle insert(T value)
+    {
+        std::unique_lock lock{mMutex};
+
+        uint32_t index = mFreeHead;
+        if (index != sNone)
+        {
+            mFreeHead = mSlots[index].dense;
+        }
+        else
+        {
+            index = GetCountU32(mSlots);
+            mSlots.push_back({});
+        }
+
+        auto &slot = mSlots[index];
+        slot.dense = GetCountU32(mValues);
+        mValues.push_back(std::move(value));
+        mOwners.push_back(index);
+        return {index, slot.generation};
+    }
+
+    // . 'removed' : receives the value, i.e. to release what it holds
+    bool erase(Handle handle, T *removed = nullptr)
+    {
+        std::unique_lock lock{mMutex};
+        if (!alive(handle))
+            return false;
+
+        auto      &slot  = mSlots[handle.index];
+        auto const dense = slot.dense;
+        auto const last  = mValues.size() - 1;
+        if (removed)
+            *removed = std::move(mValues[dense]);
+        if (dense != last)
+        {
+            mValues[dense]               = std::move(mValues[last]);
+            mOwners[dense]               = mOwners[last];
+            mSlots[mOwners[dense]].dense = dense;
+        }
+        mValues.pop_back();
+        mOwners.pop_back();
+
+        ++slot.generation;
+        slot.dense = mFreeHead;
+        mFreeHead  = handle.index;
+        return true;
+    }
+
+    bool contains(Handle handle) const
+    {
+        std::shared_lock lock{mMutex};
+        return alive(handle);
+    }
+
+    std::optional<T> get(Handle handle) const
+    {
+        std::shared_lock lock{mMutex};
+        if (!alive(handle))
+            return std::nullopt;
+        return mValues[mSlots[handle.index].dense];
+    }
+
+    // . 'fn(T const &)' / 'fn(T &)' under the lock : false on stale handles
+    template <typename Fn>
+    bool read(Handle handle, Fn &&fn) const
+    {
+        std::shared_lock lock{mMutex};
+        if (!alive(handle))
+            return false;
+        fn(mValues[mSlots[handle.index].dense]);
+        return true;
+    }
+    template <typename Fn>
+    bool update(Handle handle, Fn &&fn)
+    {
+        std::unique_lock lock{mMutex};
+        if (!alive(handle))
+            return false;
+        fn(mValues[mSlots[handle.index].dense]);
+        return true;
+    }
+
+    // . 'fn(Handle, T const &)' / 'fn(Handle, T &)' over the packed values, in order
+    template <typename Fn>
+    void forEach(Fn &&fn) const
+    {
+        std::shared_lock lock{mMutex};
+        for (size_t i = 0; i < mValues.size(); ++i)
+            fn(Handle{mOwners[i], mSlots[mOwners[i]].generation}, mValues[i]);
+    }
+    template <typename Fn>
+    void forEachMut(Fn &&fn)
+    {
+        std::unique_lock lock{mMutex};
+        for (size_t i = 0; i < mValues.size(); ++i)
+            fn(Handle{mOwners[i], mSlots[mOwners[i]].generation}, mValues[i]);
+    }
+
+    // . Of the i-th packed value : the order changes on removals
+    Handle handleAt(size_t i) const
+    {
+        std::shared_lock lock{mMutex};
+        return i < mOwners.size() ? Handle{mOwners[i], mSlots[mOwners[i]].generation} : Handle{};
+    }
+
+    size_t size() const
+    {
+        std::shared_lock lock{mMutex};
+        return mValues.size();
+    }
+
+    // . Removes them all, handing the values back : every handle goes stale
+    std::vector<T> clear()
+    {
+        std::unique_lock lock{mMutex};
+        for (auto const index : mOwners)
+        {
+            auto &slot = mSlots[index];
+            ++slot.generation;
+            slot.dense = mFreeHead;
+            mFreeHead  = index;
+        }
+        mOwners.clear();
+        return std::exchange(mValues, {});
+    }
+
+private:
+    static constexpr uint32_t sNone = UINT32_MAX;
+
+    struct Slot_t
+    {
+        uint32_t dense      = sNone; // Into the values when alive, next free slot when not
+        uint32_t generation = 0u;
+    };
+
+    bool alive(Handle handle) const
+    {
+        return handle.index < mSlots.size() && mSlots[handle.index].generation == handle.generation
+               && mSlots[handle.index].dense < mOwners.size() && mOwners[mSlots[handle.index].dense] == handle.index;
+    }
+
+    mutable std::shared_mutex mMutex;
+    std::vector<T>            mValues;
+    std::vector<uint32_t>     mOwners; // Slot of each value
+    std::vector<Slot_t>       mSlots;
+    uint32_t                  mFreeHead = sNone;
+};
+
+//-----------------------------------------------
+
+} // namespace vonk
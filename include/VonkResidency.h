@@ -0,0 +1,50 @@
+#pragma once
+
+#include "_vulkan.h"
+#include "VonkTypes.h"
+
+#include "Macros.h"
+
+namespace vonk
+{ //
+
+//-----------------------------------------------
+
+// RESIDENCY
+//  Tracks the last frame each evictable resource was used on. When a heap gets
+//  close to its budget (or an allocation fails) the coldest residents are evicted,
+//  skipping the ones the frames in flight may still read, and a later touch
+//  restores them (i.e. re-upload from their CPU copy). Each one lives on the
+//  domain its eviction gives room back to : textures on their memory heap, meshes
+//  on the geometry arena, whose memory stays allocated whatever it holds.
+
+Residency_t createResidency(uint32_t framesInFlight);
+
+void destroyResidency(Residency_t &residency);
+
+uint32_t addResident(
+    Residency_t          &residency,
+    uint32_t              domain,
+    VkDeviceSize          bytes,
+    std::function<void()> evict,
+    std::function<void()> restore);
+
+void removeResident(Residency_t &residency, uint32_t id);
+
+// . Marks it as used on this frame, restoring it first when evicted
+void touchResident(Residency_t &residency, uint32_t id);
+
+// . Never evicted from now on (i.e. its CPU copy went stale)
+void pinResident(Residency_t &residency, uint32_t id);
+
+// . Least recently used first, until at least 'bytes' are freed on 'domain'. Returns the freed bytes
+VkDeviceSize evictResidents(Residency_t &residency, uint32_t domain, VkDeviceSize bytes);
+
+// . Once per frame : advances the frame and brings the heaps over the high watermark down to the low one
+void updateResidency(Residency_t &residency, MemoryBudget_t const &budget);
+
+void logResidency(Residency_t const &residency, MemoryBudget_t const &budget);
+
+//-----------------------------------------------
+
+} // namespace vonk
@@ -1,13 +1,20 @@
 #pragma once
 #include <algorithm>
+#include <bit>
+#include <cstring>
+#include <span>
 #include <unordered_map>
 #include <vector>
 
 #include "Macros.h"
 #include "Utils.h"
+#include "VonkAllocator.h"
+#include "VonkCooked.h"
 #include "VonkToStr.h"
 #include "VonkTypes.h"
 #include "VonkTools.h"
+#include "VonkUploader.h"
+#include "VonkVertex.h"
 #include "VonkWindow.h"
 #include "_vulkan.h"
 
@@ -40,7 +47,22 @@ void destroyDevice(Device_t &device);
 
 // COMMAND POOL
 
-VkCommandPool createCommandPool(Device_t const &device, uint32_t idx);
+VkCommandPool createCommandPool(
+  Device_t const &         device,
+  uint32_t                 idx,
+  VkCommandPoolCreateFlags flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT);
+
+// . One pool per frame in flight, on the graphics queue : reset as a whole instead of buffer by buffer
+//   'workerCount' : pools for the secondaries of the split passes, see 'CommandBufferData_t::chunkCommands'
+FrameCommands_t createFrameCommands(Device_t const &device, uint32_t workerCount);
+
+// . Once the frame's fence is signaled : every buffer of its pools goes back to the initial state
+void resetFrameCommands(Device_t const &device, FrameCommands_t &frame);
+
+// . A secondary per worker pool for the next split pass of the frame, allocated the first time
+std::vector<VkCommandBuffer> nextFrameSecondaries(VkDevice device, FrameCommands_t &frame);
+
+void destroyFrameCommands(Device_t const &device, FrameCommands_t &frame);
 
 //-----------------------------------------------
 
@@ -50,20 +72,26 @@ VkRenderPass createRenderPass(VkDevice device, RenderPassData_t const &rpd);
 
 VkRenderPass createDefaultRenderPass(VkDevice device, VkFormat colorFormat, VkFormat depthFormat);
 
+// . Draws over what the default one left, with its framebuffers : the color is presented after it
+VkRenderPass createLoadRenderPass(VkDevice device, VkFormat colorFormat, VkFormat depthFormat);
+
 //-----------------------------------------------
 
 // TEXTUREs
 
 Texture_t createTexture(
-  VkDevice                                device,
-  VkPhysicalDeviceMemoryProperties const &memProps,
-  VkExtent2D const &                      extent2D,
-  VkFormat const &                        format,
-  VkSampleCountFlagBits const &           samples,
-  VkImageUsageFlags const &               usage,
-  VkImageAspectFlagBits const &           aspectMaskBits);
+  Device_t const &              device,
+  MemoryCategory_t              category,
+  VkExtent2D const &            extent2D,
+  VkFormat const &              format,
+  VkSampleCountFlagBits const & samples,
+  VkImageUsageFlags const &     usage,
+  VkImageAspectFlagBits const & aspectMaskBits);
 
-void destroyTexture(VkDevice device, Texture_t const &tex);
+// . Sampled, from tightly packed texels : uploaded on the transfer queue, see 'uploadImage'
+Texture_t createTexture(Device_t const &device, VkExtent2D const &extent2D, VkFormat format, DataInfo_t texels);
+
+void destroyTexture(Device_t const &device, Texture_t &tex);
 
 bool isEmptyTexture(Texture_t const &tex);
 
@@ -124,156 +152,314 @@ DrawPipeline_t createPipeline(
 
 void destroyPipeline(SwapChain_t const &swapchain, DrawPipeline_t const &pipeline);
 
+// . A render pass per 'ci.commandBuffersData' on 'frameBuffer', into a 'cmd' already begun
+//   'pFrame' : the passes with 'chunkCommands' are recorded from its worker pools on the worker threads
+void recordPipelineCommands(
+  VkCommandBuffer            cmd,
+  DrawPipeline_t const &     pipeline,
+  DrawPipelineData_t const & ci,
+  SwapChain_t const &        swapchain,
+  VkFramebuffer              frameBuffer,
+  FrameCommands_t *          pFrame = nullptr);
+
+// . 'ci.lateCommands' in 'renderPass' (see 'createLoadRenderPass'), with the pipeline bound and its viewports set
+void recordLateCommands(
+  VkCommandBuffer            cmd,
+  DrawPipeline_t const &     pipeline,
+  DrawPipelineData_t const & ci,
+  SwapChain_t const &        swapchain,
+  VkRenderPass               renderPass,
+  VkFramebuffer              frameBuffer);
+
+// . 'bufferCount' storage buffers on bindings [0, bufferCount), see 'bindComputeBuffers'
+//   'images' : one binding each after them, of the type given, see 'bindComputeImage'
+ComputePipeline_t createComputePipeline(
+  Device_t const &                      device,
+  Shader_t const &                      shader,
+  uint32_t                              bufferCount,
+  uint32_t                              pushConstantSize = 0u,
+  std::vector<VkDescriptorType> const & images           = {});
+
+void bindComputeBuffers(Device_t const &device, ComputePipeline_t const &pipeline, std::vector<Buffer_t const *> const &buffers);
+
+// . Into 'set' : the pipeline's own, or any other one allocated with its 'setLayout'
+void bindComputeImage(
+  Device_t const &device, VkDescriptorSet set, uint32_t binding, VkDescriptorType type, VkDescriptorImageInfo const &info);
+
+void destroyComputePipeline(Device_t const &device, ComputePipeline_t &pipeline);
+
 //-----------------------------------------------
 
 // BUFFERs
 
 inline Buffer_t createBuffer(
   Device_t const &      device,
+  MemoryCategory_t      category,
   size_t                elemSize,
   uint32_t              count,
   VkBufferUsageFlags    usage,
-  VkMemoryPropertyFlags properties)
+  VkMemoryPropertyFlags properties,
+  VkMemoryPropertyFlags preferred = 0)
 {
   Buffer_t buffer;
   buffer.size  = elemSize * count;
   buffer.count = count;
+  buffer.usage = usage;
 
-  // . Buffer
+  // . Buffer : the ones touched by the transfer queue are also used on the others
+  auto const uFamilies    = getUniqueQueueFamilies(*device.pGpu);
+  auto const transferBits = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+  bool const concurrent   = (usage & transferBits) and uFamilies.size() > 1;
   VkBufferCreateInfo bufferCI {
-    .sType       = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
-    .size        = buffer.size,
-    .usage       = usage,
-    .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+    .sType                 = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+    .size                  = buffer.size,
+    .usage                 = usage,
+    .sharingMode           = concurrent ? VK_SHARING_MODE_CONCURRENT : VK_SHARING_MODE_EXCLUSIVE,
+    .queueFamilyIndexCount = concurrent ? GetCountU32(uFamilies) : 0,
+    .pQueueFamilyIndices   = concurrent ? GetData(uFamilies) : nullptr,
   };
   VkCheck(vkCreateBuffer(device.handle, &bufferCI, nullptr, &buffer.handle));
 
   // . Memory
-  VkMemoryRequirements memReqs;
-  vkGetBufferMemoryRequirements(device.handle, buffer.handle, &memReqs);
-  VkMemoryAllocateInfo const memAlloc {
-    .sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
-    .allocationSize  = memReqs.size,
-    .memoryTypeIndex = vonk::getMemoryType(device.pGpu->memory, memReqs.memoryTypeBits, properties),
-  };
-  vkAllocateMemory(device.handle, &memAlloc, nullptr, &buffer.memory);
-  vkBindBufferMemory(device.handle, buffer.handle, buffer.memory, 0);
+  buffer.allocation = vonk::allocateBufferMemory(*device.pAllocator, buffer.handle, category, properties, preferred);
 
   return buffer;
 }
 //---
-inline void copyBuffer(Device_t const &device, Buffer_t const &src, Buffer_t &dst)
+inline VkMemoryPropertyFlags getUploadPreferredProps(Gpu_t const &gpu)
 {
-  auto const pool = device.cmdpool.transfer ? device.cmdpool.transfer : device.cmdpool.graphics;
-
-  // . Allocate
-  VkCommandBufferAllocateInfo allocInfo {
-    .sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
-    .level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
-    .commandPool        = pool,
-    .commandBufferCount = 1,
-  };
-  VkCommandBuffer cmd;
-  vkAllocateCommandBuffers(device.handle, &allocInfo, &cmd);
-
-  // . Record
-  VkCommandBufferBeginInfo const beginInfo {
-    .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
-    .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
-  };
-  vkBeginCommandBuffer(cmd, &beginInfo);
-  VkBufferCopy const copyRegion {
-    .srcOffset = 0,  // Optional
-    .dstOffset = 0,  // Optional
-    .size      = src.size,
-  };
-  vkCmdCopyBuffer(cmd, src.handle, dst.handle, 1, &copyRegion);
-  vkEndCommandBuffer(cmd);
-
-  // . Submit
-  VkSubmitInfo const submitInfo {
-    .sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO,
-    .commandBufferCount = 1,
-    .pCommandBuffers    = &cmd,
-  };
-  auto const queue = device.queue.transfer ? device.queue.transfer : device.queue.graphics;
-  vkQueueSubmit(queue, 1, &submitInfo, VK_NULL_HANDLE);
-  vkQueueWaitIdle(queue);  // There is some room to improve using 'vkWaitForFences'-logic
-
-  // . Free
-  vkFreeCommandBuffers(device.handle, pool, 1, &cmd);
+  // . UMA / ReBAR : device-local buffers land on host-visible memory, so uploads skip the staging copy
+  return gpu.hostVisibleVram ? VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT : 0u;
 }
 //---
-inline void destroyBuffer(Device_t const &device, Buffer_t const &buff)
+inline void destroyBuffer(Device_t const &device, Buffer_t &buff)
 {
   vkDestroyBuffer(device.handle, buff.handle, nullptr);
-  vkFreeMemory(device.handle, buff.memory, nullptr);
+  vonk::freeMemory(*device.pAllocator, buff.allocation);
 }
 //---
-inline Buffer_t createBufferStaging(Device_t const &device, DataInfo_t di, VkBufferUsageFlags usage)
+inline Buffer_t
+  createBufferStaging(Device_t const &device, MemoryCategory_t category, DataInfo_t di, VkBufferUsageFlags usage)
 {
-  // . Create
-  auto const hostUsage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-  auto const hostProps = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
-  auto       buffHost  = createBuffer(device, di.elemSize, di.count, hostUsage, hostProps);
-
   auto const devUsage = VK_BUFFER_USAGE_TRANSFER_DST_BIT | usage;
   auto const devProps = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
-  auto       buffDev  = createBuffer(device, di.elemSize, di.count, devUsage, devProps);
-
-  // . Populate the host one
-  void *data = nullptr;
-  vkMapMemory(device.handle, buffHost.memory, 0, di.elemSize * di.count, 0, &data);
-  memcpy(data, di.data, di.elemSize * di.count);
-  vkUnmapMemory(device.handle, buffHost.memory);
-
-  // . Copy from Host to Dev and clean the Host one  @Check is this copy backwards?
-  copyBuffer(device, buffHost, buffDev);
-  destroyBuffer(device, buffHost);
+  auto const devPrefs = getUploadPreferredProps(*device.pGpu);
+  auto       buffDev  = createBuffer(device, category, di.elemSize, di.count, devUsage, devProps, devPrefs);
 
+  // . Non-blocking : written in place when host-visible, otherwise the graphics queue waits on the uploader's timeline
+  vonk::uploadBuffer(*device.pUploader, di, buffDev);
   return buffDev;
 }
 
 //-----------------------------------------------
 
+// STAGING RING
+//  Persistently mapped host buffer split in one region per frame in flight.
+//  Transient data (uniforms, instances, dynamic vertices, upload staging) is
+//  bump-allocated from the current region, which is recycled once its frame's
+//  'fences.submit' has signaled, and the uploads staged on it are done.
+
+StagingRing_t createStagingRing(Device_t const &device, VkDeviceSize bytesPerFrame, uint32_t frameCount);
+
+void destroyStagingRing(Device_t const &device, StagingRing_t &ring);
+
+void beginStagingFrame(StagingRing_t &ring, uint32_t frame, Uploader_t &uploader);
+
+StagingSlice_t allocateStaging(StagingRing_t &ring, VkDeviceSize size);
+
+//-----------------------------------------------
+
+// BUFFER UPDATEs
+//  In-place partial writes for buffers the GPU keeps reading (i.e. dynamic meshes).
+//  The bytes are staged on the current frame's region of the ring, so each frame in
+//  flight has its own copy, and the copy runs on the graphics queue right before the
+//  frame's draws. A full region hands the rest to staging buffers of their own, freed
+//  on the region's next frame. Its barriers cover just the ranges written, and only
+//  wait on the stages reading those buffers : the rest of the previous frames keeps
+//  overlapping.
+
+void queueBufferUpdate(BufferUpdates_t &updates, Buffer_t const &dst, VkDeviceSize dstOffset, DataInfo_t di);
+
+bool recordBufferUpdates(Device_t const &device, BufferUpdates_t &updates, StagingRing_t &ring, VkCommandBuffer cmd);
+
+// . The overflow stagings : once the device is idle
+void destroyBufferUpdates(Device_t const &device, BufferUpdates_t &updates);
+
+//-----------------------------------------------
+
+// GEOMETRY ARENA
+//  One vertex buffer and one index buffer shared by every mesh, so a pass binds
+//  them once and each mesh is just a (firstIndex, vertexOffset) range.
+
+// . 'split' : positions on their own buffer, 'maxMeshes' : count of MeshBounds_t slots, packed arenas only
+GeometryArena_t createGeometryArena(
+  Device_t const &device,
+  uint32_t        maxVertices,
+  uint32_t        maxIndices,
+  VertexFormat_t  format      = VertexFormat_t::Full,
+  bool            split       = false,
+  uint32_t        maxMeshes   = 1u << 16,
+  uint32_t        maxMeshlets = 1u << 16);
+
+void destroyGeometryArena(Device_t const &device, GeometryArena_t &arena);
+
+// . Bindings in order : [positions,] vertices [, bounds], or [positions,] [bounds] with 'positionsOnly' (split arenas)
+void bindGeometryArena(VkCommandBuffer cmd, GeometryArena_t const &arena, bool positionsOnly = false);
+
+// . 'indexSlots' : see 'meshIndexSlots'
+bool fitsGeometryArena(GeometryArena_t const &arena, uint32_t indexSlots, uint32_t vertexCount, uint32_t meshletCount = 0u);
+
+//-----------------------------------------------
+
 // MESHes
 
-inline Mesh_t
-  createMesh(Device_t const &device, std::vector<uint32_t> const &indices, std::vector<Vertex_t> const &vertices)
+// . 16-bit indices whenever every vertex is reachable with them : two of them per arena slot
+inline VkIndexType meshIndexType(uint32_t vertexCount)
 {
-  Mesh_t mesh;
-  mesh.indices  = createBufferStaging(device, GetDataInfo(indices), VK_BUFFER_USAGE_INDEX_BUFFER_BIT);
-  mesh.vertices = createBufferStaging(device, GetDataInfo(vertices), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT);
-  return mesh;
+  return vertexCount <= (1u << 16) ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
 }
+inline uint32_t meshIndexSlots(uint32_t indexCount, uint32_t vertexCount)
+{
+  return meshIndexType(vertexCount) == VK_INDEX_TYPE_UINT16 ? (indexCount + 1) / 2 : indexCount;
+}
+inline uint32_t indexSize(VkIndexType type) { return type == VK_INDEX_TYPE_UINT16 ? 2u : 4u; }
+
+// . 'data.meshlets' / 'data.lods' : optional, see 'buildMeshlets' / 'buildLods'
+Mesh_t createMesh(Device_t const &device, GeometryArena_t &arena, MeshData_t const &data);
+
+// . Batched : a single arena range and one upload per buffer for all of them
+std::vector<Mesh_t>
+  createMeshes(Device_t const &device, GeometryArena_t &arena, std::vector<MeshData_t> const &meshesData);
+
+// . From a mapped file, see 'openCookedMeshes' : the payloads are uploaded as they are, no encoding
+//   The file has to be cooked for the arena's VertexFormat_t and split
+std::vector<Mesh_t> createMeshes(Device_t const &device, GeometryArena_t &arena, CookedMeshes_t const &cooked);
+Mesh_t              createMesh(Device_t const &device, GeometryArena_t &arena, CookedMeshes_t const &cooked, uint32_t index);
 
-inline void destroyMesh(Device_t const &device, Mesh_t &mesh)
+void destroyMesh(GeometryArena_t &arena, Mesh_t &mesh);
+
+// . 'bindGeometryArena' binds the indices as UINT32 : the 16-bit meshes rebind them with their type
+inline void bindMeshIndices(VkCommandBuffer cmd, GeometryArena_t const &arena, VkIndexType type)
 {
-  destroyBuffer(device, mesh.indices);
-  destroyBuffer(device, mesh.vertices);
+  vkCmdBindIndexBuffer(cmd, arena.indices.handle, 0, type);
 }
 
-inline void drawMesh(VkCommandBuffer cmd, Mesh_t const &mesh)
+inline void drawMesh(VkCommandBuffer cmd, Mesh_t const &mesh, uint32_t lod = 0u)
+{
+  // . Expects the GeometryArena_t to be already bound, indices as 'mesh.indexType' : see 'bindMeshIndices'
+  // . 'firstInstance' picks its MeshBounds_t on packed arenas, the full format ignores it
+  auto const &level = mesh.lods[std::min(lod, mesh.lodCount - 1)];
+  vkCmdDrawIndexed(cmd, level.indexCount, 1, level.firstIndex, mesh.vertexOffset, mesh.bounds);
+}
+
+// . Coarsest level whose error stays under 'maxPixels' on screen at 'distance' from the camera
+//   'pixelsPerUnit' : on screen size of one unit at distance 1, 'viewportHeight / (2 * tan(fovY / 2))'
+inline uint32_t selectMeshLod(Mesh_t const &mesh, float distance, float pixelsPerUnit, float maxPixels = 1.f)
+{
+  uint32_t lod = 0u;
+  while (lod + 1 < mesh.lodCount and mesh.lods[lod + 1].error * pixelsPerUnit <= maxPixels * distance) { ++lod; }
+  return lod;
+}
+
+//-----------------------------------------------
+
+// CLUSTER CULLING
+//  'assets/shaders/cluster_cull.comp' writes one draw per meshlet of the arena,
+//  the culled ones with no instances, and each mesh draws its range of them.
+//  Recorded outside of the render pass, ahead of the draws of the frame.
+
+// . 'viewProj' with Vulkan's [0, 1] depth : the meshes have no transform, their space is the world
+//   'cones' : backface test of the meshlets from 'eye', only makes sense with a perspective camera
+ClusterCull_t clusterCull(glm::mat4 const &viewProj, glm::vec3 const &eye, bool cones);
+
+// . Expects a pipeline of 'cluster_cull' with the arena's 'meshlets' and 'draws' bound, false if there is nothing to cull
+bool recordClusterCull(VkCommandBuffer cmd, ComputePipeline_t const &pipeline, GeometryArena_t const &arena, ClusterCull_t cull);
+
+inline void drawMeshlets(VkCommandBuffer cmd, GeometryArena_t const &arena, Mesh_t const &mesh, bool multiDraw)
+{
+  // . As 'drawMesh', but the meshlets that survived the culling : one indirect draw each, batched with 'multiDrawIndirect'
+  constexpr auto stride = sizeof(VkDrawIndexedIndirectCommand);
+  auto const     offset = VkDeviceSize { mesh.firstMeshlet } * stride;
+  if (multiDraw) {
+    vkCmdDrawIndexedIndirect(cmd, arena.draws.handle, offset, mesh.meshletCount, stride);
+  } else {
+    for (uint32_t i = 0; i < mesh.meshletCount; ++i) { vkCmdDrawIndexedIndirect(cmd, arena.draws.handle, offset + i * stride, 1, stride); }
+  }
+}
+
+//-----------------------------------------------
+
+// DEPTH PYRAMID
+//  The swapchain's depth attachment reduced level after level, each texel keeping
+//  the farthest depth under it : any screen rect is covered by 2x2 texels of one
+//  level, so an occlusion test costs four fetches. Built outside of the render
+//  passes, from the attachment as the last one left it, and handed back to them.
+
+// . Expects a pipeline of 'depth_pyramid' : its set layout, one image sampled and one storage. Again with the swapchain
+DepthPyramid_t createDepthPyramid(Device_t const &device, SwapChain_t const &swapchain, ComputePipeline_t const &pipeline);
+
+void destroyDepthPyramid(Device_t const &device, DepthPyramid_t &pyramid);
+
+// . Once after creation, the levels to the layout the occlusion tests bind them with : their content undefined
+//   False when it was done already, nothing recorded
+bool prepareDepthPyramid(VkCommandBuffer cmd, DepthPyramid_t &pyramid);
+
+// . 'depth' : the attachment, left as DEPTH_STENCIL_ATTACHMENT_OPTIMAL by a render pass storing it, and returned so
+void recordDepthPyramid(VkCommandBuffer cmd, ComputePipeline_t const &pipeline, DepthPyramid_t const &pyramid, VkImage depth);
+
+//-----------------------------------------------
+
+// INSTANCE DRAWS
+//  GPU-driven : 'assets/shaders/instance_cull.comp' tests every instance against the
+//  frustum, picks its level of detail and appends its draw to the list of its index
+//  width. Each list is then one vkCmdDrawIndexedIndirectCount, however many instances
+//  there are : the CPU only writes the instances when they change.
+//  With a depth pyramid, in two phases : the first one also tests them against the
+//  previous frame's depth and keeps the occluded ones apart, the second one tests
+//  those again on the depth the first one's draws left, and the ones it lets
+//  through go to lists of their own, drawn over. Nothing is drawn a frame late.
+
+// . 'maxMeshes' : distinct meshes among the instances. 'frameCount' : frames in flight, each reads its stats back
+InstanceDraws_t createInstanceDraws(Device_t const &device, uint32_t maxInstances, uint32_t maxMeshes, uint32_t frameCount);
+
+void destroyInstanceDraws(Device_t const &device, InstanceDraws_t &draws);
+
+// . 'packed' : the arena's meshes pick their bounds through 'firstInstance'
+DrawMesh_t drawMeshOf(Mesh_t const &mesh, bool packed);
+
+// . 'viewProj' as 'clusterCull' takes it, the levels as 'selectMeshLod' picks them
+InstanceCull_t instanceCull(glm::mat4 const &viewProj, glm::vec3 const &eye, float pixelsPerUnit, float maxPixels);
+
+// . Expects a pipeline of 'instance_cull' with 'meshes', 'instances', 'draws', 'counts', 'retest' and a depth pyramid
+//   bound, false without instances. After 'recordBufferUpdates' : the instances and meshes written for this frame are
+//   the ones culled. 'pPyramid' : built for the phase, nullptr skips the occlusion test (no second phase then)
+bool recordInstanceCull(
+  VkCommandBuffer          cmd,
+  ComputePipeline_t const &pipeline,
+  InstanceDraws_t const &  draws,
+  InstanceCull_t           cull,
+  DepthPyramid_t const *   pPyramid = nullptr);
+
+// . After the last phase of the frame : read on the host with 'readInstanceStats', once 'frame' is done
+void recordInstanceStats(VkCommandBuffer cmd, InstanceDraws_t const &draws, uint32_t frame);
+
+// . And clears them : frames that culled nothing read as zeros
+InstanceStats_t readInstanceStats(InstanceDraws_t const &draws, uint32_t frame);
+
+inline void drawInstances(VkCommandBuffer cmd, GeometryArena_t const &arena, InstanceDraws_t const &draws, bool late = false)
 {
-  // ROOM TO IMPROVEMENT : https://developer.nvidia.com/vulkan-memory-management
-
-  /* @DANI
-   You should store multiple buffers, like the vertex and index buffer, into a single VkBuffer and use offsets in
-   commands like vkCmdBindVertexBuffers. The advantage is that your data is more cache friendly in that case, because
-   it's closer together. It is even possible to reuse the same chunk of memory for multiple resources if they are not
-   used during the same render operations, provided that their data is refreshed, of course. This is known as aliasing
-   and some Vulkan functions have explicit flags to specify that you want to do this.
-  */
-
-  VkBuffer const     vertexBuffers[] = { mesh.vertices.handle };
-  VkDeviceSize const offsets[]       = { 0 };
-  vkCmdBindVertexBuffers(cmd, 0, 1, vertexBuffers, offsets);
-#if 1
-  vkCmdBindIndexBuffer(cmd, mesh.indices.handle, 0, VK_INDEX_TYPE_UINT32);  // or... VK_INDEX_TYPE_UINT16
-  vkCmdDrawIndexed(cmd, mesh.indices.count, 1, 0, 0, 0);
-#else
-  vkCmdDraw(cmd, mesh.vertices.count, 1, 0, 0);
-#endif
+  // . Expects the GeometryArena_t to be already bound : each list binds the indices with its type
+  //   'late' : the lists of the second phase
+  constexpr auto    stride  = sizeof(VkDrawIndexedIndirectCommand);
+  VkIndexType const types[] = { VK_INDEX_TYPE_UINT32, VK_INDEX_TYPE_UINT16 };
+  for (uint32_t list = 0; list < 2; ++list) {
+    if (draws.listInstances[list] < 1) continue;
+    auto const counter = (late ? 2u : 0u) + list;
+    auto const offset  = VkDeviceSize { counter } * draws.instances.count * stride;
+    vonk::bindMeshIndices(cmd, arena, types[list]);
+    vkCmdDrawIndexedIndirectCount(
+      cmd, draws.draws.handle, offset, draws.counts.handle, counter * sizeof(uint32_t), draws.listInstances[list], stride);
+  }
 }
 
 //-----------------------------------------------
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "_vulkan.h"
+#include "VonkTypes.h"
 #include <unordered_map>
 #include <string_view>
 
@@ -26,6 +27,14 @@ inline static std::unordered_map<uint32_t, std::string_view> const ToStr_DebugTy
   { VK_DEBUG_UTILS_MESSAGE_TYPE_PERFORMANCE_BIT_EXT, "Performance" },
   { VK_DEBUG_UTILS_MESSAGE_TYPE_FLAG_BITS_MAX_ENUM_EXT, "OtherType" },
 };
+inline static std::unordered_map<uint32_t, std::string_view> const ToStr_MemoryCategory {
+  { static_cast<uint32_t>(MemoryCategory_t::Unknown), "Unknown" },
+  { static_cast<uint32_t>(MemoryCategory_t::Mesh), "Mesh" },
+  { static_cast<uint32_t>(MemoryCategory_t::Texture), "Texture" },
+  { static_cast<uint32_t>(MemoryCategory_t::Staging), "Staging" },
+  { static_cast<uint32_t>(MemoryCategory_t::Attachment), "Attachment" },
+  { static_cast<uint32_t>(MemoryCategory_t::Uniform), "Uniform" },
+};
 inline static std::unordered_map<uint32_t, std::string_view> const ToStr_PresentMode {
   { VK_PRESENT_MODE_IMMEDIATE_KHR, "VK_PRESENT_MODE_IMMEDIATE_KHR" },
   { VK_PRESENT_MODE_MAILBOX_KHR, "VK_PRESENT_MODE_MAILBOX_KHR" },
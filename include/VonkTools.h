@@ -15,10 +15,15 @@ namespace vonk
 
 uint32_t
   getMemoryType(VkPhysicalDeviceMemoryProperties memProps, uint32_t typeBits, VkMemoryPropertyFlags requestedProps);
+std::optional<uint32_t>
+  findMemoryType(VkPhysicalDeviceMemoryProperties const &memProps, uint32_t typeBits, VkMemoryPropertyFlags requestedProps);
+
+bool hasHostVisibleVram(VkPhysicalDeviceMemoryProperties const &memProps);
 
 SurfaceSupport_t getSurfaceSupport(VkPhysicalDevice gpu, VkSurfaceKHR surface);
 
 bool checkGpuExtensionsSupport(Gpu_t const &gpu);
+bool checkGpuExtensionSupport(VkPhysicalDevice gpu, char const *ext);
 bool checkValidationLayersSupport(std::vector<char const *> const &layers);
 
 std::vector<uint32_t> getUniqueQueueFamilies(Gpu_t const &gpu);
@@ -5,6 +5,10 @@
 #include "Macros.h"
 
 #include <array>
+#include <deque>
+#include <functional>
+#include <map>
+#include <set>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -14,6 +18,19 @@ namespace vonk
 
 //-----------------------------------------------
 
+// . Into a Registry_t<T> : stale once its value is removed, even if the slot gets reused
+template <typename T>
+struct Handle_t
+{
+    uint32_t index      = UINT32_MAX;
+    uint32_t generation = 0u;
+
+    inline bool valid() const { return index != UINT32_MAX; }
+    bool        operator==(Handle_t const &) const = default;
+};
+
+//-----------------------------------------------
+
 struct SurfaceSupport_t
 {
     VkSurfaceCapabilitiesKHR        caps;
@@ -43,6 +60,9 @@ struct Gpu_t
     SurfaceSupport_t                 surfSupp;
     VkPhysicalDeviceMemoryProperties memory;
     VkPhysicalDeviceFeatures         features;
+    VkPhysicalDeviceVulkan12Features features12;
+    bool                             hostVisibleVram = false; // UMA / ReBAR : host writes straight into VRAM
+    bool                             memoryBudget    = false; // VK_EXT_memory_budget : driver-side heap budget / usage
     VkPhysicalDeviceProperties       properties;
 
     struct
@@ -60,6 +80,120 @@ struct Gpu_t
 
 //-----------------------------------------------
 
+struct Device_t;
+struct Uploader_t;
+
+//-----------------------------------------------
+
+// . What the memory is for : every allocation is tagged, so the reports can tell who eats it
+enum class MemoryCategory_t : uint32_t
+{
+    Unknown = 0,
+    Mesh,
+    Texture,
+    Staging,
+    Attachment,
+    Uniform,
+    Count
+};
+constexpr auto sMemoryCategoryCount = static_cast<uint32_t>(MemoryCategory_t::Count);
+
+//-----------------------------------------------
+
+struct Allocation_t
+{
+    VkDeviceMemory   memory   = VK_NULL_HANDLE;
+    VkDeviceSize     offset   = 0u;
+    VkDeviceSize     size     = 0u;          // Reserved bytes : rounded up to a buddy node when sub-allocated
+    void            *pMapped  = nullptr;     // Already offset, only on host-visible memory
+    uint32_t         pool     = UINT32_MAX;  // memoryType * 2 + isOptimalTiling
+    uint32_t         block    = UINT32_MAX;  // UINT32_MAX : dedicated allocation
+    MemoryCategory_t category = MemoryCategory_t::Unknown;
+    uint64_t         id       = 0u;          // Creation order, for the leak report
+};
+
+//-----------------------------------------------
+
+struct MemoryBlock_t
+{
+    VkDeviceMemory                      memory  = VK_NULL_HANDLE;
+    VkDeviceSize                        size    = 0u;
+    VkDeviceSize                        used    = 0u;
+    void                               *pMapped = nullptr;
+    std::vector<std::set<VkDeviceSize>> freeNodes; // Per buddy order : offsets of the free nodes
+};
+
+//-----------------------------------------------
+
+struct AllocatorStats_t
+{
+    uint32_t     blockCount      = 0u;
+    uint32_t     dedicatedCount  = 0u;
+    VkDeviceSize bytesReserved   = 0u; // Blocks + dedicated allocations
+    VkDeviceSize bytesInUse      = 0u;
+    VkDeviceSize bytesFree       = 0u;
+    VkDeviceSize largestFreeNode = 0u;
+    float        fragmentation   = 0.f; // 0 : all the free memory is contiguous, ~1 : scattered in tiny nodes
+};
+
+//-----------------------------------------------
+
+struct MemoryUsage_t
+{
+    uint32_t     count = 0u;
+    VkDeviceSize bytes = 0u; // Reserved : rounded up to a buddy node when sub-allocated
+};
+
+//-----------------------------------------------
+
+struct MemoryReport_t
+{
+    MemoryUsage_t                                                                    total;
+    std::array<MemoryUsage_t, sMemoryCategoryCount>                                  perCategory{};
+    std::array<MemoryUsage_t, VK_MAX_MEMORY_TYPES>                                   perMemoryType{};
+    std::array<std::array<MemoryUsage_t, VK_MAX_MEMORY_TYPES>, sMemoryCategoryCount> perCategoryAndType{};
+};
+
+//-----------------------------------------------
+
+struct Allocator_t
+{
+    static constexpr VkDeviceSize sMinNodeSize      = 256u;
+    static constexpr VkDeviceSize sDefaultBlockSize = 64u * 1024u * 1024u;
+
+    // . Linear (buffers) and optimal (images) resources never share a block, so
+    //   'bufferImageGranularity' can't be violated between neighbour nodes.
+    std::array<std::vector<MemoryBlock_t>, VK_MAX_MEMORY_TYPES * 2> pools;
+
+    VkDeviceSize blockSize       = sDefaultBlockSize;
+    uint32_t     liveAllocations = 0u; // vkAllocateMemory calls alive
+    uint32_t     dedicatedCount  = 0u;
+    VkDeviceSize dedicatedBytes  = 0u;
+
+    std::array<VkDeviceSize, VK_MAX_MEMORY_HEAPS> heapUsage{}; // Bytes of our own vkAllocateMemory calls, per heap
+
+    // . Accounting : every live allocation handed out, by id
+    std::map<uint64_t, Allocation_t> tracked;
+    uint64_t                         nextId = 1u;
+
+    // . Asked to free at least 'bytes' on 'heap' before going over budget or after an out-of-memory
+    //   error (i.e. residency eviction). Returns the bytes it could free.
+    std::function<VkDeviceSize(uint32_t heap, VkDeviceSize bytes)> reclaim = nullptr;
+
+    Device_t const *pDevice = nullptr;
+};
+
+//-----------------------------------------------
+
+struct MemoryBudget_t
+{
+    uint32_t                                      heapCount = 0u;
+    std::array<VkDeviceSize, VK_MAX_MEMORY_HEAPS> budget{}; // What the process can use without hurting itself or others
+    std::array<VkDeviceSize, VK_MAX_MEMORY_HEAPS> usage{};  // Process-wide, not only ours, when the extension is there
+};
+
+//-----------------------------------------------
+
 struct Device_t
 {
     VkDevice handle = VK_NULL_HANDLE;
@@ -80,17 +214,21 @@ struct Device_t
         VkQueue compute  = VK_NULL_HANDLE;
     } queue;
 
-    Gpu_t const *pGpu = nullptr;
+    Gpu_t const *pGpu       = nullptr;
+    Allocator_t *pAllocator = nullptr;
+    Uploader_t  *pUploader  = nullptr;
 };
 
 //-----------------------------------------------
 
 struct Texture_t
 {
-    VkImageView    view   = VK_NULL_HANDLE;
-    VkImage        image  = VK_NULL_HANDLE;
-    VkDeviceMemory memory = VK_NULL_HANDLE;
+    VkImageView  view     = VK_NULL_HANDLE;
+    VkImage      image    = VK_NULL_HANDLE;
+    Allocation_t allocation;
+    uint32_t     resident = UINT32_MAX; // Its Resident_t, when evictable
 };
+using TextureHandle_t = Handle_t<Texture_t>;
 
 //-----------------------------------------------
 
@@ -213,9 +351,27 @@ struct CommandBufferData_t
     VkClearDepthStencilValue             clearDephtStencil = {1.f, 0};
     MBU uint32_t                         renderPassIdx     = 0u;
     std::function<void(VkCommandBuffer)> commands          = nullptr;
+    // . Split recording of per-frame pipelines : called on the worker threads, each on its own secondary command buffer
+    //   with the pipeline, viewports and scissors already set, 'chunk' of 'chunkCount' (see 'vo::jobs::chunkRange')
+    //   'commands', when given too, goes at the start of chunk 0. Baked pipelines : a single chunk, inline
+    std::function<void(VkCommandBuffer, uint32_t chunk, uint32_t chunkCount)> chunkCommands = nullptr;
 };
 using CommandBuffersData_t = std::vector<CommandBufferData_t>;
 
+// . One per frame in flight : the pools are reset as a whole once the frame's fence is signaled
+struct FrameCommands_t
+{
+    VkCommandPool   pool   = VK_NULL_HANDLE;
+    VkCommandBuffer update = VK_NULL_HANDLE; // Buffer updates and cluster culling
+    VkCommandBuffer draw   = VK_NULL_HANDLE; // The active pipeline, when it records per frame
+    VkCommandBuffer late   = VK_NULL_HANDLE; // Second occlusion phase : its culling and 'lateCommands'
+
+    // . Secondaries of the split passes : a pool per worker, so no two threads ever record from the same one
+    std::vector<VkCommandPool>                workerPools;
+    std::vector<std::vector<VkCommandBuffer>> workerBuffers; // Per pool, one per split pass : kept across resets
+    uint32_t                                  splitPasses = 0u; // Recorded this frame
+};
+
 //-----------------------------------------------
 
 struct Shader_t
@@ -224,6 +380,7 @@ struct Shader_t
     VkShaderModule                  module = VK_NULL_HANDLE;
     VkPipelineShaderStageCreateInfo stageCI;
 };
+using ShaderHandle_t = Handle_t<Shader_t>;
 
 //-----------------------------------------------
 
@@ -235,6 +392,7 @@ struct DrawShader_t
     Shader_t tese;
     Shader_t geom;
 };
+using DrawShaderHandle_t = Handle_t<DrawShader_t>;
 
 //-----------------------------------------------
 
@@ -242,6 +400,18 @@ using ComputeShader_t = Shader_t;
 
 //-----------------------------------------------
 
+// . How the geometry arena stores the vertices : Vertex_t as is, or PackedVertex_t
+enum class VertexFormat_t : uint32_t
+{
+    Full = 0,
+    Packed,
+};
+
+// . Which attributes a pipeline fetches, and from which bindings
+using VertexInput_t = VkPipelineVertexInputStateCreateInfo;
+
+//-----------------------------------------------
+
 struct PipelineLayoutData_t
 {
     // . Used for: VkCheck(vkCreatePipelineLayout(mDevice.handle, &pipelineLayoutCI, nullptr, &mPipeline.layout));
@@ -259,6 +429,10 @@ struct PipelineLayoutData_t
 struct DrawPipelineData_t
 {
     bool                    useMeshes     = true;
+    VertexFormat_t          vertexFormat  = VertexFormat_t::Full; // The geometry arena's, the shader has to match it
+    bool                    splitStreams  = false;                // The geometry arena's too
+    bool                    positionsOnly = false;                // Depth / shadow passes : draw with 'positionsOnly' too
+    VertexInput_t const    *pVertexInput  = nullptr;              // nullptr : as the flags above say, else see 'vertexInputState'
 
     // . Static
     VkPolygonMode           ffPolygonMode = VK_POLYGON_MODE_FILL;
@@ -266,7 +440,8 @@ struct DrawPipelineData_t
     VkSampleCountFlagBits   ffSamples     = VK_SAMPLE_COUNT_1_BIT;
     VkCompareOp             ffDepthOp     = VK_COMPARE_OP_LESS;
 
-    DrawShader_t const     *pDrawShader   = nullptr;
+    DrawShaderHandle_t      drawShader;                           // See 'Vonk::createDrawShader'
+    DrawShader_t const     *pDrawShader   = nullptr;              // Resolved from 'drawShader' while creating it
     // ComputeShader_t *    pComputeShader;
     RenderPassData_t        renderPassData;
     PipelineLayoutData_t    pipelineLayoutData;
@@ -289,11 +464,24 @@ struct DrawPipelineData_t
          }
     };
     CommandBuffersData_t commandBuffersData;
+    // . false : recorded once per swapchain image and replayed, what they draw stays resident
+    //   true : recorded again every frame by 'Vonk::drawFrame', so 'commands' can draw a different scene each time
+    bool                 recordPerFrame = false;
+    // . Into the render graph's passes (see 'Vonk::setRenderGraph') : created for that pass's render pass, with no
+    //   commands of its own, the pass's 'record' binds it ('Vonk::bindPipeline') and draws. UINT32_MAX : the swapchain's
+    uint32_t             graphPass      = UINT32_MAX;
+    // . Its commands draw with 'Vonk::drawMeshClusters' : the meshlets are culled ahead of them on the frames it is
+    //   drawn (with a render graph, when any of its pipelines says so). Else no culling dispatch, the draws read stale
+    bool                 clusterCulling = false;
+    // . Occlusion culling (see 'Vonk::setOcclusionCulling') : the instances hidden on the previous frame's depth but
+    //   not on this one's are drawn after the pipeline's commands, in a render pass loading what they left. Binds what
+    //   'commands' binds for its 'Vonk::drawInstances', and draws with 'late'. The pipeline and viewports are set
+    std::function<void(VkCommandBuffer)> lateCommands = nullptr;
 };
 
 //-----------------------------------------------
 
-struct DrawPipeline_t // @DANI Change this to DrawPipeline_t and create ComputePipeline_t
+struct DrawPipeline_t
 {
     VkPipeline                                   handle    = VK_NULL_HANDLE;
     bool                                         useMeshes = true;
@@ -303,17 +491,148 @@ struct DrawPipeline_t // @DANI Change this to DrawPipeline_t and create ComputeP
     VkRenderPass                                 renderpass = VK_NULL_HANDLE;
     // . Dynamic
     std::vector<VkFramebuffer>                   frameBuffers;
-    std::vector<VkCommandBuffer>                 commandBuffers;
+    std::vector<VkCommandBuffer>                 commandBuffers; // Empty when recorded per frame
+    bool                                         recordPerFrame = false;
+};
+using PipelineHandle_t = Handle_t<DrawPipeline_t>;
+
+//-----------------------------------------------
+
+// . A compute shader and the storage buffers it reads / writes, bound in order on one descriptor set, then its images
+struct ComputePipeline_t
+{
+    VkPipeline            handle    = VK_NULL_HANDLE;
+    VkPipelineLayout      layout    = VK_NULL_HANDLE;
+    VkDescriptorSetLayout setLayout = VK_NULL_HANDLE;
+    VkDescriptorPool      pool      = VK_NULL_HANDLE;
+    VkDescriptorSet       set       = VK_NULL_HANDLE;
+};
+
+//-----------------------------------------------
+
+// . Hierarchical depth of the swapchain's depth attachment : level 0 a copy of it, each level after the farthest
+//   depth under each of its texels. Built by 'assets/shaders/depth_pyramid.comp', one dispatch per level
+struct DepthPyramid_t
+{
+    VkImage                      image       = VK_NULL_HANDLE; // R32_SFLOAT, always GENERAL
+    Allocation_t                 allocation;
+    VkImageView                  view        = VK_NULL_HANDLE; // Every level, for the occlusion tests
+    std::vector<VkImageView>     levels;                       // One each, written by their dispatch
+    VkImageView                  depthView   = VK_NULL_HANDLE; // Depth aspect alone of the attachment, read by level 0
+    VkImageAspectFlags           depthAspect = 0u;             // Of the attachment's barriers : the stencil too if any
+    VkSampler                    sampler     = VK_NULL_HANDLE; // Nearest : texels are only fetched
+    VkExtent2D                   extent      = {0u, 0u};
+    VkDescriptorPool             pool        = VK_NULL_HANDLE;
+    std::vector<VkDescriptorSet> sets;                         // Per level, of the pipeline's layout : the one above -> it
+    bool                         prepared    = false;          // Its levels left UNDEFINED until then, see 'prepareDepthPyramid'
 };
 
 //-----------------------------------------------
 
 struct Buffer_t
 {
-    VkBuffer       handle = VK_NULL_HANDLE;
-    VkDeviceMemory memory = VK_NULL_HANDLE;
-    VkDeviceSize   size   = 0u;
-    uint32_t       count  = 0u;
+    VkBuffer           handle = VK_NULL_HANDLE;
+    Allocation_t       allocation;
+    VkDeviceSize       size  = 0u;
+    uint32_t           count = 0u;
+    VkBufferUsageFlags usage = 0u; // What reads it : the barriers of its updates wait on just those stages
+};
+
+//-----------------------------------------------
+
+struct StagingSlice_t
+{
+    VkBuffer     buffer = VK_NULL_HANDLE;
+    VkDeviceSize offset = 0u;
+    VkDeviceSize size   = 0u;
+    void        *pData  = nullptr; // nullptr : the ring has no room left this frame
+};
+
+//---
+
+struct StagingRing_t
+{
+    Buffer_t     buffer;           // Persistently mapped : one region per frame in flight
+    VkDeviceSize frameSize = 0u;
+    VkDeviceSize alignment = 16u;
+    uint32_t     frame     = 0u;
+    VkDeviceSize head      = 0u;   // Bump pointer inside the current frame region
+    // . Per region : the last uploader ticket staged on it (UploadTicket_t). Uploads are flushed by whichever
+    //   frame comes next, not by the region's own one : they are waited on too before the region is reused
+    std::vector<uint64_t> uploadTickets;
+};
+
+//-----------------------------------------------
+
+struct BufferWrite_t
+{
+    VkBuffer           dst        = VK_NULL_HANDLE;
+    VkBufferUsageFlags usage      = 0u; // Of 'dst'
+    VkDeviceSize       dstOffset  = 0u;
+    VkDeviceSize       size       = 0u;
+    size_t             dataOffset = 0u; // Inside BufferUpdates_t::data
+};
+
+//---
+
+struct BufferUpdates_t
+{
+    // . Partial writes queued during the frame : coalesced and copied at the start of the next submit
+    std::vector<BufferWrite_t> writes;
+    std::vector<char>          data;
+    // . Per ring region : staging of its own when the region is full, released on the region's next frame
+    std::vector<std::vector<Buffer_t>> overflow;
+};
+
+//-----------------------------------------------
+
+using UploadTicket_t = uint64_t; // Value the uploader's timeline semaphore reaches once the upload is done
+
+//---
+
+struct UploadStats_t
+{
+    // . Direct : memcpy straight into a host-visible destination, no GPU copy at all
+    uint64_t     directCount   = 0u;
+    VkDeviceSize directBytes   = 0u;
+    double       directSeconds = 0.0;
+    // . Staged : memcpy into staging memory plus the recording of the GPU copy
+    uint64_t     stagedCount   = 0u;
+    VkDeviceSize stagedBytes   = 0u;
+    double       stagedSeconds = 0.0;
+};
+
+//---
+
+struct UploadBatch_t
+{
+    UploadTicket_t        ticket     = 0u;
+    VkCommandBuffer       cmd        = VK_NULL_HANDLE;
+    uint32_t              copyCount  = 0u;
+    VkDeviceSize          stageBytes = 0u;
+    std::vector<Buffer_t> stagings; // Released once the timeline reaches the ticket
+};
+
+//---
+
+struct Uploader_t
+{
+    static constexpr uint32_t     sMaxCopiesPerBatch = 256u;
+    static constexpr VkDeviceSize sMaxBytesPerBatch  = 32u * 1024u * 1024u;
+
+    VkQueue        queue        = VK_NULL_HANDLE;
+    VkCommandPool  pool         = VK_NULL_HANDLE;
+    VkSemaphore    timeline     = VK_NULL_HANDLE;
+    StagingRing_t *pStagingRing = nullptr; // Optional : staging space recycled per frame
+
+    UploadBatch_t             recording; // Open batch : its 'cmd' is VK_NULL_HANDLE until the first copy
+    std::deque<UploadBatch_t> inFlight;  // Submitted batches, oldest first
+
+    UploadTicket_t submittedTicket = 0u;
+    UploadTicket_t completedTicket = 0u;
+    UploadStats_t  stats;
+
+    Device_t const *pDevice = nullptr;
 };
 
 //-----------------------------------------------
@@ -330,35 +649,52 @@ struct Vertex_t
 
 //---
 
-auto static inline InputStateVertex(bool empty = false)
+// . 24 bytes instead of 68 : the shaders decode it, see 'assets/shaders/base_2_packed.vert'
+struct PackedVertex_t
 {
-    static std::vector<VkVertexInputBindingDescription> const bindings = {
-        {.binding = 0, .stride = sizeof(Vertex_t), .inputRate = VK_VERTEX_INPUT_RATE_VERTEX}
-    };
-    static std::vector<VkVertexInputAttributeDescription> const attribs = {
-        {0, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(Vertex_t,    vertex)},
-        {1, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(Vertex_t,        uv)},
-        {2, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(Vertex_t,    normal)},
-        {3, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(Vertex_t,   tangent)},
-        {4, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(Vertex_t, bitangent)},
-        {5, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(Vertex_t,     color)},
-    };
-    static VkPipelineVertexInputStateCreateInfo const vertexFilled{
-        .sType                           = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
-        .vertexBindingDescriptionCount   = GetCountU32(bindings),
-        .pVertexBindingDescriptions      = GetData(bindings),
-        .vertexAttributeDescriptionCount = GetCountU32(attribs),
-        .pVertexAttributeDescriptions    = GetData(attribs),
-    };
-    static VkPipelineVertexInputStateCreateInfo const vertexEmpty{
-        .sType                           = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
-        .vertexBindingDescriptionCount   = 0,
-        .pVertexBindingDescriptions      = nullptr,
-        .vertexAttributeDescriptionCount = 0,
-        .pVertexAttributeDescriptions    = nullptr,
-    };
-    return !empty ? &vertexFilled : &vertexEmpty;
-}
+    uint64_t position; // 0 : unorm16x4 inside the mesh bounds, w is the bitangent sign (0 : negative)
+    uint32_t uv;       // 1 : half2
+    uint32_t normal;   // 2 : octahedral, snorm16x2
+    uint32_t tangent;  // 3 : octahedral, snorm16x2
+    uint32_t color;    // 4 : unorm8x4
+};
+static_assert(sizeof(PackedVertex_t) == 24u);
+
+//---
+
+// . Split streams : positions on their own buffer, so depth and shadow passes fetch just them
+struct AttributeStream_t
+{
+    glm::vec2 uv;        // 1
+    glm::vec3 normal;    // 2
+    glm::vec3 tangent;   // 3
+    glm::vec3 bitangent; // 4
+    glm::vec3 color;     // 5
+};
+struct PositionStream_t
+{
+    glm::vec3 vertex; // 0
+};
+struct PackedAttributeStream_t
+{
+    uint32_t uv;      // 1
+    uint32_t normal;  // 2
+    uint32_t tangent; // 3
+    uint32_t color;   // 4
+};
+struct PackedPositionStream_t
+{
+    uint64_t position; // 0
+};
+
+//---
+
+// . Per mesh, fetched at instance rate through 'firstInstance' : 'position = min + unorm * extent'
+struct MeshBounds_t
+{
+    glm::vec3 min    = glm::vec3(0.f); // 5
+    glm::vec3 extent = glm::vec3(0.f); // 6
+};
 
 //---
 
@@ -375,10 +711,187 @@ auto static inline InputStateAssembly()
 
 //-----------------------------------------------
 
+// . Cluster of a mesh : up to 64 vertices / 124 triangles, a contiguous run of its indices
+//   On the CPU the range is local to the mesh, on the arena it is rebased as the mesh's draw
+struct Meshlet_t
+{
+    glm::vec4 sphere        = glm::vec4(0.f); // Center, radius
+    glm::vec4 cone          = glm::vec4(0.f); // Average normal, cutoff : backfacing from 'eye' if 'dot(c - eye, axis) >= cutoff * |c - eye| + radius'
+    uint32_t  firstIndex    = 0u;
+    uint32_t  indexCount    = 0u;
+    int32_t   vertexOffset  = 0;
+    uint32_t  firstInstance = 0u;
+};
+static_assert(sizeof(Meshlet_t) == 48u); // Same as the std430 one of 'assets/shaders/cluster_cull.comp'
+
+//---
+
+// . Push constants of 'cluster_cull.comp'
+struct ClusterCull_t
+{
+    glm::vec4 planes[6];                     // Frustum, normalized : inside if 'dot(plane.xyz, p) + plane.w >= 0'
+    glm::vec4 eye          = glm::vec4(0.f); // w : 1 to test the normal cones too, 0 without a perspective camera
+    uint32_t  meshletCount = 0u;
+};
+
+//---
+
+// . Push constants of 'instance_cull.comp'
+struct InstanceCull_t
+{
+    glm::mat4 viewProj      = glm::mat4(1.f); // The frustum planes are taken from its rows there, as 'clusterCull' does
+    glm::vec4 lod           = glm::vec4(0.f); // xyz : eye, w : on screen size of one unit at distance 1
+    glm::vec2 pyramidSize   = glm::vec2(0.f); // Level 0 of the depth pyramid
+    float     maxPixels     = 0.f;            // 0 : always the base level, see 'selectMeshLod'
+    uint32_t  instanceCount = 0u;
+    uint32_t  capacity      = 0u;             // Draws of each list
+    uint32_t  phase         = 0u;             // 0 : every instance, 1 : the ones occluded on phase 0
+    uint32_t  pyramidLevels = 0u;             // 0 : no occlusion test
+};
+static_assert(sizeof(InstanceCull_t) <= 128u); // What every device takes as push constants
+
+//-----------------------------------------------
+
+// . Level of detail : a range of the mesh's indices over the same vertices, the base level first
+struct MeshLod_t
+{
+    uint32_t firstIndex = 0u;
+    uint32_t indexCount = 0u;
+    float    error      = 0.f; // Deviation from the base level, in mesh units
+};
+constexpr uint32_t sMaxMeshLods = 4u;
+
+//-----------------------------------------------
+
 struct Mesh_t
 {
-    Buffer_t indices;
-    Buffer_t vertices;
+    // . Range inside the GeometryArena_t : drawn with 'firstIndex' / 'vertexOffset'
+    uint32_t    firstIndex   = 0u; // In 'indexType' units
+    uint32_t    indexCount   = 0u;
+    int32_t     vertexOffset = 0;
+    uint32_t    vertexCount  = 0u;
+    VkIndexType indexType    = VK_INDEX_TYPE_UINT32; // UINT16 whenever the vertex count fits
+    uint32_t    resident     = UINT32_MAX;           // Its Resident_t, when evictable
+    uint32_t    bounds       = 0u; // Its MeshBounds_t slot, packed arenas only : drawn as 'firstInstance'
+    uint32_t    firstMeshlet = 0u; // Range inside 'GeometryArena_t::meshlets', and of its draws (base level only)
+    uint32_t    meshletCount = 0u; // 0 : drawn as a whole
+
+    // . 'firstIndex' / 'indexCount' span all the levels, each one is drawn on its own
+    std::array<MeshLod_t, sMaxMeshLods> lods     = {};
+    uint32_t                            lodCount = 1u;
+    glm::vec4                           sphere   = glm::vec4(0.f); // Center, radius : for the LOD selection
+};
+using MeshHandle_t = Handle_t<Mesh_t>;
+
+//-----------------------------------------------
+
+// . CPU side of a mesh : what gets uploaded into the arena
+struct MeshData_t
+{
+    std::vector<uint32_t>  indices;
+    std::vector<Vertex_t>  vertices;
+    std::vector<Meshlet_t> meshlets; // Optional : see 'buildMeshlets', they reference the base level of 'indices'
+    std::vector<MeshLod_t> lods;     // Optional : see 'buildLods', empty when 'indices' is just the base level
+};
+
+//-----------------------------------------------
+
+struct GeometryArena_t
+{
+    VertexFormat_t               format         = VertexFormat_t::Full;
+    bool                         split          = false;            // Positions on their own stream
+    uint32_t                     stride         = sizeof(Vertex_t); // Bytes per vertex in 'vertices'
+    uint32_t                     positionStride = 0u;               // Bytes per vertex in 'positions'
+
+    Buffer_t                     indices;   // .count == capacity in 32-bit slots : 16-bit meshes take one per 2 indices
+    Buffer_t                     vertices;  // .count == capacity in vertices : all but the positions when split
+    Buffer_t                     positions; // .count == capacity in vertices, split arenas only
+    Buffer_t                     bounds;    // .count == capacity in meshes, packed arenas only
+    Buffer_t                     meshlets;  // .count == capacity in meshlets
+    Buffer_t                     draws;     // VkDrawIndexedIndirectCommand per meshlet : written by the cluster culling
+
+    std::map<uint32_t, uint32_t> freeIndices;  // offset -> count, in slots
+    std::map<uint32_t, uint32_t> freeVertices; // offset -> count
+    std::map<uint32_t, uint32_t> freeMeshlets; // offset -> count
+    std::vector<uint32_t>        freeBounds;   // Slots, the lowest at the back
+};
+
+//-----------------------------------------------
+
+// . What 'instance_cull.comp' needs of a mesh to draw its instances, std430 as there
+struct DrawMesh_t
+{
+    glm::vec4  sphere        = glm::vec4(0.f); // Center, radius
+    glm::uvec4 firstIndex    = glm::uvec4(0u); // Per level, as 'Mesh_t::lods'
+    glm::uvec4 indexCount    = glm::uvec4(0u); // Base level 0 : never drawn, i.e. destroyed meshes
+    glm::vec4  lodError      = glm::vec4(0.f);
+    int32_t    vertexOffset  = 0;
+    uint32_t   lodCount      = 1u;
+    uint32_t   firstInstance = UINT32_MAX; // Its MeshBounds_t slot on packed arenas, UINT32_MAX : the instance's index
+    uint32_t   list          = 0u;         // Draws it goes to : 0 with 32-bit indices, 1 with 16-bit ones
+};
+static_assert(sizeof(DrawMesh_t) == 80u && sMaxMeshLods == 4u);
+
+//---
+
+// . Instances rejected by the culling of a frame, read back once the frame is done
+struct InstanceStats_t
+{
+    uint32_t instances = 0u;
+    uint32_t frustum   = 0u; // Outside the frustum
+    uint32_t occluded  = 0u; // Behind the depth of both phases
+    uint32_t late      = 0u; // Occluded on the previous frame's depth but not on this one's : drawn on phase 1
+};
+
+// . GPU-driven draws : the instances are culled and get their level on the GPU, the survivors compacted into one
+//   list of indirect draws per phase and index width, each drawn with the count the GPU wrote
+struct InstanceDraws_t
+{
+    static constexpr uint32_t sCounters = 7u; // As 'assets/shaders/instance_cull.comp' : 4 lists, retest, frustum, occluded
+
+    Buffer_t meshes;    // DrawMesh_t per distinct mesh of the instances
+    Buffer_t instances; // uint32_t per instance : into 'meshes'
+    Buffer_t draws;     // VkDrawIndexedIndirectCommand : per phase the 32-bit list then the 16-bit one, 'instances.count' each
+    Buffer_t counts;    // uint32_t per counter
+    Buffer_t retest;    // uint32_t per instance occluded on phase 0 : the ones phase 1 tests again
+    Buffer_t readback;  // Host visible : the counters, per frame in flight
+
+    uint32_t                  instanceCount = 0u;
+    std::array<uint32_t, 2>   listInstances = {}; // Per list : its 'maxDrawCount', 0 skips it
+    std::vector<MeshHandle_t> used;               // What 'meshes' holds, in order
+    std::vector<DrawMesh_t>   written;            // As last written : their ranges change when evicted and restored
+};
+
+//-----------------------------------------------
+
+struct Resident_t
+{
+    uint32_t              domain   = 0u;    // Memory heap its eviction frees (i.e. textures), or 'Residency_t::sGeometryDomain' for arena ranges
+    VkDeviceSize          bytes    = 0u;
+    uint64_t              lastUsed = 0u;    // Frame
+    bool                  resident = true;
+    bool                  pinned   = false; // Referenced by pre-recorded commands : never evicted
+    std::function<void()> evict    = nullptr;
+    std::function<void()> restore  = nullptr;
+};
+
+//-----------------------------------------------
+
+struct Residency_t
+{
+    static constexpr uint32_t sGeometryDomain = VK_MAX_MEMORY_HEAPS;
+    static constexpr float    sHighWatermark  = 0.90f; // Of the budget : start evicting
+    static constexpr float    sLowWatermark   = 0.80f; // Of the budget : stop evicting
+
+    std::vector<Resident_t> residents;
+    std::vector<uint32_t>   freeSlots;
+
+    uint64_t frame          = 0u;
+    uint32_t framesInFlight = 1u;    // Used during the last ones : may still be read by the GPU
+    bool     pinning        = false; // Touches pin the residents (i.e. while recording pre-baked commands)
+
+    uint32_t evictions = 0u;
+    uint32_t restores  = 0u;
 };
 
 //-----------------------------------------------
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "_vulkan.h"
+#include "VonkTypes.h"
+
+#include "Macros.h"
+
+namespace vonk
+{ //
+
+//-----------------------------------------------
+
+// UPLOADER
+//  Gathers host->device copies into a few command buffers on the transfer queue.
+//  Every batch signals the uploader's timeline semaphore with its ticket, so the
+//  graphics queue waits on the GPU side and the CPU never blocks on a copy.
+//  Host-visible destinations (UMA / ReBAR) skip all that and are written in place.
+
+Uploader_t createUploader(Device_t const &device);
+
+void destroyUploader(Uploader_t &uploader);
+
+UploadTicket_t uploadBuffer(Uploader_t &uploader, DataInfo_t di, Buffer_t const &dst, VkDeviceSize dstOffset = 0);
+
+// . The whole color image from tightly packed texels, always staged : left SHADER_READ_ONLY_OPTIMAL for the shaders
+UploadTicket_t uploadImage(Uploader_t &uploader, DataInfo_t di, VkImage dst, VkExtent2D extent);
+
+void flushUploads(Uploader_t &uploader);
+void pollUploads(Uploader_t &uploader);
+
+bool isUploadDone(Uploader_t &uploader, UploadTicket_t ticket);
+void waitUpload(Uploader_t &uploader, UploadTicket_t ticket);
+void waitAllUploads(Uploader_t &uploader);
+
+// . Direct vs staged path : counts, bytes and cpu time of each, to compare upload bandwidth
+void logUploadStats(Uploader_t const &uploader);
+
+//-----------------------------------------------
+
+} // namespace vonk
@@ -0,0 +1,287 @@
+#pragma once
+
+#include "VonkTypes.h"
+
+#include "Macros.h"
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+namespace vonk
+{ //
+
+//-----------------------------------------------
+
+// VERTEX LAYOUTs
+//  A vertex struct is described once, specializing VertexLayout_t with its
+//  attributes. 'vertexInputState<Layouts...>()' then builds the binding and
+//  attribute arrays at compile time : one binding per layout, in order, and
+//  the locations following the attributes across all of them.
+//  Tag types can describe a view over another struct (its stride, a subset of
+//  its attributes) : that's how lean pipelines fetch only what they need.
+
+// . Float types map on their own, anything else says its format (see 'VkAttributeAs')
+template <typename T> inline constexpr VkFormat sVkFormatOf = VK_FORMAT_UNDEFINED;
+template <> inline constexpr VkFormat sVkFormatOf<float>     = VK_FORMAT_R32_SFLOAT;
+template <> inline constexpr VkFormat sVkFormatOf<glm::vec2> = VK_FORMAT_R32G32_SFLOAT;
+template <> inline constexpr VkFormat sVkFormatOf<glm::vec3> = VK_FORMAT_R32G32B32_SFLOAT;
+template <> inline constexpr VkFormat sVkFormatOf<glm::vec4> = VK_FORMAT_R32G32B32A32_SFLOAT;
+
+struct VertexAttribute_t
+{
+    VkFormat format = VK_FORMAT_UNDEFINED;
+    uint32_t offset = 0u;
+};
+
+template <typename T>
+constexpr VertexAttribute_t vertexAttribute(size_t offset)
+{
+    static_assert(sVkFormatOf<T> != VK_FORMAT_UNDEFINED, "No implicit format for this type : use 'VkAttributeAs'");
+    return {sVkFormatOf<T>, static_cast<uint32_t>(offset)};
+}
+
+#define VkAttribute(type, member)           vonk::vertexAttribute<decltype(type::member)>(offsetof(type, member))
+#define VkAttributeAs(type, member, format) vonk::VertexAttribute_t{format, offsetof(type, member)}
+
+// . Specialize with 'sStride', 'sRate' and 'sAttributes'
+template <typename T>
+struct VertexLayout_t;
+
+//---
+
+template <>
+struct VertexLayout_t<Vertex_t>
+{
+    static constexpr uint32_t          sStride     = sizeof(Vertex_t);
+    static constexpr VkVertexInputRate sRate       = VK_VERTEX_INPUT_RATE_VERTEX;
+    static constexpr std::array        sAttributes = {
+        VkAttribute(Vertex_t, vertex),
+        VkAttribute(Vertex_t, uv),
+        VkAttribute(Vertex_t, normal),
+        VkAttribute(Vertex_t, tangent),
+        VkAttribute(Vertex_t, bitangent),
+        VkAttribute(Vertex_t, color),
+    };
+};
+
+template <>
+struct VertexLayout_t<PackedVertex_t>
+{
+    static constexpr uint32_t          sStride     = sizeof(PackedVertex_t);
+    static constexpr VkVertexInputRate sRate       = VK_VERTEX_INPUT_RATE_VERTEX;
+    static constexpr std::array        sAttributes = {
+        VkAttributeAs(PackedVertex_t, position, VK_FORMAT_R16G16B16A16_UNORM),
+        VkAttributeAs(PackedVertex_t, uv, VK_FORMAT_R16G16_SFLOAT),
+        VkAttributeAs(PackedVertex_t, normal, VK_FORMAT_R16G16_SNORM),
+        VkAttributeAs(PackedVertex_t, tangent, VK_FORMAT_R16G16_SNORM),
+        VkAttributeAs(PackedVertex_t, color, VK_FORMAT_R8G8B8A8_UNORM),
+    };
+};
+
+template <>
+struct VertexLayout_t<MeshBounds_t>
+{
+    static constexpr uint32_t          sStride     = sizeof(MeshBounds_t);
+    static constexpr VkVertexInputRate sRate       = VK_VERTEX_INPUT_RATE_INSTANCE;
+    static constexpr std::array        sAttributes = {
+        VkAttribute(MeshBounds_t, min),
+        VkAttribute(MeshBounds_t, extent),
+    };
+};
+
+//---
+
+// . Views : only the position, over the arena's vertices (packed ones also need their MeshBounds_t)
+struct VertexPosition_t;
+struct PackedVertexPosition_t;
+
+template <>
+struct VertexLayout_t<VertexPosition_t>
+{
+    static constexpr uint32_t          sStride     = sizeof(Vertex_t);
+    static constexpr VkVertexInputRate sRate       = VK_VERTEX_INPUT_RATE_VERTEX;
+    static constexpr std::array        sAttributes = {VkAttribute(Vertex_t, vertex)};
+};
+
+template <>
+struct VertexLayout_t<PackedVertexPosition_t>
+{
+    static constexpr uint32_t          sStride     = sizeof(PackedVertex_t);
+    static constexpr VkVertexInputRate sRate       = VK_VERTEX_INPUT_RATE_VERTEX;
+    static constexpr std::array        sAttributes = {
+        VkAttributeAs(PackedVertex_t, position, VK_FORMAT_R16G16B16A16_UNORM),
+    };
+};
+
+//---
+
+// . Split streams : the positions first, so the attributes keep the interleaved locations
+template <>
+struct VertexLayout_t<PositionStream_t>
+{
+    static constexpr uint32_t          sStride     = sizeof(PositionStream_t);
+    static constexpr VkVertexInputRate sRate       = VK_VERTEX_INPUT_RATE_VERTEX;
+    static constexpr std::array        sAttributes = {VkAttribute(PositionStream_t, vertex)};
+};
+
+template <>
+struct VertexLayout_t<AttributeStream_t>
+{
+    static constexpr uint32_t          sStride     = sizeof(AttributeStream_t);
+    static constexpr VkVertexInputRate sRate       = VK_VERTEX_INPUT_RATE_VERTEX;
+    static constexpr std::array        sAttributes = {
+        VkAttribute(AttributeStream_t, uv),
+        VkAttribute(AttributeStream_t, normal),
+        VkAttribute(AttributeStream_t, tangent),
+        VkAttribute(AttributeStream_t, bitangent),
+        VkAttribute(AttributeStream_t, color),
+    };
+};
+
+template <>
+struct VertexLayout_t<PackedPositionStream_t>
+{
+    static constexpr uint32_t          sStride     = sizeof(PackedPositionStream_t);
+    static constexpr VkVertexInputRate sRate       = VK_VERTEX_INPUT_RATE_VERTEX;
+    static constexpr std::array        sAttributes = {
+        VkAttributeAs(PackedPositionStream_t, position, VK_FORMAT_R16G16B16A16_UNORM),
+    };
+};
+
+template <>
+struct VertexLayout_t<PackedAttributeStream_t>
+{
+    static constexpr uint32_t          sStride     = sizeof(PackedAttributeStream_t);
+    static constexpr VkVertexInputRate sRate       = VK_VERTEX_INPUT_RATE_VERTEX;
+    static constexpr std::array        sAttributes = {
+        VkAttributeAs(PackedAttributeStream_t, uv, VK_FORMAT_R16G16_SFLOAT),
+        VkAttributeAs(PackedAttributeStream_t, normal, VK_FORMAT_R16G16_SNORM),
+        VkAttributeAs(PackedAttributeStream_t, tangent, VK_FORMAT_R16G16_SNORM),
+        VkAttributeAs(PackedAttributeStream_t, color, VK_FORMAT_R8G8B8A8_UNORM),
+    };
+};
+
+//---
+
+template <typename... Layouts>
+constexpr auto vertexBindings()
+{
+    std::array<VkVertexInputBindingDescription, sizeof...(Layouts)> bindings{};
+    uint32_t binding = 0u;
+    ((bindings[binding] = {binding, VertexLayout_t<Layouts>::sStride, VertexLayout_t<Layouts>::sRate}, ++binding), ...);
+    return bindings;
+}
+
+template <typename... Layouts>
+constexpr auto vertexAttributes()
+{
+    std::array<VkVertexInputAttributeDescription, (VertexLayout_t<Layouts>::sAttributes.size() + ... + 0)> attribs{};
+    uint32_t binding  = 0u;
+    uint32_t location = 0u;
+
+    MBU auto const add = [&](auto const &attributes) {
+        for (auto const &a : attributes)
+        {
+            attribs[location] = {location, binding, a.format, a.offset};
+            ++location;
+        }
+        ++binding;
+    };
+    (add(VertexLayout_t<Layouts>::sAttributes), ...);
+    return attribs;
+}
+
+// . No layouts : no vertex input at all
+template <typename... Layouts>
+VertexInput_t const *vertexInputState()
+{
+    static constexpr auto bindings = vertexBindings<Layouts...>();
+    static constexpr auto attribs  = vertexAttributes<Layouts...>();
+    static VertexInput_t const state{
+        .sType                           = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
+        .vertexBindingDescriptionCount   = GetCountU32(bindings),
+        .pVertexBindingDescriptions      = bindings.empty() ? nullptr : GetData(bindings),
+        .vertexAttributeDescriptionCount = GetCountU32(attribs),
+        .pVertexAttributeDescriptions    = attribs.empty() ? nullptr : GetData(attribs),
+    };
+    return &state;
+}
+
+// . The whole vertex, as the geometry arena binds it : same locations for every format and streams
+inline VertexInput_t const *
+  InputStateVertex(bool empty = false, VertexFormat_t format = VertexFormat_t::Full, bool split = false)
+{
+    if (empty)
+        return vertexInputState<>();
+    if (format == VertexFormat_t::Packed)
+        return split ? vertexInputState<PackedPositionStream_t, PackedAttributeStream_t, MeshBounds_t>()
+                     : vertexInputState<PackedVertex_t, MeshBounds_t>();
+    return split ? vertexInputState<PositionStream_t, AttributeStream_t>() : vertexInputState<Vertex_t>();
+}
+
+// . Just the position (location 0, the bounds follow on packed arenas), see 'bindGeometryArena'
+inline VertexInput_t const *InputStatePositions(VertexFormat_t format = VertexFormat_t::Full, bool split = false)
+{
+    if (format == VertexFormat_t::Packed)
+        return split ? vertexInputState<PackedPositionStream_t, MeshBounds_t>()
+                     : vertexInputState<PackedVertexPosition_t, MeshBounds_t>();
+    return split ? vertexInputState<PositionStream_t>() : vertexInputState<VertexPosition_t>();
+}
+
+//-----------------------------------------------
+
+// VERTEX FORMATs
+//  The CPU side always works with Vertex_t, the geometry arena stores it in its
+//  VertexFormat_t. Packing happens on upload, so the evicted meshes keep their
+//  full CPU copy and are packed again on restore.
+
+// . Bytes per vertex on the 'vertices' buffer : all but the position when split
+inline uint32_t vertexStride(VertexFormat_t format, bool split = false)
+{
+    if (format == VertexFormat_t::Packed)
+        return split ? sizeof(PackedAttributeStream_t) : sizeof(PackedVertex_t);
+    return split ? sizeof(AttributeStream_t) : sizeof(Vertex_t);
+}
+
+// . Bytes per vertex on the 'positions' buffer, none when interleaved
+inline uint32_t positionStride(VertexFormat_t format, bool split)
+{
+    if (!split)
+        return 0u;
+    return format == VertexFormat_t::Packed ? sizeof(PackedPositionStream_t) : sizeof(PositionStream_t);
+}
+
+// . Octahedral mapping of a unit vector into [-1, 1]^2, zero vectors map to +Z
+glm::vec2 octEncode(glm::vec3 n);
+glm::vec3 octDecode(glm::vec2 e);
+
+MeshBounds_t computeBounds(std::vector<Vertex_t> const &vertices);
+
+// . Center, radius : the sphere around the box
+inline glm::vec4 boundingSphere(MeshBounds_t const &bounds)
+{
+    return glm::vec4(bounds.min + bounds.extent * 0.5f, glm::length(bounds.extent) * 0.5f);
+}
+
+// . 'bounds' has to enclose the vertices, positions outside it are clamped
+PackedVertex_t              packVertex(Vertex_t const &vertex, MeshBounds_t const &bounds);
+std::vector<PackedVertex_t> packVertices(std::vector<Vertex_t> const &vertices, MeshBounds_t const &bounds);
+Vertex_t                    unpackVertex(PackedVertex_t const &packed, MeshBounds_t const &bounds);
+
+// . What the arena stores for some vertices, appended : 'positions' stays empty when interleaved
+struct VertexStreams_t
+{
+    std::vector<char> vertices;
+    std::vector<char> positions;
+};
+void encodeVertices(
+    std::vector<Vertex_t> const &vertices,
+    VertexFormat_t               format,
+    bool                         split,
+    MeshBounds_t const          &bounds,
+    VertexStreams_t             &streams);
+
+//-----------------------------------------------
+
+} // namespace vonk
@@ -1,7 +1,51 @@
 #include "Utils.h"
 #include "Macros.h"
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
 #include <fstream>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace vo::algo
+{
+//
+
+//-----------------------------------------------
+
+uint64_t hash64(void const *data, size_t bytes, uint64_t seed)
+{
+  // . FNV-1a over 8-byte words, with a fold so the high bits reach the low ones
+  constexpr uint64_t prime = 0x100000001b3ull;
+  auto const *       src   = static_cast<unsigned char const *>(data);
+  uint64_t           h     = seed ^ bytes;
+
+  size_t i = 0;
+  for (; i + 8 <= bytes; i += 8) {
+    uint64_t word;
+    std::memcpy(&word, src + i, 8);
+    h = (h ^ word) * prime;
+    h ^= h >> 29;
+  }
+  for (; i < bytes; ++i) { h = (h ^ src[i]) * prime; }
+  return h ^ (h >> 32);
+}
+
+//-----------------------------------------------
+
+}  // namespace vo::algo
 
 namespace vo::files
 {
@@ -33,4 +77,207 @@ std::vector<char> read(std::string const &filepath)
 
 //-----------------------------------------------
 
+// ::: Map file content
+Mapping_t map(std::string const &filepath)
+{
+  Mapping_t mapping;
+
+#if defined(_WIN32)
+  auto const file = CreateFileA(
+    filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+  if (file == INVALID_HANDLE_VALUE) return mapping;
+
+  LARGE_INTEGER size {};
+  if (GetFileSizeEx(file, &size) and size.QuadPart > 0) {
+    // . The mapping object keeps the file open : its handle is not needed anymore
+    auto const handle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (handle) {
+      mapping.mData   = static_cast<char const *>(MapViewOfFile(handle, FILE_MAP_READ, 0, 0, 0));
+      mapping.mSize   = static_cast<size_t>(size.QuadPart);
+      mapping.mHandle = handle;
+      if (!mapping.mData) { mapping.reset(); }
+    }
+  }
+  CloseHandle(file);
+#else
+  auto const fd = ::open(filepath.c_str(), O_RDONLY);
+  if (fd < 0) return mapping;
+
+  struct stat info {};
+  if (::fstat(fd, &info) == 0 and info.st_size > 0) {
+    // . The mapping keeps the file alive : the descriptor is not needed anymore
+    auto const size = static_cast<size_t>(info.st_size);
+    auto *const ptr = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (ptr != MAP_FAILED) {
+      // . Two calls : the advice values are not flags, OR-ing them asks for something else
+      ::madvise(ptr, size, MADV_SEQUENTIAL);
+      ::madvise(ptr, size, MADV_WILLNEED);
+      mapping.mData = static_cast<char const *>(ptr);
+      mapping.mSize = size;
+    }
+  }
+  ::close(fd);
+#endif
+
+  return mapping;
+}
+
+//-----------------------------------------------
+
+Mapping_t::~Mapping_t() { reset(); }
+
+Mapping_t::Mapping_t(Mapping_t &&other) noexcept
+  : mData(std::exchange(other.mData, nullptr))
+  , mSize(std::exchange(other.mSize, 0u))
+  , mHandle(std::exchange(other.mHandle, nullptr))
+{
+}
+
+Mapping_t &Mapping_t::operator=(Mapping_t &&other) noexcept
+{
+  if (this != &other) {
+    reset();
+    mData   = std::exchange(other.mData, nullptr);
+    mSize   = std::exchange(other.mSize, 0u);
+    mHandle = std::exchange(other.mHandle, nullptr);
+  }
+  return *this;
+}
+
+void Mapping_t::reset()
+{
+#if defined(_WIN32)
+  if (mData) { UnmapViewOfFile(mData); }
+  if (mHandle) { CloseHandle(mHandle); }
+#else
+  if (mData) { ::munmap(const_cast<char *>(mData), mSize); }
+#endif
+  mData   = nullptr;
+  mSize   = 0u;
+  mHandle = nullptr;
+}
+
+//-----------------------------------------------
+
 }  // namespace vo::files
+
+namespace vo::jobs
+{
+//
+
+//-----------------------------------------------
+
+namespace
+{
+// . Set on the pool's threads, and on the caller while it runs a loop
+thread_local bool sInLoop = false;
+
+// . Started on the first loop and joined at exit : its threads sleep between loops
+class Pool_t
+{
+public:
+  Pool_t()
+  {
+    auto const workers = std::max(std::thread::hardware_concurrency(), 1u) - 1u;
+    mThreads.reserve(workers);
+    for (uint32_t i = 0; i < workers; ++i) { mThreads.emplace_back([this]() { run(); }); }
+  }
+
+  ~Pool_t()
+  {
+    {
+      std::lock_guard lock { mMutex };
+      mStop = true;
+    }
+    mWake.notify_all();
+    for (auto &t : mThreads) { t.join(); }
+  }
+
+  // . Queued next to the loops of the other threads : the threads share out between all of them
+  bool loop(size_t count, std::function<void(size_t)> const &fn)
+  {
+    if (mThreads.empty()) return false;
+
+    Job_t job { &fn, count };
+    {
+      std::lock_guard lock { mMutex };
+      mJobs.push_back(&job);
+    }
+    mWake.notify_all();
+
+    sInLoop = true;
+    work(job);
+    sInLoop = false;
+
+    // . Out of the queue first, so no late thread joins it, then done once the threads in it are
+    std::unique_lock lock { mMutex };
+    std::erase(mJobs, &job);
+    mDone.wait(lock, [&job]() { return job.busy == 0u; });
+    return true;
+  }
+
+private:
+  // . On the stack of the thread that started the loop, queued while it runs
+  struct Job_t
+  {
+    std::function<void(size_t)> const *fn    = nullptr;
+    size_t                             count = 0u;
+    std::atomic<size_t>                next { 0u };
+    uint32_t                           busy = 0u;  // Threads of the pool in it, under 'mMutex'
+  };
+
+  static void work(Job_t &job)
+  {
+    for (size_t i = job.next++; i < job.count; i = job.next++) { (*job.fn)(i); }
+  }
+
+  // . The oldest loop with items left
+  Job_t *pending() const
+  {
+    auto const it = std::ranges::find_if(mJobs, [](Job_t const *job) { return job->next < job->count; });
+    return it != mJobs.end() ? *it : nullptr;
+  }
+
+  void run()
+  {
+    sInLoop = true;
+
+    std::unique_lock lock { mMutex };
+    while (true) {
+      Job_t *job = nullptr;
+      mWake.wait(lock, [&]() { return mStop or (job = pending()) != nullptr; });
+      if (mStop) return;
+
+      ++job->busy;
+      lock.unlock();
+      work(*job);
+      lock.lock();
+      if (--job->busy == 0u) { mDone.notify_all(); }
+    }
+  }
+
+  std::vector<std::thread> mThreads;
+  std::mutex               mMutex;  // The queue, and the jobs' 'busy'
+  std::condition_variable  mWake;
+  std::condition_variable  mDone;
+  std::vector<Job_t *>     mJobs;
+  bool                     mStop = false;
+};
+}  // namespace
+
+//-----------------------------------------------
+
+void parallelFor(size_t count, std::function<void(size_t)> const &fn)
+{
+  if (count < 1) return;
+
+  // . Nested loops and single items : on the calling thread
+  static Pool_t sPool;
+  if (sInLoop or count < 2 or !sPool.loop(count, fn)) {
+    for (size_t i = 0; i < count; ++i) { fn(i); }
+  }
+}
+
+//-----------------------------------------------
+
+}  // namespace vo::jobs
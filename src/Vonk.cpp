@@ -1,9 +1,16 @@
 #include "Vonk.h"
+#include "VonkImport.h"
+#include "VonkMeshOps.h"
 #include "VonkResources.h"
 #include "VonkTools.h"
 #include "VonkWindow.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
 #include <filesystem>
+#include <thread>
 
 namespace vonk
 { //
@@ -14,45 +21,517 @@ namespace vonk
 
 //-------------------------------------
 
-std::vector<Mesh_t> Vonk::read3DFile(
-    MBU std::string const &filepath,
-    MBU uint32_t           optimizationLevel,
-    MBU bool               recalculateUVs,
-    MBU bool               recalculateNormals,
-    MBU bool               recalculateTangentsAndBitangets)
+std::vector<MeshHandle_t> Vonk::read3DFile(
+    std::string const &filepath,
+    uint32_t           optimizationLevel,
+    bool               recalculateUVs,
+    bool               recalculateNormals,
+    bool               recalculateTangentsAndBitangets,
+    uint32_t           lodLevels)
 {
-    return {};
+    // . Decode : accessors are decoded across worker threads
+    auto meshesData = vonk::importGltf(filepath);
+    if (meshesData.empty())
+        return {};
+
+    // . Prepare : attributes, optimizations, meshlets and LODs
+    vonk::prepareMeshes(
+        meshesData,
+        optimizationLevel,
+        recalculateUVs,
+        recalculateNormals,
+        recalculateTangentsAndBitangets,
+        lodLevels,
+        sPassOverdraw);
+
+    // . Upload : all of them on a single arena range, two copies in total
+    uint32_t indexCount   = 0u;
+    uint32_t indexSlots   = 0u;
+    uint32_t vertexCount  = 0u;
+    uint32_t meshletCount = 0u;
+    for (auto const &data : meshesData)
+    {
+        indexCount += GetCountU32(data.indices);
+        indexSlots += vonk::meshIndexSlots(GetCountU32(data.indices), GetCountU32(data.vertices));
+        vertexCount += GetCountU32(data.vertices);
+        meshletCount += GetCountU32(data.meshlets);
+    }
+
+    std::vector<MeshHandle_t> meshes;
+    {
+        std::lock_guard lock{mGeometryMutex};
+        makeRoomForMesh(indexSlots, vertexCount, meshletCount);
+        auto const created = vonk::createMeshes(mDevice, mGeometry, meshesData);
+
+        meshes.reserve(created.size());
+        for (size_t i = 0; i < created.size(); ++i)
+            meshes.push_back(addMesh(created[i], std::move(meshesData[i])));
+    }
+
+    LogInfof(
+        "MESHES -> '{}' : {} meshes, {} vertices ({}B each), {} indices, {} meshlets",
+        filepath,
+        meshes.size(),
+        vertexCount,
+        mGeometry.stride + mGeometry.positionStride,
+        indexCount,
+        meshletCount);
+    return meshes;
 }
 
 //-------------------------------------
 
-Mesh_t const &Vonk::createMesh(std::vector<uint32_t> const &indices, std::vector<Vertex_t> const &vertices)
+bool Vonk::cook3DFile(
+    std::string const &filepath,
+    std::string const &cookedPath,
+    uint32_t           optimizationLevel,
+    bool               recalculateUVs,
+    bool               recalculateNormals,
+    bool               recalculateTangentsAndBitangets,
+    uint32_t           lodLevels)
 {
-    // @DANI : Change this for a "trace and fill the gaps"-pattern, basically a stack of removed IDs;
-    static uint32_t meshCountID = 0;
-    uint32_t        meshID      = 0;
+    auto meshesData = vonk::importGltf(filepath);
+    if (meshesData.empty())
+        return false;
+
+    vonk::prepareMeshes(
+        meshesData,
+        optimizationLevel,
+        recalculateUVs,
+        recalculateNormals,
+        recalculateTangentsAndBitangets,
+        lodLevels,
+        sPassOverdraw);
+    return vonk::cookMeshes(cookedPath, meshesData, sVertexFormat, sSplitStreams);
+}
+
+//-------------------------------------
 
-    if (!mRemovedMeshes.empty())
+std::vector<MeshHandle_t> Vonk::readCookedFile(std::string const &cookedPath)
+{
+    using Clock        = std::chrono::steady_clock;
+    using Milliseconds = std::chrono::duration<double, std::milli>;
+    auto const start   = Clock::now();
+
+    // . Mapped : the payloads go from the page cache to the staging memory, and stay there for the restores
+    auto const cooked = vonk::openCookedMeshes(cookedPath, mGeometry.format, mGeometry.split);
+    if (!cooked)
+        return {};
+
+    auto const               &header = *cooked.header;
+    std::vector<MeshHandle_t> meshes;
     {
-        meshID = mRemovedMeshes.top();
-        mRemovedMeshes.pop();
+        std::lock_guard lock{mGeometryMutex};
+        makeRoomForMesh(header.indexSlots, header.vertexCount, header.meshletCount);
+        auto const created = vonk::createMeshes(mDevice, mGeometry, cooked);
+
+        meshes.reserve(created.size());
+        for (uint32_t i = 0; i < created.size(); ++i)
+            meshes.push_back(addMesh(created[i], cooked, i));
     }
-    else
+
+    LogInfof(
+        "MESHES -> '{}' : {} meshes, {} vertices, {} index slots, {} meshlets, {:.1f}MB mapped : {:.1f}ms",
+        cookedPath,
+        meshes.size(),
+        header.vertexCount,
+        header.indexSlots,
+        header.meshletCount,
+        cooked.file->size() / (1024.0 * 1024.0),
+        Milliseconds(Clock::now() - start).count());
+    return meshes;
+}
+
+//-------------------------------------
+
+MeshHandle_t Vonk::createMesh(std::vector<uint32_t> const &indices, std::vector<Vertex_t> const &vertices)
+{
+    // . No meshlets : building them reorders the triangles, and the index updates address the caller's order
+    MeshData_t data{indices, vertices};
+
+    std::lock_guard lock{mGeometryMutex};
+    auto const      vertexCount = GetCountU32(vertices);
+    makeRoomForMesh(vonk::meshIndexSlots(GetCountU32(indices), vertexCount), vertexCount, GetCountU32(data.meshlets));
+    auto const created = vonk::createMesh(mDevice, mGeometry, data);
+    return addMesh(created, std::move(data));
+}
+
+//-------------------------------------
+
+void Vonk::destroyMesh(MeshHandle_t handle)
+{
+    // . Its draws must not be in any pending commands : the range gets reused
+    std::lock_guard lock{mGeometryMutex};
+    Mesh_t          mesh;
+    if (!mMeshes.erase(handle, &mesh))
+        return;
+    vonk::removeResident(mResidency, mesh.resident);
+    vonk::destroyMesh(mGeometry, mesh);
+}
+
+//-------------------------------------
+
+std::optional<Mesh_t> Vonk::getMesh(MeshHandle_t handle) const { return mMeshes.get(handle); }
+
+//-------------------------------------
+
+MeshHandle_t Vonk::addMesh(Mesh_t const &created, MeshData_t data)
+{
+    // . Restored from the CPU copy : encoded again on the way
+    return addMesh(created, [this, data = std::move(data)]() {
+        auto const vertexCount = GetCountU32(data.vertices);
+        makeRoomForMesh(vonk::meshIndexSlots(GetCountU32(data.indices), vertexCount), vertexCount, GetCountU32(data.meshlets));
+        return vonk::createMesh(mDevice, mGeometry, data);
+    });
+}
+MeshHandle_t Vonk::addMesh(Mesh_t const &created, CookedMeshes_t const &cooked, uint32_t index)
+{
+    // . Restored from the mapping : no CPU copy, the file stays mapped while any of its meshes is alive
+    return addMesh(created, [this, cooked, index]() {
+        auto const &src = cooked.meshes[index];
+        makeRoomForMesh(vonk::meshIndexSlots(src.indexCount, src.vertexCount), src.vertexCount, src.meshletCount);
+        return vonk::createMesh(mDevice, mGeometry, cooked, index);
+    });
+}
+MeshHandle_t Vonk::addMesh(Mesh_t const &created, std::function<Mesh_t()> recreate)
+{
+    // . Residency : the arena range is given back on eviction and 'recreate' uploads it again on restore
+    //   Both run under 'mGeometryMutex', from whoever needed the memory or touched the mesh
+    auto const vertexBytes  = VkDeviceSize{mGeometry.stride} + mGeometry.positionStride;
+    auto const indexBytes   = VkDeviceSize{vonk::meshIndexSlots(created.indexCount, created.vertexCount)} * sizeof(uint32_t);
+    auto const clusterBytes = VkDeviceSize{created.meshletCount} * (sizeof(Meshlet_t) + sizeof(VkDrawIndexedIndirectCommand));
+    auto const bytes        = indexBytes + created.vertexCount * vertexBytes + clusterBytes;
+
+    auto const handle = mMeshes.insert(created);
+    auto const evict  = [this, handle]() {
+        mMeshes.update(handle, [this](Mesh_t &m) {
+            auto const resident = m.resident;
+            vonk::destroyMesh(mGeometry, m);
+            m.resident = resident;
+        });
+    };
+    auto restore = [this, handle, recreate = std::move(recreate)]() {
+        auto const fresh = recreate();
+        mMeshes.update(handle, [&fresh](Mesh_t &m) {
+            auto const resident = m.resident;
+            m                   = fresh;
+            m.resident          = resident;
+        });
+    };
+    auto const resident = vonk::addResident(mResidency, Residency_t::sGeometryDomain, bytes, evict, std::move(restore));
+    mMeshes.update(handle, [resident](Mesh_t &m) { m.resident = resident; });
+
+    return handle;
+}
+
+//-------------------------------------
+
+void Vonk::makeRoomForMesh(uint32_t indexSlots, uint32_t vertexCount, uint32_t meshletCount)
+{
+    // . Evicting by bytes may not be enough with a fragmented arena : keep going while it helps
+    auto const vertexBytes = VkDeviceSize{mGeometry.stride} + mGeometry.positionStride;
+    auto const bytes       = VkDeviceSize{indexSlots} * sizeof(uint32_t) + vertexCount * vertexBytes;
+    while (!vonk::fitsGeometryArena(mGeometry, indexSlots, vertexCount, meshletCount))
+    {
+        if (vonk::evictResidents(mResidency, Residency_t::sGeometryDomain, bytes) < 1)
+            break;
+    }
+}
+
+//-------------------------------------
+
+Mesh_t Vonk::touchMesh(MeshHandle_t handle)
+{
+    // . Under 'mGeometryMutex' : restores it first when evicted, so the copy returned is the live one
+    auto const mesh = mMeshes.get(handle);
+    AbortIfMsg(!mesh.has_value(), "Stale mesh handle!");
+    if (mesh->resident == UINT32_MAX)
+        return *mesh;
+
+    vonk::touchResident(mResidency, mesh->resident);
+    return mMeshes.get(handle).value();
+}
+
+//-------------------------------------
+
+// . All the meshes live on the same arena : bind it once per pass and then just draw
+void Vonk::bindMeshes(VkCommandBuffer cmd, bool positionsOnly)
+{
+    std::lock_guard lock{mGeometryMutex};
+    vonk::bindGeometryArena(cmd, mGeometry, positionsOnly);
+    mBoundIndexTypes[cmd] = VK_INDEX_TYPE_UINT32;
+}
+void Vonk::unbindMeshes(std::span<VkCommandBuffer const> cmds)
+{
+    // . Reset or freed : the handles come back on the next recordings, which have to 'bindMeshes' again
+    std::lock_guard lock{mGeometryMutex};
+    for (auto const cmd : cmds)
+        mBoundIndexTypes.erase(cmd);
+}
+void Vonk::drawMesh(VkCommandBuffer cmd, MeshHandle_t mesh)
+{
+    // . Just the draw : the indices are only rebound when its width differs from the last one on 'cmd'
+    std::lock_guard lock{mGeometryMutex};
+    auto const      live  = touchMesh(mesh);
+    auto const      bound = mBoundIndexTypes.find(cmd);
+    AbortIfMsg(bound == mBoundIndexTypes.end(), "Mesh drawn on a command buffer without 'bindMeshes'!");
+    if (live.indexType != bound->second)
+    {
+        bound->second = live.indexType;
+        vonk::bindMeshIndices(cmd, mGeometry, live.indexType);
+    }
+    vonk::drawMesh(cmd, live);
+}
+void Vonk::drawMeshes(VkCommandBuffer cmd, std::vector<MeshHandle_t> const &meshes, bool positionsOnly)
+{
+    recordMeshDraws(cmd, touchMeshes(meshes), positionsOnly, false);
+}
+void Vonk::drawMeshClusters(VkCommandBuffer cmd, std::vector<MeshHandle_t> const &meshes, bool positionsOnly)
+{
+    drawMeshClusters(cmd, touchMeshes(meshes), positionsOnly);
+}
+std::vector<Mesh_t> Vonk::touchMeshes(std::vector<MeshHandle_t> const &meshes)
+{
+    // . Touched on this frame : not evicted until it is done, so the copies keep their ranges
+    std::lock_guard     lock{mGeometryMutex};
+    std::vector<Mesh_t> touched;
+    touched.reserve(meshes.size());
+    for (auto const handle : meshes)
+        touched.push_back(touchMesh(handle));
+    return touched;
+}
+void Vonk::drawMeshes(VkCommandBuffer cmd, std::span<Mesh_t const> touched, bool positionsOnly)
+{
+    recordMeshDraws(cmd, touched, positionsOnly, false);
+}
+void Vonk::drawMeshClusters(VkCommandBuffer cmd, std::span<Mesh_t const> touched, bool positionsOnly)
+{
+    // . Packed meshes pick their bounds through 'firstInstance', which the indirect draws only honor with the feature
+    AbortIfMsg(
+        mGeometry.format == VertexFormat_t::Packed && !mGpu.features.drawIndirectFirstInstance,
+        "Cluster culling on a packed arena needs 'drawIndirectFirstInstance'!");
+    recordMeshDraws(cmd, touched, positionsOnly, true);
+}
+void Vonk::recordMeshDraws(VkCommandBuffer cmd, std::span<Mesh_t const> touched, bool positionsOnly, bool clusters) const
+{
+    // . Only reads : the arena buffers never move and the LOD settings change between frames
+    // . Same buffer for both widths : only rebound when the index type changes between meshes
+    vonk::bindGeometryArena(cmd, mGeometry, positionsOnly);
+    auto       boundType = VK_INDEX_TYPE_UINT32;
+    auto const multiDraw = mGpu.features.multiDrawIndirect == VK_TRUE;
+    for (auto const &live : touched)
+    {
+        if (live.indexType != boundType)
+        {
+            boundType = live.indexType;
+            vonk::bindMeshIndices(cmd, mGeometry, boundType);
+        }
+        auto const lod = selectLod(live);
+        if (clusters && live.meshletCount > 0 && lod == 0)
+            vonk::drawMeshlets(cmd, mGeometry, live, multiDraw);
+        else
+            vonk::drawMesh(cmd, live, lod);
+    }
+}
+uint32_t Vonk::selectLod(Mesh_t const &mesh) const
+{
+    if (mLodMaxPixels <= 0.f || mesh.lodCount < 2)
+        return 0u;
+
+    // . From the closest point of the sphere : inside it, the base level
+    auto const distance = glm::length(glm::vec3(mesh.sphere) - mLodEye) - mesh.sphere.w;
+    if (distance <= 0.f)
+        return 0u;
+    return vonk::selectMeshLod(mesh, distance, mLodPixelsPerUnit, mLodMaxPixels);
+}
+
+//-------------------------------------
+
+void Vonk::setClusterCulling(glm::mat4 const &viewProj, glm::vec3 const &eye, bool cones)
+{
+    mClusterCull  = vonk::clusterCull(viewProj, eye, cones);
+    mCullViewProj = viewProj;
+}
+void Vonk::setLodSelection(glm::vec3 const &eye, float fovY, float viewportHeight, float maxPixels)
+{
+    mLodEye           = eye;
+    mLodPixelsPerUnit = viewportHeight / (2.f * std::tan(fovY * 0.5f));
+    mLodMaxPixels     = maxPixels;
+}
+
+//-------------------------------------
+
+void Vonk::setInstances(std::vector<MeshHandle_t> const &instances)
+{
+    AbortIfMsg(instances.size() > mInstanceDraws.instances.count, "Too many instances for the GPU-driven draws!");
+
+    // . Distinct meshes in order of first use, each instance points to its own
+    std::unordered_map<uint64_t, uint32_t> slots;
+    std::vector<MeshHandle_t>              used;
+    std::vector<uint32_t>                  indices;
+    indices.reserve(instances.size());
+    for (auto const handle : instances)
+    {
+        auto const key         = (uint64_t{handle.index} << 32) | handle.generation;
+        auto const [it, added] = slots.try_emplace(key, GetCountU32(used));
+        if (added)
+            used.push_back(handle);
+        indices.push_back(it->second);
+    }
+    AbortIfMsg(used.size() > mInstanceDraws.meshes.count, "Too many distinct meshes for the GPU-driven draws!");
+
+    // . Written on the next frame : the meshes by 'refreshInstanceMeshes', none of them matching what is there
+    std::lock_guard lock{mGeometryMutex};
+    auto           &draws = mInstanceDraws;
+    draws.used            = std::move(used);
+    draws.written.assign(draws.used.size(), DrawMesh_t{.lodCount = 0u});
+    draws.instanceCount = GetCountU32(indices);
+    draws.listInstances = {};
+    std::vector<uint32_t> lists(draws.used.size());
+    for (size_t i = 0; i < draws.used.size(); ++i)
+    {
+        auto const mesh = mMeshes.get(draws.used[i]);
+        AbortIfMsg(!mesh.has_value(), "Stale mesh handle!");
+        lists[i] = mesh->indexType == VK_INDEX_TYPE_UINT16 ? 1u : 0u;
+    }
+    for (auto const index : indices)
+        ++draws.listInstances[lists[index]];
+    vonk::queueBufferUpdate(mMeshUpdates, draws.instances, 0u, GetDataInfo(indices));
+}
+void Vonk::drawInstances(VkCommandBuffer cmd, bool positionsOnly, bool late) const
+{
+    // . Any 'firstInstance' : the instance's index or, on packed arenas, the bounds' slot
+    AbortIfMsg(
+        !mGpu.features12.drawIndirectCount || !mGpu.features.drawIndirectFirstInstance,
+        "GPU-driven draws need 'drawIndirectCount' and 'drawIndirectFirstInstance'!");
+    vonk::bindGeometryArena(cmd, mGeometry, positionsOnly);
+    vonk::drawInstances(cmd, mGeometry, mInstanceDraws, late);
+}
+void Vonk::setOcclusionCulling(bool enabled)
+{
+    mOcclusion = enabled;
+}
+void Vonk::refreshInstanceMeshes()
+{
+    // . Under 'mGeometryMutex', once per frame : one touch per distinct mesh keeps them resident, and the ones that
+    //   moved (evicted and restored) or went away are written again. Destroyed ones draw nothing
+    //   The restores queue uploads : 'drawFrame' flushes them after its recording, before its submit waits on them
+    auto      &draws  = mInstanceDraws;
+    bool const packed = mGeometry.format == VertexFormat_t::Packed;
+    for (uint32_t i = 0; i < draws.used.size(); ++i)
     {
-        meshID = meshCountID++;
+        auto const handle = draws.used[i];
+        auto const mesh   = mMeshes.contains(handle) ? vonk::drawMeshOf(touchMesh(handle), packed) : DrawMesh_t{};
+        if (std::memcmp(&mesh, &draws.written[i], sizeof(DrawMesh_t)) == 0)
+            continue;
+        draws.written[i] = mesh;
+        vonk::queueBufferUpdate(
+            mMeshUpdates, draws.meshes, VkDeviceSize{i} * sizeof(DrawMesh_t), {sizeof(DrawMesh_t), 1u, &draws.written[i]});
     }
+}
+
+//-------------------------------------
+
+void Vonk::updateMeshVertices(MeshHandle_t mesh, VkDeviceSize byteOffset, DataInfo_t di)
+{
+    // . Its CPU copy is stale from now on : it can't be evicted anymore
+    std::lock_guard lock{mGeometryMutex};
+    auto const      live = touchMesh(mesh);
+    vonk::pinResident(mResidency, live.resident);
+
+    VkDeviceSize const meshSize = VkDeviceSize{live.vertexCount} * mGeometry.stride;
+    AbortIfMsg(byteOffset + di.elemSize * di.count > meshSize, "Vertices update out of the mesh range!");
+    auto const meshOffset = static_cast<VkDeviceSize>(live.vertexOffset) * mGeometry.stride;
+    vonk::queueBufferUpdate(mMeshUpdates, mGeometry.vertices, meshOffset + byteOffset, di);
+}
+void Vonk::updateMeshPositions(MeshHandle_t mesh, VkDeviceSize byteOffset, DataInfo_t di)
+{
+    AbortIfMsg(!mGeometry.split, "Positions update on an interleaved geometry arena!");
+    std::lock_guard lock{mGeometryMutex};
+    auto const      live = touchMesh(mesh);
+    vonk::pinResident(mResidency, live.resident);
+
+    VkDeviceSize const meshSize = VkDeviceSize{live.vertexCount} * mGeometry.positionStride;
+    AbortIfMsg(byteOffset + di.elemSize * di.count > meshSize, "Positions update out of the mesh range!");
+    auto const meshOffset = static_cast<VkDeviceSize>(live.vertexOffset) * mGeometry.positionStride;
+    vonk::queueBufferUpdate(mMeshUpdates, mGeometry.positions, meshOffset + byteOffset, di);
+}
+void Vonk::updateMeshIndices(MeshHandle_t mesh, VkDeviceSize byteOffset, DataInfo_t di)
+{
+    std::lock_guard lock{mGeometryMutex};
+    auto const      live = touchMesh(mesh);
+    vonk::pinResident(mResidency, live.resident);
+
+    // . In the mesh's own index width : 'firstIndex' is in those units too
+    auto const         width    = vonk::indexSize(live.indexType);
+    VkDeviceSize const meshSize = VkDeviceSize{live.indexCount} * width;
+    AbortIfMsg(byteOffset + di.elemSize * di.count > meshSize, "Indices update out of the mesh range!");
+    auto const meshOffset = VkDeviceSize{live.firstIndex} * width;
+    vonk::queueBufferUpdate(mMeshUpdates, mGeometry.indices, meshOffset + byteOffset, di);
+}
+
+//-------------------------------------
+
+//=============================================================================
+
+// === TEXTUREs
+
+//-------------------------------------
+
+TextureHandle_t Vonk::createTexture(VkExtent2D extent, VkFormat format, std::vector<uint8_t> texels)
+{
+    // . Allocated and uploaded under 'mGeometryMutex', as the meshes : evicted on the heap its memory comes from
+    std::lock_guard lock{mGeometryMutex};
+    auto const      created = vonk::createTexture(mDevice, extent, format, GetDataInfo(texels));
+    auto const      heap    = vonk::allocationHeap(mAllocator, created.allocation);
+    auto const      bytes   = created.allocation.size;
+    auto const      handle  = mTextures.insert(created);
+
+    auto const evict = [this, handle]() {
+        mTextures.update(handle, [this](Texture_t &t) {
+            auto const resident = t.resident;
+            vonk::destroyTexture(mDevice, t);
+            t          = Texture_t{};
+            t.resident = resident;
+        });
+    };
+    auto restore = [this, handle, extent, format, texels = std::move(texels)]() {
+        auto const fresh = vonk::createTexture(mDevice, extent, format, GetDataInfo(texels));
+        mTextures.update(handle, [&fresh](Texture_t &t) {
+            auto const resident = t.resident;
+            t                   = fresh;
+            t.resident          = resident;
+        });
+    };
+    auto const resident = vonk::addResident(mResidency, heap, bytes, evict, std::move(restore));
+    mTextures.update(handle, [resident](Texture_t &t) { t.resident = resident; });
 
-    mMeshes[meshID] = vonk::createMesh(mDevice, indices, vertices);
-    return mMeshes[meshID];
+    return handle;
 }
 
 //-------------------------------------
 
-void Vonk::drawMesh(VkCommandBuffer cmd, Mesh_t const &mesh) { vonk::drawMesh(cmd, mesh); }
-void Vonk::drawMeshes(VkCommandBuffer cmd, std::vector<Mesh_t> const &meshes)
+void Vonk::destroyTexture(TextureHandle_t handle)
 {
-    for (auto const &mesh : meshes)
-        vonk::drawMesh(cmd, mesh);
+    // . Its descriptors must not be in any pending commands
+    std::lock_guard lock{mGeometryMutex};
+    Texture_t       texture;
+    if (!mTextures.erase(handle, &texture))
+        return;
+    vonk::removeResident(mResidency, texture.resident);
+    vonk::destroyTexture(mDevice, texture);
+}
+
+//-------------------------------------
+
+Texture_t Vonk::touchTexture(TextureHandle_t handle)
+{
+    std::lock_guard lock{mGeometryMutex};
+    auto const      texture = mTextures.get(handle);
+    AbortIfMsg(!texture.has_value(), "Stale texture handle!");
+
+    vonk::touchResident(mResidency, texture->resident);
+    return mTextures.get(handle).value();
 }
 
 //-------------------------------------
@@ -63,35 +542,44 @@ void Vonk::drawMeshes(VkCommandBuffer cmd, std::vector<Mesh_t> const &meshes)
 
 //-------------------------------------
 
-DrawShader_t const &
+DrawShaderHandle_t
 Vonk::createDrawShader(std::string const &keyName, std::string const &vertexName, std::string const &fragmentName)
 {
-    mDrawShaders[keyName] = vonk::createDrawShader(mDevice, vertexName, fragmentName, "", "", "");
-    return mDrawShaders[keyName];
+    // . A name given again points to the new one : the old stays alive for the pipelines using it
+    auto const      handle = mDrawShaders.insert(vonk::createDrawShader(mDevice, vertexName, fragmentName, "", "", ""));
+    std::lock_guard lock{mShaderNamesMutex};
+    mDrawShaderNames[keyName] = handle;
+    return handle;
 }
 
 //-------------------------------------
 
-DrawShader_t const &Vonk::getDrawShader(std::string const &keyName)
+DrawShaderHandle_t Vonk::getDrawShader(std::string const &keyName)
 {
-    AbortIfMsg(mDrawShaders.count(keyName) < 1, "Draw Shader Not Found!");
-    return mDrawShaders[keyName];
+    std::lock_guard lock{mShaderNamesMutex};
+    auto const      it = mDrawShaderNames.find(keyName);
+    AbortIfMsg(it == mDrawShaderNames.end(), "Draw Shader Not Found!");
+    return it->second;
 }
 
 //-------------------------------------
 
-Shader_t const &Vonk::createComputeShader(std::string const &name)
+ShaderHandle_t Vonk::createComputeShader(std::string const &name)
 {
-    mComputeShaders[name] = vonk::createShader(mDevice, name, VK_SHADER_STAGE_COMPUTE_BIT);
-    return mComputeShaders[name];
+    auto const      handle = mComputeShaders.insert(vonk::createShader(mDevice, name, VK_SHADER_STAGE_COMPUTE_BIT));
+    std::lock_guard lock{mShaderNamesMutex};
+    mComputeShaderNames[name] = handle;
+    return handle;
 }
 
 //-------------------------------------
 
-Shader_t const &Vonk::getComputeShader(std::string const &name)
+ShaderHandle_t Vonk::getComputeShader(std::string const &name)
 {
-    AbortIfMsg(mComputeShaders.count(name) < 1, "Compute Shader Not Found!");
-    return mComputeShaders[name];
+    std::lock_guard lock{mShaderNamesMutex};
+    auto const      it = mComputeShaderNames.find(name);
+    AbortIfMsg(it == mComputeShaderNames.end(), "Compute Shader Not Found!");
+    return it->second;
 }
 
 //-------------------------------------
@@ -102,18 +590,115 @@ Shader_t const &Vonk::getComputeShader(std::string const &name)
 
 //-------------------------------------
 
-void Vonk::addPipeline(DrawPipelineData_t const &ci)
+PipelineHandle_t Vonk::addPipeline(DrawPipelineData_t const &ci)
+{
+    AbortIfMsg(
+        ci.useMeshes && (ci.vertexFormat != mGeometry.format || ci.splitStreams != mGeometry.split),
+        "Pipeline vertex format doesn't match the geometry arena!");
+
+    // . Baked commands pin what they draw : geometry lock, so no other thread's touches get pinned meanwhile
+    std::lock_guard lock{mGeometryMutex};
+    PipelineEntry_t entry{.ci = ci};
+    buildPipeline(entry);
+    return mPipelines.insert(std::move(entry));
+}
+
+//-------------------------------------
+
+void Vonk::removePipeline(PipelineHandle_t handle)
+{
+    // . Its commands may still be in flight
+    vkDeviceWaitIdle(mDevice.handle);
+
+    PipelineEntry_t entry;
+    if (!mPipelines.erase(handle, &entry))
+        return;
+    auto &cb = entry.pipeline.commandBuffers;
+    unbindMeshes(cb);
+    if (cb.size() > 0)
+        vkFreeCommandBuffers(mDevice.handle, mDevice.cmdpool.graphics, GetCountU32(cb), GetData(cb));
+    vonk::destroyPipeline(mSwapChain, entry.pipeline);
+    mActivePipeline = 0u;
+}
+
+//-------------------------------------
+
+void Vonk::bindPipeline(VkCommandBuffer cmd, PipelineHandle_t handle)
+{
+    bool const found = mPipelines.read(handle, [cmd](PipelineEntry_t const &entry) {
+        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, entry.pipeline.handle);
+    });
+    AbortIfMsg(!found, "Stale pipeline handle!");
+}
+
+//-------------------------------------
+
+void Vonk::buildPipeline(PipelineEntry_t &entry)
 {
-    mPipelinesCI.push_back(ci);
-    mPipelines.push_back(vonk::createPipeline(
-        {},
-        mPipelinesCI.back(),
+    // . Under 'mGeometryMutex' : 'pinning' is residency state
+    // . The draw shader is looked up each time : 'pDrawShader' only lives for the call
+    auto const  shader = mDrawShaders.get(entry.ci.drawShader);
+    auto const *given  = entry.ci.pDrawShader;
+    AbortIfMsg(!shader.has_value() && !given, "Stale draw shader handle!");
+    if (shader.has_value())
+        entry.ci.pDrawShader = &shader.value();
+
+    // . Baked commands are replayed every frame : what they draw has to stay resident
+    //   Per-frame ones are only recorded by 'drawFrame', their draws touch the meshes as usual
+    //   Render graph ones have no commands : any compatible render pass will do, the one of the latest compile
+    auto renderPass = mSwapChain.defaultRenderPass;
+    if (entry.ci.graphPass != UINT32_MAX)
+    {
+        renderPass = graphRenderPass(entry.ci.graphPass);
+        AbortIfMsg(!renderPass, "Pipeline for a render graph pass without attachments!");
+    }
+    mResidency.pinning = !entry.ci.recordPerFrame;
+    entry.pipeline     = vonk::createPipeline(
+        entry.pipeline,
+        entry.ci,
         mSwapChain,
         mDevice.handle,
         mDevice.cmdpool.graphics,
-        mSwapChain.defaultRenderPass,
-        mSwapChain.defaultFrameBuffers));
-};
+        renderPass,
+        mSwapChain.defaultFrameBuffers);
+    mResidency.pinning   = false;
+    entry.ci.pDrawShader = given;
+}
+
+//-------------------------------------
+
+//=============================================================================
+
+// === RENDER GRAPH
+
+//-------------------------------------
+
+void Vonk::setRenderGraph(RenderGraph_t graph)
+{
+    // . The previous one may still be in flight
+    vkDeviceWaitIdle(mDevice.handle);
+
+    // . Its memory comes from the allocator : geometry lock, as every other allocation
+    std::lock_guard lock{mGeometryMutex};
+    vonk::destroyRenderGraph(mDevice, mRenderGraph);
+    mRenderGraph = std::move(graph);
+    vonk::compileRenderGraph(mDevice, mSwapChain, mRenderGraph);
+    vonk::logRenderGraph(mRenderGraph);
+}
+
+//-------------------------------------
+
+VkRenderPass Vonk::graphRenderPass(uint32_t pass) const
+{
+    return pass < mRenderGraph.passes.size() ? mRenderGraph.passes[pass].renderPass : VK_NULL_HANDLE;
+}
+
+//-------------------------------------
+
+VkImageView Vonk::graphImageView(GraphImage_t image) const
+{
+    return image < mRenderGraph.states.size() ? mRenderGraph.states[image].view : VK_NULL_HANDLE;
+}
 
 //-------------------------------------
 
@@ -124,18 +709,33 @@ void Vonk::addPipeline(DrawPipelineData_t const &ci)
 //-------------------------------------
 
 void Vonk::waitDevice() { vkDeviceWaitIdle(mDevice.handle); }
+void Vonk::waitUploads() { vonk::waitAllUploads(mUploader); }
 
 //-------------------------------------
 
 void Vonk::drawFrame()
 {
-    if (mPipelines.empty())
+    if (mPipelines.size() < 1 && mRenderGraph.order.empty())
+    {
+        // . Nothing to draw : the uploads still go out and get released
+        std::lock_guard lock{mGeometryMutex};
+        vonk::flushUploads(mUploader);
+        vonk::pollUploads(mUploader);
         return;
+    }
 
-    static size_t currFrame = 0;
+    auto const currFrame = mCurrFrame;
 
     // ::: Preconditions
     vkWaitForFences(mDevice.handle, 1, &mSwapChain.fences.submit[currFrame], VK_TRUE, UINT64_MAX);
+    // . Its last submit is done : every command buffer of the frame is free to be recorded again, its stats read
+    auto &frame = mFrameCommands[currFrame];
+    vonk::resetFrameCommands(mDevice, frame);
+    VkCommandBuffer const primaries[] = {frame.update, frame.draw, frame.late};
+    unbindMeshes(primaries);
+    for (auto const &buffers : frame.workerBuffers)
+        unbindMeshes(buffers);
+    mInstanceStats = vonk::readInstanceStats(mInstanceDraws, currFrame);
 
     // ::: 1. Get next image to process
     // 1.1 : Acquiere next image
@@ -166,22 +766,122 @@ void Vonk::drawFrame()
     mSwapChain.fences.acquire[imageIndex]         = mSwapChain.fences.submit[currFrame];
 
     // ::: 2. Draw ( Graphics Queue )
-    // 2.1 : Sync objects
-    VkPipelineStageFlags const waitStages[]       = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
-    VkSemaphore const          waitSemaphores[]   = {mSwapChain.semaphores.present[currFrame]};
+    // 2.0 : Partial buffer updates queued since the last frame and the cluster / instance culling, ahead of the draws
+    std::vector<VkCommandBuffer> commandBuffers;
+    commandBuffers.reserve(3);
+    VkCommandBufferBeginInfo const beginInfo{
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+    };
+    // . Occlusion : tested against the depth the swapchain's render pass left on the last frame, when it drew
+    std::optional<PipelineEntry_t> active;
+    if (mRenderGraph.order.empty())
+        active = mPipelines.get(mPipelines.handleAt(mActivePipeline % mPipelines.size())).value();
+    bool const swapchainPass = active.has_value() && active->ci.graphPass == UINT32_MAX;
+    bool const occlusion     = mOcclusion && mOcclusionPrimed && swapchainPass && active->ci.lateCommands;
+    auto const depth         = mSwapChain.defaultDepthTexture.image;
+    auto       instanceCull  = vonk::instanceCull(mCullViewProj, mLodEye, mLodPixelsPerUnit, mLodMaxPixels);
+    bool       occluding     = false;
+    // . Cluster culling : only for what draws clusters this frame
+    bool clusters = active.has_value() && active->ci.clusterCulling;
+    if (!active.has_value())
+        mPipelines.forEach([&clusters](auto, PipelineEntry_t const &entry) {
+            clusters = clusters || (entry.ci.graphPass != UINT32_MAX && entry.ci.clusterCulling);
+        });
+    {
+        std::lock_guard lock{mGeometryMutex};
+        refreshInstanceMeshes();
+        occluding = occlusion && mInstanceDraws.instanceCount > 0;
+        VkCheck(vkBeginCommandBuffer(frame.update, &beginInfo));
+        bool const updated  = vonk::recordBufferUpdates(mDevice, mMeshUpdates, mStagingRing, frame.update);
+        bool const culled   = clusters && vonk::recordClusterCull(frame.update, mClusterCullPipeline, mGeometry, mClusterCull);
+        bool const prepared = vonk::prepareDepthPyramid(frame.update, mDepthPyramid);
+        if (occluding)
+            vonk::recordDepthPyramid(frame.update, mDepthPyramidPipeline, mDepthPyramid, depth);
+        bool const instanced = vonk::recordInstanceCull(
+            frame.update, mInstanceCullPipeline, mInstanceDraws, instanceCull, occluding ? &mDepthPyramid : nullptr);
+        if (instanced && !occluding)
+            vonk::recordInstanceStats(frame.update, mInstanceDraws, currFrame);
+        VkCheck(vkEndCommandBuffer(frame.update));
+        if (updated || culled || prepared || instanced)
+            commandBuffers.push_back(frame.update);
+    }
+    // 2.1 : The render graph's passes when there is one, else the active pipeline : its baked commands, or this
+    //       frame's ones. Recorded from a copy, no lock held : the split passes draw meshes from the worker threads
+    if (!active.has_value())
+    {
+        VkCheck(vkBeginCommandBuffer(frame.draw, &beginInfo));
+        vonk::recordRenderGraph(frame.draw, mRenderGraph, mSwapChain, imageIndex);
+        VkCheck(vkEndCommandBuffer(frame.draw));
+        commandBuffers.push_back(frame.draw);
+    }
+    else if (active->pipeline.recordPerFrame)
+    {
+        VkCheck(vkBeginCommandBuffer(frame.draw, &beginInfo));
+        vonk::recordPipelineCommands(
+            frame.draw, active->pipeline, active->ci, mSwapChain, mSwapChain.defaultFrameBuffers[imageIndex], &frame);
+        VkCheck(vkEndCommandBuffer(frame.draw));
+        commandBuffers.push_back(frame.draw);
+    }
+    else
+    {
+        commandBuffers.push_back(active->pipeline.commandBuffers[imageIndex]);
+    }
+    // 2.2 : Second occlusion phase, on the depth just drawn : the instances the first one rejected are tested again,
+    //       and the ones that show up drawn over it by the pipeline's 'lateCommands'
+    if (occluding)
+    {
+        VkCheck(vkBeginCommandBuffer(frame.late, &beginInfo));
+        {
+            std::lock_guard lock{mGeometryMutex};
+            instanceCull.phase = 1u;
+            vonk::recordDepthPyramid(frame.late, mDepthPyramidPipeline, mDepthPyramid, depth);
+            vonk::recordInstanceCull(frame.late, mInstanceCullPipeline, mInstanceDraws, instanceCull, &mDepthPyramid);
+            vonk::recordInstanceStats(frame.late, mInstanceDraws, currFrame);
+        }
+        vonk::recordLateCommands(
+            frame.late, active->pipeline, active->ci, mSwapChain, mLateRenderPass, mSwapChain.defaultFrameBuffers[imageIndex]);
+        VkCheck(vkEndCommandBuffer(frame.late));
+        commandBuffers.push_back(frame.late);
+    }
+    mOcclusionPrimed = swapchainPass;
+
+    // ::: Uploads : send the pending copies, the ones the recording above queued too (meshes restored when touched),
+    //     and release the finished ones. After every touch of the frame : its submit waits on the latest ticket
+    uint64_t uploaded = 0u;
+    {
+        std::lock_guard lock{mGeometryMutex};
+        vonk::flushUploads(mUploader);
+        vonk::pollUploads(mUploader);
+        uploaded = mUploader.submittedTicket;
+    }
+
+    // 2.3 : Sync objects ( Also waits for the uploads on the timeline, binary semaphores ignore their value )
+    //       The uploads are geometry and textures : read from the vertex input on, the culling's compute included
+    VkPipelineStageFlags const uploadStages       = VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT
+                                                  | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+    VkPipelineStageFlags const waitStages[]       = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, uploadStages};
+    VkSemaphore const          waitSemaphores[]   = {mSwapChain.semaphores.present[currFrame], mUploader.timeline};
+    uint64_t const             waitValues[]       = {0u, uploaded};
     VkSemaphore const          signalSemaphores[] = {mSwapChain.semaphores.render[currFrame]};
-    // 2.2 : Submit info
-    VkSubmitInfo const         submitInfo{
-                .sType                = VK_STRUCTURE_TYPE_SUBMIT_INFO,
-                .pWaitDstStageMask    = waitStages,
-                .commandBufferCount   = 1,
-                .pCommandBuffers      = &mPipelines[mActivePipeline].commandBuffers[imageIndex],
-                .waitSemaphoreCount   = 1,
-                .pWaitSemaphores      = waitSemaphores,
-                .signalSemaphoreCount = 1,
-                .pSignalSemaphores    = signalSemaphores,
+    // 2.4 : Submit info
+    VkTimelineSemaphoreSubmitInfo const timelineSI{
+        .sType                   = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO,
+        .waitSemaphoreValueCount = 2,
+        .pWaitSemaphoreValues    = waitValues,
     };
-    // 2.3 : Reset fences right before asking for draw
+    VkSubmitInfo const submitInfo{
+        .sType                = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        .pNext                = &timelineSI,
+        .pWaitDstStageMask    = waitStages,
+        .commandBufferCount   = GetCountU32(commandBuffers),
+        .pCommandBuffers      = GetData(commandBuffers),
+        .waitSemaphoreCount   = 2,
+        .pWaitSemaphores      = waitSemaphores,
+        .signalSemaphoreCount = 1,
+        .pSignalSemaphores    = signalSemaphores,
+    };
+    // 2.5 : Reset fences right before asking for draw
     vkResetFences(mDevice.handle, 1, &mSwapChain.fences.submit[currFrame]);
     VkCheck(vkQueueSubmit(mDevice.queue.graphics, 1, &submitInfo, mSwapChain.fences.submit[currFrame]));
 
@@ -211,7 +911,21 @@ void Vonk::drawFrame()
     }
 
     // ::: Extra tasks
-    currFrame = (currFrame + 1) % sInFlightMaxFrames;
+    // . Next frame : its staging region is free once its last submit is done
+    mCurrFrame = (currFrame + 1) % sInFlightMaxFrames;
+    vkWaitForFences(mDevice.handle, 1, &mSwapChain.fences.submit[mCurrFrame], VK_TRUE, UINT64_MAX);
+    std::lock_guard lock{mGeometryMutex};
+    vonk::beginStagingFrame(mStagingRing, mCurrFrame, mUploader);
+    // . Residency : evict cold resources when a heap gets close to its budget
+    vonk::updateResidency(mResidency, vonk::getMemoryBudget(mAllocator));
+}
+
+//-------------------------------------
+
+StagingSlice_t Vonk::allocateTransient(VkDeviceSize size)
+{
+    std::lock_guard lock{mGeometryMutex};
+    return vonk::allocateStaging(mStagingRing, size);
 }
 
 //-------------------------------------
@@ -224,10 +938,12 @@ void Vonk::drawFrame()
 
 void Vonk::destroySwapChainDependencies()
 {
-    for (auto &pipeline : mPipelines)
-    {
+    // . Geometry first, as everywhere else : the freed command buffers forget their bound meshes
+    std::lock_guard lock{mGeometryMutex};
+    mPipelines.forEach([this](PipelineHandle_t, PipelineEntry_t const &entry) {
         // . Command Buffers
-        auto &cb = pipeline.commandBuffers;
+        auto const &cb = entry.pipeline.commandBuffers;
+        unbindMeshes(cb);
         if (cb.size() > 0)
         {
             vkFreeCommandBuffers(mDevice.handle, mDevice.cmdpool.graphics, GetCountU32(cb), GetData(cb));
@@ -239,7 +955,7 @@ void Vonk::destroySwapChainDependencies()
         //     vkDestroyFramebuffer(mDevice.handle, pipeline.frameBuffers[i], nullptr);
         //   }
         // }
-    }
+    });
 }
 
 //-------------------------------------
@@ -251,18 +967,29 @@ void Vonk::recreateSwapChain()
     destroySwapChainDependencies();
     mSwapChain = vonk::createSwapChain(mDevice, mSwapChain);
 
-    for (size_t i = 0; i < mPipelines.size(); ++i)
-    {
-        // vonk::createPipeline(mDevice, mPipelines[i], currSwapChainExtent2D, [renderpass], [framebuffer]);
-        vonk::createPipeline(
-            mPipelines[i],
-            mPipelinesCI[i],
-            mSwapChain,
-            mDevice.handle,
-            mDevice.cmdpool.graphics,
-            mSwapChain.defaultRenderPass,
-            mSwapChain.defaultFrameBuffers);
-    }
+    // . Their commands record mesh draws : geometry first, as everywhere else
+    //   The render graph before the pipelines : sized on the swapchain, and their render passes come from it
+    std::lock_guard lock{mGeometryMutex};
+    if (!mRenderGraph.passes.empty())
+        vonk::compileRenderGraph(mDevice, mSwapChain, mRenderGraph);
+    mPipelines.forEachMut([this](PipelineHandle_t, PipelineEntry_t &entry) { buildPipeline(entry); });
+    // . The depth pyramid reads the new depth attachment, and there is no depth to test against until a frame draws
+    vonk::destroyDepthPyramid(mDevice, mDepthPyramid);
+    createDepthPyramid();
+    mOcclusionPrimed = false;
+}
+
+//-------------------------------------
+
+void Vonk::createDepthPyramid()
+{
+    mDepthPyramid = vonk::createDepthPyramid(mDevice, mSwapChain, mDepthPyramidPipeline);
+    vonk::bindComputeImage(
+        mDevice,
+        mInstanceCullPipeline.set,
+        5u,
+        VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+        {mDepthPyramid.sampler, mDepthPyramid.view, VK_IMAGE_LAYOUT_GENERAL});
 }
 
 //-------------------------------------
@@ -283,39 +1010,128 @@ void Vonk::init()
     mGpu       = vonk::pickGpu(mInstance, true, true, true, true);
     // . Create Device (aka: gpu-manager / logical-device)
     mDevice    = vonk::createDevice(mInstance, mGpu);
+    // . Create Allocator (aka: device-memory sub-allocator, used by buffers and textures)
+    mAllocator         = vonk::createAllocator(mDevice);
+    mDevice.pAllocator = &mAllocator;
+    // . Create Uploader (aka: batched host->device copies on the transfer queue)
+    mUploader          = vonk::createUploader(mDevice);
+    mDevice.pUploader  = &mUploader;
+    // . Create Residency (aka: LRU eviction of the evictable resources when close to the memory budget)
+    mResidency         = vonk::createResidency(sInFlightMaxFrames);
+    mAllocator.reclaim = [this](uint32_t heap, VkDeviceSize bytes) {
+        return vonk::evictResidents(mResidency, heap, bytes);
+    };
     // . Create SwapChain
     mSwapChain = vonk::createSwapChain(mDevice, mSwapChain);
+    // . Create Staging Ring (aka: per-frame transient host memory, also used by the uploader)
+    mStagingRing           = vonk::createStagingRing(mDevice, sStagingBytesPerFrame, mSwapChain.sInFlightMaxFrames);
+    mUploader.pStagingRing = &mStagingRing;
+    // . Create Geometry Arena (aka: the vertex/index buffers shared by all the meshes)
+    mGeometry  = vonk::createGeometryArena(
+        mDevice, sGeometryMaxVertices, sGeometryMaxIndices, sVertexFormat, sSplitStreams);
+    // . Create Cluster Culling (aka: per-meshlet frustum / cone tests, writing the arena's indirect draws)
+    //   Until a camera is given, everything inside the clip volume : the meshes are drawn as is
+    auto const cullShader = mComputeShaders.get(createComputeShader("cluster_cull")).value();
+    mClusterCullPipeline  = vonk::createComputePipeline(mDevice, cullShader, 2u, sizeof(ClusterCull_t));
+    vonk::bindComputeBuffers(mDevice, mClusterCullPipeline, {&mGeometry.meshlets, &mGeometry.draws});
+    mClusterCull = vonk::clusterCull(glm::mat4(1.f), glm::vec3(0.f), false);
+    // . Create Instance Culling (aka: GPU-driven draws, the instances culled into compacted indirect draws)
+    //   The depth pyramid of its occlusion tests is bound after the buffers, and again with the swapchain
+    auto const sampled        = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    auto const instanceShader = mComputeShaders.get(createComputeShader("instance_cull")).value();
+    mInstanceCullPipeline     = vonk::createComputePipeline(mDevice, instanceShader, 5u, sizeof(InstanceCull_t), {sampled});
+    mInstanceDraws            = vonk::createInstanceDraws(mDevice, sMaxDrawInstances, sMaxInstanceMeshes, sInFlightMaxFrames);
+    vonk::bindComputeBuffers(
+        mDevice,
+        mInstanceCullPipeline,
+        {&mInstanceDraws.meshes, &mInstanceDraws.instances, &mInstanceDraws.draws, &mInstanceDraws.counts, &mInstanceDraws.retest});
+    // . Create Depth Pyramid (aka: the depth attachment reduced to its farthest depths, for the occlusion tests)
+    //   plus the render pass drawing over the swapchain's, for what the second test lets through
+    auto const pyramidShader = mComputeShaders.get(createComputeShader("depth_pyramid")).value();
+    mDepthPyramidPipeline    = vonk::createComputePipeline(
+        mDevice, pyramidShader, 0u, 4u * sizeof(int32_t), {sampled, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE});
+    createDepthPyramid();
+    mLateRenderPass = vonk::createLoadRenderPass(mDevice.handle, mSwapChain.colorFormat, mSwapChain.depthFormat);
+    // . Per-frame command pools (aka: partial buffer updates, culling and the pipelines recorded every frame)
+    //   plus a pool per recording thread for the split passes
+    auto const recordingThreads = std::min(std::max(std::thread::hardware_concurrency(), 1u), sMaxRecordingThreads);
+    mFrameCommands.resize(sInFlightMaxFrames);
+    for (auto &frame : mFrameCommands)
+    {
+        frame = vonk::createFrameCommands(mDevice, recordingThreads);
+    }
 }
 
 //-------------------------------------
 
 void Vonk::cleanup()
 {
+    // . Memory in use, per category, before tearing everything down
+    vonk::logMemoryReport(mAllocator);
+
     // . Pipelines
-    for (auto &pipeline : mPipelines)
+    for (auto const &entry : mPipelines.clear())
+    {
+        vonk::destroyPipeline(mSwapChain, entry.pipeline);
+    }
+    vonk::destroyRenderGraph(mDevice, mRenderGraph);
+
+    vonk::destroyComputePipeline(mDevice, mClusterCullPipeline);
+    vonk::destroyComputePipeline(mDevice, mInstanceCullPipeline);
+    vonk::destroyInstanceDraws(mDevice, mInstanceDraws);
+    vonk::destroyDepthPyramid(mDevice, mDepthPyramid);
+    vonk::destroyComputePipeline(mDevice, mDepthPyramidPipeline);
+    vkDestroyRenderPass(mDevice.handle, mLateRenderPass, nullptr);
+
+    // . Per-frame command pools
+    for (auto &frame : mFrameCommands)
     {
-        vonk::destroyPipeline(mSwapChain, pipeline);
+        vonk::destroyFrameCommands(mDevice, frame);
     }
+    mFrameCommands.clear();
 
-    // . Meshes
-    for (auto &[k, m] : mMeshes)
+    // . Uploads
+    vonk::logUploadStats(mUploader);
+    vonk::destroyUploader(mUploader);
+    vonk::destroyBufferUpdates(mDevice, mMeshUpdates);
+    vonk::destroyStagingRing(mDevice, mStagingRing);
+
+    // . Meshes and textures
+    vonk::logResidency(mResidency, vonk::getMemoryBudget(mAllocator));
+    for (auto &m : mMeshes.clear())
     {
-        mRemovedMeshes.push(k);
-        vonk::destroyMesh(mDevice, m);
+        vonk::removeResident(mResidency, m.resident);
+        vonk::destroyMesh(mGeometry, m);
     }
+    for (auto &t : mTextures.clear())
+    {
+        vonk::removeResident(mResidency, t.resident);
+        vonk::destroyTexture(mDevice, t);
+    }
+    vonk::destroyResidency(mResidency);
+    mAllocator.reclaim = nullptr;
+    vonk::destroyGeometryArena(mDevice, mGeometry);
 
     // . Shaders
-    for (auto const &[k, ds] : mDrawShaders)
+    for (auto const &ds : mDrawShaders.clear())
     {
         vonk::destroyDrawShader(mDevice, ds);
     }
-    for (auto const &[k, cs] : mComputeShaders)
+    for (auto const &cs : mComputeShaders.clear())
     {
         vkDestroyShaderModule(mDevice.handle, cs.module, nullptr);
     }
+    mDrawShaderNames.clear();
+    mComputeShaderNames.clear();
 
     // . Context ¿?
     vonk::destroySwapChain(mSwapChain, false);
+    vonk::logAllocatorStats(mAllocator);
+    if (auto const leaks = vonk::logMemoryLeaks(mAllocator); leaks > 0)
+    {
+        LogWarnf("{} allocations still alive at shutdown", leaks);
+    }
+    vonk::destroyAllocator(mAllocator);
     vonk::destroyDevice(mDevice);
     vonk::destroyInstance(mInstance);
 }
@@ -0,0 +1,569 @@
+#include "VonkAllocator.h"
+#include "VonkToStr.h"
+#include "VonkTools.h"
+
+#include <algorithm>
+#include <bit>
+#include <optional>
+
+namespace vonk
+{ //
+
+//=============================================================================
+
+// === HELPERs
+
+//-------------------------------------
+
+namespace
+{
+uint32_t orderOf(VkDeviceSize nodeSize) { return std::countr_zero(nodeSize / Allocator_t::sMinNodeSize); }
+
+//---
+
+VkDeviceSize nodeSizeFor(VkMemoryRequirements const &reqs)
+{
+    // Buddy nodes are aligned to their own size, so a node as big as the alignment is also aligned to it
+    return std::bit_ceil(std::max({reqs.size, reqs.alignment, Allocator_t::sMinNodeSize}));
+}
+
+//---
+
+VkDeviceSize poolBlockSize(Allocator_t const &allocator, uint32_t memoryType)
+{
+    // Don't let a single block eat a small heap (i.e. the 256MB host-visible+device-local one)
+    auto const &memProps = allocator.pDevice->pGpu->memory;
+    auto const  heapSize = memProps.memoryHeaps[memProps.memoryTypes[memoryType].heapIndex].size;
+    return std::max(Allocator_t::sMinNodeSize, std::min(allocator.blockSize, std::bit_floor(heapSize / 8)));
+}
+
+//---
+
+uint32_t heapOf(Allocator_t const &allocator, uint32_t memoryType)
+{
+    return allocator.pDevice->pGpu->memory.memoryTypes[memoryType].heapIndex;
+}
+
+//---
+
+VkDeviceMemory allocateRaw(
+    Allocator_t                         &allocator,
+    VkDeviceSize                         size,
+    uint32_t                             memoryType,
+    VkMemoryDedicatedAllocateInfo const *pDedicatedInfo,
+    void                               **ppMapped)
+{
+    auto const &device = *allocator.pDevice;
+    auto const &gpu    = *device.pGpu;
+    auto const  heap   = heapOf(allocator, memoryType);
+
+    AbortIfMsg(
+        allocator.liveAllocations >= gpu.properties.limits.maxMemoryAllocationCount,
+        "Reached 'maxMemoryAllocationCount'");
+
+    // . Over budget : make room first, the driver would start paging (or failing) otherwise
+    if (allocator.reclaim)
+    {
+        auto const budget = getMemoryBudget(allocator);
+        if (budget.usage[heap] + size > budget.budget[heap])
+            allocator.reclaim(heap, budget.usage[heap] + size - budget.budget[heap]);
+    }
+
+    VkMemoryAllocateInfo const memAlloc{
+        .sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+        .pNext           = pDedicatedInfo,
+        .allocationSize  = size,
+        .memoryTypeIndex = memoryType,
+    };
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    auto           ret    = vkAllocateMemory(device.handle, &memAlloc, nullptr, &memory);
+
+    // . Out of memory : evict what can be evicted and try once more
+    bool const outOfMemory = ret == VK_ERROR_OUT_OF_DEVICE_MEMORY || ret == VK_ERROR_OUT_OF_HOST_MEMORY;
+    if (outOfMemory && allocator.reclaim && allocator.reclaim(heap, size) > 0)
+        ret = vkAllocateMemory(device.handle, &memAlloc, nullptr, &memory);
+    AbortIfMsgf(ret != VK_SUCCESS, "Failed to allocate {}KB on heap {} ({})", size / 1024, heap, ret);
+
+    ++allocator.liveAllocations;
+    allocator.heapUsage[heap] += size;
+
+    // . Host-visible memory stays mapped for its whole life
+    *ppMapped = nullptr;
+    if (gpu.memory.memoryTypes[memoryType].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+    {
+        VkCheck(vkMapMemory(device.handle, memory, 0, VK_WHOLE_SIZE, 0, ppMapped));
+    }
+
+    return memory;
+}
+
+//---
+
+std::optional<VkDeviceSize> takeNode(MemoryBlock_t &block, uint32_t order)
+{
+    // . Smallest free node that fits
+    uint32_t curr = order;
+    while (curr < block.freeNodes.size() && block.freeNodes[curr].empty())
+        ++curr;
+    if (curr >= block.freeNodes.size())
+        return std::nullopt;
+
+    auto const offset = *block.freeNodes[curr].begin();
+    block.freeNodes[curr].erase(block.freeNodes[curr].begin());
+
+    // . Split it until it matches the requested order, keeping the right halves as free
+    while (curr > order)
+    {
+        --curr;
+        block.freeNodes[curr].insert(offset + (Allocator_t::sMinNodeSize << curr));
+    }
+
+    block.used += Allocator_t::sMinNodeSize << order;
+    return offset;
+}
+
+//---
+
+void releaseNode(MemoryBlock_t &block, VkDeviceSize offset, uint32_t order)
+{
+    block.used -= Allocator_t::sMinNodeSize << order;
+
+    // . Merge with the buddy while it is also free
+    auto const maxOrder = static_cast<uint32_t>(block.freeNodes.size() - 1);
+    while (order < maxOrder)
+    {
+        auto const buddy = offset ^ (Allocator_t::sMinNodeSize << order);
+        if (block.freeNodes[order].erase(buddy) < 1)
+            break;
+        offset = std::min(offset, buddy);
+        ++order;
+    }
+    block.freeNodes[order].insert(offset);
+}
+
+//---
+
+Allocation_t allocate(
+    Allocator_t                         &allocator,
+    VkMemoryRequirements const          &reqs,
+    VkMemoryPropertyFlags                properties,
+    VkMemoryPropertyFlags                preferred,
+    bool                                 optimalTiling,
+    bool                                 prefersDedicated,
+    VkMemoryDedicatedAllocateInfo const &dedicatedInfo)
+{
+    auto const &memProps   = allocator.pDevice->pGpu->memory;
+    auto const  preferType = vonk::findMemoryType(memProps, reqs.memoryTypeBits, properties | preferred);
+    auto const  memoryType = preferType.has_value() ? preferType.value()
+                                                    : vonk::getMemoryType(memProps, reqs.memoryTypeBits, properties);
+    auto const blockSize  = poolBlockSize(allocator, memoryType);
+    auto const nodeSize   = nodeSizeFor(reqs);
+
+    Allocation_t allocation;
+    allocation.pool = memoryType * 2 + optimalTiling;
+
+    // . Dedicated
+    if (prefersDedicated || nodeSize > blockSize / 2)
+    {
+        allocation.size   = reqs.size;
+        allocation.memory = allocateRaw(allocator, reqs.size, memoryType, &dedicatedInfo, &allocation.pMapped);
+        ++allocator.dedicatedCount;
+        allocator.dedicatedBytes += reqs.size;
+        return allocation;
+    }
+
+    // . Sub-allocated : first block with room, otherwise a new one (reusing released slots)
+    auto          &pool  = allocator.pools[allocation.pool];
+    auto const     order = orderOf(nodeSize);
+    MemoryBlock_t *pEmptySlot = nullptr;
+
+    for (uint32_t i = 0; i < pool.size(); ++i)
+    {
+        auto &block = pool[i];
+        if (!block.memory)
+        {
+            pEmptySlot = pEmptySlot ? pEmptySlot : &block;
+            continue;
+        }
+        if (auto const offset = takeNode(block, order); offset.has_value())
+        {
+            allocation.block  = i;
+            allocation.offset = offset.value();
+            break;
+        }
+    }
+
+    if (allocation.block == UINT32_MAX)
+    {
+        auto &block = pEmptySlot ? *pEmptySlot : pool.emplace_back();
+        block.size  = blockSize;
+        block.used  = 0u;
+        block.freeNodes.assign(orderOf(blockSize) + 1, {});
+        block.freeNodes.back().insert(0u);
+        block.memory = allocateRaw(allocator, blockSize, memoryType, nullptr, &block.pMapped);
+
+        allocation.block  = static_cast<uint32_t>(&block - pool.data());
+        allocation.offset = takeNode(block, order).value();
+    }
+
+    auto const &block  = pool[allocation.block];
+    allocation.memory  = block.memory;
+    allocation.size    = nodeSize;
+    allocation.pMapped = block.pMapped ? static_cast<char *>(block.pMapped) + allocation.offset : nullptr;
+    return allocation;
+}
+
+//---
+
+void track(Allocator_t &allocator, Allocation_t &allocation, MemoryCategory_t category)
+{
+    allocation.category = category;
+    allocation.id       = allocator.nextId++;
+    allocator.tracked.emplace(allocation.id, allocation);
+}
+} // namespace
+
+//-------------------------------------
+
+//=============================================================================
+
+// === ALLOCATOR
+
+//-------------------------------------
+
+Allocator_t createAllocator(Device_t const &device, VkDeviceSize blockSize)
+{
+    Assert(device.pGpu);
+
+    Allocator_t allocator;
+    allocator.blockSize = std::bit_floor(std::max(blockSize, Allocator_t::sMinNodeSize));
+    allocator.pDevice   = &device;
+    return allocator;
+}
+
+//-------------------------------------
+
+void destroyAllocator(Allocator_t &allocator)
+{
+    auto const stats = getAllocatorStats(allocator);
+    if (stats.bytesInUse > 0)
+    {
+        LogWarnf("Destroying the allocator with {} bytes still in use", stats.bytesInUse);
+    }
+
+    for (auto &pool : allocator.pools)
+    {
+        for (auto &block : pool)
+        {
+            if (block.memory)
+                vkFreeMemory(allocator.pDevice->handle, block.memory, nullptr);
+        }
+    }
+
+    allocator = Allocator_t{};
+}
+
+//-------------------------------------
+
+Allocation_t allocateBufferMemory(
+    Allocator_t          &allocator,
+    VkBuffer              buffer,
+    MemoryCategory_t      category,
+    VkMemoryPropertyFlags properties,
+    VkMemoryPropertyFlags preferred)
+{
+    auto const device = allocator.pDevice->handle;
+
+    VkMemoryDedicatedRequirements dedicatedReqs{
+        .sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_REQUIREMENTS,
+    };
+    VkMemoryRequirements2 memReqs{
+        .sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2,
+        .pNext = &dedicatedReqs,
+    };
+    VkBufferMemoryRequirementsInfo2 const memReqsInfo{
+        .sType  = VK_STRUCTURE_TYPE_BUFFER_MEMORY_REQUIREMENTS_INFO_2,
+        .buffer = buffer,
+    };
+    vkGetBufferMemoryRequirements2(device, &memReqsInfo, &memReqs);
+
+    VkMemoryDedicatedAllocateInfo const dedicatedInfo{
+        .sType  = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO,
+        .buffer = buffer,
+    };
+    bool const prefersDedicated = dedicatedReqs.prefersDedicatedAllocation || dedicatedReqs.requiresDedicatedAllocation;
+
+    auto const &reqs       = memReqs.memoryRequirements;
+    auto        allocation = allocate(allocator, reqs, properties, preferred, false, prefersDedicated, dedicatedInfo);
+    VkCheck(vkBindBufferMemory(device, buffer, allocation.memory, allocation.offset));
+    track(allocator, allocation, category);
+    return allocation;
+}
+
+//-------------------------------------
+
+Allocation_t allocateImageMemory(
+    Allocator_t          &allocator,
+    VkImage               image,
+    MemoryCategory_t      category,
+    VkMemoryPropertyFlags properties,
+    VkMemoryPropertyFlags preferred)
+{
+    auto const device = allocator.pDevice->handle;
+
+    VkMemoryDedicatedRequirements dedicatedReqs{
+        .sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_REQUIREMENTS,
+    };
+    VkMemoryRequirements2 memReqs{
+        .sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2,
+        .pNext = &dedicatedReqs,
+    };
+    VkImageMemoryRequirementsInfo2 const memReqsInfo{
+        .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_REQUIREMENTS_INFO_2,
+        .image = image,
+    };
+    vkGetImageMemoryRequirements2(device, &memReqsInfo, &memReqs);
+
+    VkMemoryDedicatedAllocateInfo const dedicatedInfo{
+        .sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO,
+        .image = image,
+    };
+    bool const prefersDedicated = dedicatedReqs.prefersDedicatedAllocation || dedicatedReqs.requiresDedicatedAllocation;
+
+    auto const &reqs       = memReqs.memoryRequirements;
+    auto        allocation = allocate(allocator, reqs, properties, preferred, true, prefersDedicated, dedicatedInfo);
+    VkCheck(vkBindImageMemory(device, image, allocation.memory, allocation.offset));
+    track(allocator, allocation, category);
+    return allocation;
+}
+
+//-------------------------------------
+
+Allocation_t allocateAliasedMemory(
+    Allocator_t                &allocator,
+    VkMemoryRequirements const &reqs,
+    MemoryCategory_t            category,
+    VkMemoryPropertyFlags       properties)
+{
+    // . No single resource to dedicate it to : big ones still get their own memory, from the block size rule
+    VkMemoryDedicatedAllocateInfo const noDedicated{
+        .sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO,
+    };
+    auto allocation = allocate(allocator, reqs, properties, 0, true, false, noDedicated);
+    track(allocator, allocation, category);
+    return allocation;
+}
+
+//-------------------------------------
+
+void freeMemory(Allocator_t &allocator, Allocation_t &allocation)
+{
+    if (!allocation.memory)
+        return;
+
+    auto const device = allocator.pDevice->handle;
+    allocator.tracked.erase(allocation.id);
+
+    // . Dedicated
+    if (allocation.block == UINT32_MAX)
+    {
+        vkFreeMemory(device, allocation.memory, nullptr);
+        --allocator.liveAllocations;
+        allocator.heapUsage[heapOf(allocator, allocation.pool / 2)] -= allocation.size;
+        --allocator.dedicatedCount;
+        allocator.dedicatedBytes -= allocation.size;
+        allocation = Allocation_t{};
+        return;
+    }
+
+    // . Sub-allocated
+    auto &pool  = allocator.pools[allocation.pool];
+    auto &block = pool.at(allocation.block);
+    releaseNode(block, allocation.offset, orderOf(allocation.size));
+
+    // . Give back empty blocks, but keep one alive per pool to avoid thrashing on load/unload cycles
+    if (block.used == 0)
+    {
+        auto const liveBlocks = std::count_if(pool.begin(), pool.end(), [](auto const &b) { return b.memory != VK_NULL_HANDLE; });
+        if (liveBlocks > 1)
+        {
+            vkFreeMemory(device, block.memory, nullptr);
+            --allocator.liveAllocations;
+            allocator.heapUsage[heapOf(allocator, allocation.pool / 2)] -= block.size;
+            block = MemoryBlock_t{};
+        }
+    }
+
+    allocation = Allocation_t{};
+}
+
+//-------------------------------------
+
+uint32_t allocationHeap(Allocator_t const &allocator, Allocation_t const &allocation)
+{
+    return heapOf(allocator, allocation.pool / 2);
+}
+
+//-------------------------------------
+
+AllocatorStats_t getAllocatorStats(Allocator_t const &allocator)
+{
+    AllocatorStats_t stats;
+
+    for (auto const &pool : allocator.pools)
+    {
+        for (auto const &block : pool)
+        {
+            if (!block.memory)
+                continue;
+
+            ++stats.blockCount;
+            stats.bytesReserved += block.size;
+            stats.bytesInUse += block.used;
+            for (uint32_t order = 0; order < block.freeNodes.size(); ++order)
+            {
+                if (block.freeNodes[order].empty())
+                    continue;
+                auto const nodeSize   = Allocator_t::sMinNodeSize << order;
+                stats.bytesFree      += nodeSize * block.freeNodes[order].size();
+                stats.largestFreeNode = std::max(stats.largestFreeNode, nodeSize);
+            }
+        }
+    }
+
+    stats.dedicatedCount = allocator.dedicatedCount;
+    stats.bytesReserved += allocator.dedicatedBytes;
+    stats.bytesInUse += allocator.dedicatedBytes;
+
+    if (stats.bytesFree > 0)
+        stats.fragmentation = 1.f - static_cast<float>(stats.largestFreeNode) / static_cast<float>(stats.bytesFree);
+
+    return stats;
+}
+
+//-------------------------------------
+
+MemoryBudget_t getMemoryBudget(Allocator_t const &allocator)
+{
+    auto const &gpu = *allocator.pDevice->pGpu;
+
+    MemoryBudget_t budget;
+    budget.heapCount = gpu.memory.memoryHeapCount;
+
+    if (gpu.memoryBudget)
+    {
+        VkPhysicalDeviceMemoryBudgetPropertiesEXT budgetProps{
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT,
+        };
+        VkPhysicalDeviceMemoryProperties2 memProps2{
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2,
+            .pNext = &budgetProps,
+        };
+        vkGetPhysicalDeviceMemoryProperties2(gpu.handle, &memProps2);
+        for (uint32_t i = 0; i < budget.heapCount; ++i)
+        {
+            budget.budget[i] = budgetProps.heapBudget[i];
+            budget.usage[i]  = budgetProps.heapUsage[i];
+        }
+        return budget;
+    }
+
+    // . No extension : the whole heap, minus a fifth for the rest of the system, and just our own usage
+    for (uint32_t i = 0; i < budget.heapCount; ++i)
+    {
+        budget.budget[i] = gpu.memory.memoryHeaps[i].size / 5 * 4;
+        budget.usage[i]  = allocator.heapUsage[i];
+    }
+    return budget;
+}
+
+//-------------------------------------
+
+void logAllocatorStats(Allocator_t const &allocator)
+{
+    auto const stats = getAllocatorStats(allocator);
+    LogInfof(
+        "ALLOCATOR -> blocks:{} dedicated:{} reserved:{}KB in-use:{}KB free:{}KB largest-free:{}KB fragmentation:{:.2f}",
+        stats.blockCount,
+        stats.dedicatedCount,
+        stats.bytesReserved / 1024,
+        stats.bytesInUse / 1024,
+        stats.bytesFree / 1024,
+        stats.largestFreeNode / 1024,
+        stats.fragmentation);
+}
+
+//-------------------------------------
+
+MemoryReport_t getMemoryReport(Allocator_t const &allocator)
+{
+    MemoryReport_t report;
+
+    for (auto const &[id, allocation] : allocator.tracked)
+    {
+        auto const category   = static_cast<uint32_t>(allocation.category);
+        auto const memoryType = allocation.pool / 2;
+        for (auto *pUsage : {&report.total,
+                             &report.perCategory[category],
+                             &report.perMemoryType[memoryType],
+                             &report.perCategoryAndType[category][memoryType]})
+        {
+            pUsage->count += 1;
+            pUsage->bytes += allocation.size;
+        }
+    }
+
+    return report;
+}
+
+//-------------------------------------
+
+void logMemoryReport(Allocator_t const &allocator)
+{
+    auto const  report   = getMemoryReport(allocator);
+    auto const &memProps = allocator.pDevice->pGpu->memory;
+
+    LogInfof("MEMORY -> allocations:{} bytes:{}KB", report.total.count, report.total.bytes / 1024);
+    for (uint32_t c = 0; c < sMemoryCategoryCount; ++c)
+    {
+        auto const &usage = report.perCategory[c];
+        if (usage.count < 1)
+            continue;
+        LogInfof("  {} -> allocations:{} bytes:{}KB", ToStr_MemoryCategory.at(c), usage.count, usage.bytes / 1024);
+
+        for (uint32_t t = 0; t < memProps.memoryTypeCount; ++t)
+        {
+            auto const &typeUsage = report.perCategoryAndType[c][t];
+            if (typeUsage.count < 1)
+                continue;
+            LogInfof(
+                "    type {} (heap {}) -> allocations:{} bytes:{}KB",
+                t,
+                memProps.memoryTypes[t].heapIndex,
+                typeUsage.count,
+                typeUsage.bytes / 1024);
+        }
+    }
+}
+
+//-------------------------------------
+
+uint32_t logMemoryLeaks(Allocator_t const &allocator)
+{
+    for (auto const &[id, allocation] : allocator.tracked)
+    {
+        LogWarnf(
+            "LEAK -> #{} {} : {}KB on memory type {}",
+            id,
+            ToStr_MemoryCategory.at(static_cast<uint32_t>(allocation.category)),
+            allocation.size / 1024,
+            allocation.pool / 2);
+    }
+    return GetCountU32(allocator.tracked);
+}
+
+//-------------------------------------
+
+//=============================================================================
+
+} // namespace vonk
@@ -0,0 +1,236 @@
+#include "VonkCooked.h"
+#include "VonkResources.h"
+#include "VonkVertex.h"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <type_traits>
+
+namespace vonk
+{ //
+
+//=============================================================================
+
+// === HELPERs
+
+//-------------------------------------
+
+namespace
+{
+static_assert(std::is_trivially_copyable_v<CookedHeader_t> && std::is_trivially_copyable_v<CookedMesh_t>);
+static_assert(std::is_trivially_copyable_v<Meshlet_t>);
+
+inline uint64_t alignCooked(uint64_t offset)
+{
+    return (offset + sCookedAlignment - 1) & ~(sCookedAlignment - 1);
+}
+
+//---
+
+// . Zeroes up to the next aligned offset, then the payload
+void writeAligned(std::ofstream &file, void const *data, uint64_t bytes, uint64_t &cursor)
+{
+    static constexpr char sZeros[sCookedAlignment] = {};
+    auto const            aligned                  = alignCooked(cursor);
+    file.write(sZeros, static_cast<std::streamsize>(aligned - cursor));
+    file.write(static_cast<char const *>(data), static_cast<std::streamsize>(bytes));
+    cursor = aligned + bytes;
+}
+
+//---
+
+bool validCooked(CookedHeader_t const &header, size_t fileSize)
+{
+    auto const format = static_cast<VertexFormat_t>(header.format);
+    auto const split  = header.split != 0u;
+    if (header.magic != sCookedMagic || header.version != sCookedVersion || header.format > uint32_t(VertexFormat_t::Packed))
+        return false;
+    if (header.stride != vonk::vertexStride(format, split) || header.positionStride != vonk::positionStride(format, split))
+        return false;
+
+    auto const fits = [fileSize](uint64_t offset, uint64_t bytes) {
+        return offset <= fileSize && bytes <= fileSize - offset;
+    };
+    return fits(header.meshesOffset, uint64_t{header.meshCount} * sizeof(CookedMesh_t))
+           && fits(header.indicesOffset, uint64_t{header.indexSlots} * sizeof(uint32_t))
+           && fits(header.verticesOffset, uint64_t{header.vertexCount} * header.stride)
+           && fits(header.positionsOffset, uint64_t{header.vertexCount} * header.positionStride)
+           && fits(header.meshletsOffset, uint64_t{header.meshletCount} * sizeof(Meshlet_t));
+}
+
+//---
+
+bool validCooked(CookedMeshes_t const &cooked, CookedMesh_t const &mesh)
+{
+    auto const &header = *cooked.header;
+    auto const  slots  = vonk::meshIndexSlots(mesh.indexCount, mesh.vertexCount);
+    if (uint64_t{mesh.firstSlot} + slots > header.indexSlots
+        || uint64_t{mesh.firstVertex} + mesh.vertexCount > header.vertexCount
+        || uint64_t{mesh.firstMeshlet} + mesh.meshletCount > header.meshletCount || mesh.lodCount < 1
+        || mesh.lodCount > sMaxMeshLods)
+        return false;
+
+    // . The levels and the meshlets are relative to the mesh's indices : they must stay inside them
+    auto const inside = [&mesh](uint32_t first, uint32_t count) {
+        return uint64_t{first} + count <= mesh.indexCount;
+    };
+    for (uint32_t l = 0; l < mesh.lodCount; ++l)
+    {
+        if (!inside(mesh.lods[l].firstIndex, mesh.lods[l].indexCount))
+            return false;
+    }
+    auto const *meshlets = reinterpret_cast<Meshlet_t const *>(cooked.payload(header.meshletsOffset)) + mesh.firstMeshlet;
+    return std::all_of(meshlets, meshlets + mesh.meshletCount, [&inside](Meshlet_t const &m) {
+        return inside(m.firstIndex, m.indexCount);
+    });
+}
+} // namespace
+
+//=============================================================================
+
+// === COOKED MESHES
+
+//-------------------------------------
+
+bool cookMeshes(std::string const &filepath, std::vector<MeshData_t> const &meshes, VertexFormat_t format, bool split)
+{
+    CookedHeader_t header;
+    header.format         = static_cast<uint32_t>(format);
+    header.split          = split ? 1u : 0u;
+    header.stride         = vonk::vertexStride(format, split);
+    header.positionStride = vonk::positionStride(format, split);
+    header.meshCount      = GetCountU32(meshes);
+
+    // . Encoded as 'createMeshes' would, but relative to the file instead of to the arena
+    std::vector<CookedMesh_t> records;
+    std::vector<uint32_t>     slots;
+    VertexStreams_t           streams;
+    std::vector<Meshlet_t>    meshlets;
+    records.reserve(meshes.size());
+
+    for (auto const &data : meshes)
+    {
+        CookedMesh_t mesh;
+        mesh.firstSlot    = GetCountU32(slots);
+        mesh.indexCount   = GetCountU32(data.indices);
+        mesh.firstVertex  = header.vertexCount;
+        mesh.vertexCount  = GetCountU32(data.vertices);
+        mesh.firstMeshlet = GetCountU32(meshlets);
+        mesh.meshletCount = GetCountU32(data.meshlets);
+
+        slots.resize(slots.size() + vonk::meshIndexSlots(mesh.indexCount, mesh.vertexCount), 0u);
+        auto *const dst = GetData(slots) + mesh.firstSlot;
+        if (vonk::meshIndexType(mesh.vertexCount) == VK_INDEX_TYPE_UINT16)
+        {
+            auto *const dst16 = reinterpret_cast<uint16_t *>(dst);
+            for (size_t i = 0; i < data.indices.size(); ++i)
+                dst16[i] = static_cast<uint16_t>(data.indices[i]);
+        }
+        else
+        {
+            std::copy(data.indices.begin(), data.indices.end(), dst);
+        }
+
+        mesh.lods[0] = {0u, mesh.indexCount, 0.f};
+        if (!data.lods.empty())
+        {
+            mesh.lodCount = std::min(GetCountU32(data.lods), sMaxMeshLods);
+            std::copy_n(data.lods.begin(), mesh.lodCount, mesh.lods.begin());
+        }
+
+        mesh.bounds = vonk::computeBounds(data.vertices);
+        mesh.sphere = vonk::boundingSphere(mesh.bounds);
+        vonk::encodeVertices(data.vertices, format, split, mesh.bounds, streams);
+        meshlets.insert(meshlets.end(), data.meshlets.begin(), data.meshlets.end());
+
+        header.vertexCount += mesh.vertexCount;
+        records.push_back(mesh);
+    }
+    header.indexSlots   = GetCountU32(slots);
+    header.meshletCount = GetCountU32(meshlets);
+
+    // . Offsets : every payload starts aligned
+    auto const meshesBytes    = records.size() * sizeof(CookedMesh_t);
+    auto const indicesBytes   = slots.size() * sizeof(uint32_t);
+    auto const verticesBytes  = streams.vertices.size();
+    auto const positionsBytes = streams.positions.size();
+    header.meshesOffset       = alignCooked(sizeof(CookedHeader_t));
+    header.indicesOffset      = alignCooked(header.meshesOffset + meshesBytes);
+    header.verticesOffset     = alignCooked(header.indicesOffset + indicesBytes);
+    header.positionsOffset    = alignCooked(header.verticesOffset + verticesBytes);
+    header.meshletsOffset     = alignCooked(header.positionsOffset + positionsBytes);
+
+    // . Written aside and renamed : readers never map a half-written file
+    auto const    tmpPath = filepath + ".tmp";
+    std::ofstream file{tmpPath, std::ios::binary | std::ios::trunc};
+    if (!file.is_open())
+    {
+        LogErrorf("COOKED -> '{}' : can't be written", filepath);
+        return false;
+    }
+
+    uint64_t cursor = 0u;
+    writeAligned(file, &header, sizeof(CookedHeader_t), cursor);
+    writeAligned(file, GetData(records), meshesBytes, cursor);
+    writeAligned(file, GetData(slots), indicesBytes, cursor);
+    writeAligned(file, GetData(streams.vertices), verticesBytes, cursor);
+    writeAligned(file, GetData(streams.positions), positionsBytes, cursor);
+    writeAligned(file, GetData(meshlets), meshlets.size() * sizeof(Meshlet_t), cursor);
+    file.close();
+    if (!file)
+    {
+        LogErrorf("COOKED -> '{}' : can't be written", filepath);
+        return false;
+    }
+
+    std::error_code error;
+    std::filesystem::rename(tmpPath, filepath, error);
+    if (error)
+    {
+        LogErrorf("COOKED -> '{}' : {}", filepath, error.message());
+        return false;
+    }
+    return true;
+}
+
+//-------------------------------------
+
+CookedMeshes_t openCookedMeshes(std::string const &filepath, VertexFormat_t format, bool split)
+{
+    auto file = std::make_shared<vo::files::Mapping_t const>(vo::files::map(filepath));
+    if (!*file || file->size() < sizeof(CookedHeader_t))
+        return {};
+
+    // . Page aligned mapping and aligned payloads : the tables are read in place
+    CookedMeshes_t cooked;
+    cooked.header = reinterpret_cast<CookedHeader_t const *>(file->data());
+    if (!validCooked(*cooked.header, file->size()))
+    {
+        LogWarnf("COOKED -> '{}' : from another version or vertex layout, or truncated", filepath);
+        return {};
+    }
+    if (cooked.header->format != static_cast<uint32_t>(format) || (cooked.header->split != 0u) != split)
+    {
+        LogWarnf("COOKED -> '{}' : cooked for another vertex format or split than the arena's", filepath);
+        return {};
+    }
+    cooked.meshes = reinterpret_cast<CookedMesh_t const *>(file->data() + cooked.header->meshesOffset);
+    cooked.file   = std::move(file);
+    for (uint32_t i = 0; i < cooked.header->meshCount; ++i)
+    {
+        if (!validCooked(cooked, cooked.meshes[i]))
+        {
+            LogWarnf("COOKED -> '{}' : mesh {} out of the payloads", filepath, i);
+            return {};
+        }
+    }
+    return cooked;
+}
+
+//-------------------------------------
+
+//=============================================================================
+
+} // namespace vonk
@@ -0,0 +1,687 @@
+#include "VonkGraph.h"
+#include "VonkAllocator.h"
+#include "VonkResources.h"
+
+#include <algorithm>
+#include <set>
+
+namespace vonk
+{ //
+
+//=============================================================================
+
+// === HELPERs
+
+//-------------------------------------
+
+namespace
+{
+struct UseInfo_t
+{
+    GraphAccess_t     access;
+    VkImageUsageFlags usage      = 0u;
+    bool              write      = false;
+    bool              attachment = false;
+};
+
+UseInfo_t useInfo(GraphUse_t use)
+{
+    constexpr auto fragmentTests = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+    constexpr auto shaders       = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+    switch (use)
+    {
+    case GraphUse_t::ColorAttachment:
+        return {
+            {VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+             VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+             VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT},
+            VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
+            true,
+            true,
+        };
+    case GraphUse_t::DepthAttachment:
+        return {
+            {VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+             fragmentTests,
+             VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT},
+            VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
+            true,
+            true,
+        };
+    case GraphUse_t::DepthRead:
+        return {
+            {VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL, fragmentTests, VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT},
+            VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
+            false,
+            true,
+        };
+    case GraphUse_t::Sampled:
+        return {
+            {VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, shaders, VK_ACCESS_SHADER_READ_BIT},
+            VK_IMAGE_USAGE_SAMPLED_BIT,
+        };
+    case GraphUse_t::StorageRead:
+        return {
+            {VK_IMAGE_LAYOUT_GENERAL, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT},
+            VK_IMAGE_USAGE_STORAGE_BIT,
+        };
+    case GraphUse_t::StorageWrite:
+        return {
+            {VK_IMAGE_LAYOUT_GENERAL,
+             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+             VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT},
+            VK_IMAGE_USAGE_STORAGE_BIT,
+            true,
+        };
+    case GraphUse_t::TransferSrc:
+        return {
+            {VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT},
+            VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+        };
+    case GraphUse_t::TransferDst:
+        return {
+            {VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT},
+            VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+            true,
+        };
+    }
+    return {};
+}
+
+//---
+
+bool isDepthFormat(VkFormat format)
+{
+    return format == VK_FORMAT_D16_UNORM || format == VK_FORMAT_X8_D24_UNORM_PACK32 || format == VK_FORMAT_D32_SFLOAT
+           || format == VK_FORMAT_D16_UNORM_S8_UINT || format == VK_FORMAT_D24_UNORM_S8_UINT
+           || format == VK_FORMAT_D32_SFLOAT_S8_UINT;
+}
+bool hasStencil(VkFormat format)
+{
+    return format == VK_FORMAT_D16_UNORM_S8_UINT || format == VK_FORMAT_D24_UNORM_S8_UINT
+           || format == VK_FORMAT_D32_SFLOAT_S8_UINT;
+}
+
+//---
+
+inline VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+inline bool overlaps(uint32_t firstA, uint32_t lastA, uint32_t firstB, uint32_t lastB)
+{
+    return firstA <= lastB && firstB <= lastA;
+}
+
+inline bool sharesMemory(GraphImageState_t const &a, GraphImageState_t const &b)
+{
+    return a.offset < b.offset + b.reqs.size && b.offset < a.offset + a.reqs.size;
+}
+
+//---
+
+// . Merges the accesses of consecutive reads : the next barrier has to wait for all of them
+void addBarrier(GraphBarriers_t &batch, GraphImage_t image, GraphAccess_t const &from, GraphAccess_t const &to)
+{
+    batch.barriers.push_back({image, from.layout, to.layout, from.access, to.access});
+    batch.srcStages |= from.stages;
+    batch.dstStages |= to.stages;
+}
+
+//---
+
+void emitBarriers(
+    VkCommandBuffer        cmd,
+    GraphBarriers_t const &batch,
+    RenderGraph_t const   &graph,
+    SwapChain_t const     &swapchain,
+    uint32_t               imageIndex)
+{
+    if (batch.barriers.empty())
+        return;
+
+    std::vector<VkImageMemoryBarrier> barriers;
+    barriers.reserve(batch.barriers.size());
+    for (auto const &b : batch.barriers)
+    {
+        auto const &state = graph.states[b.image];
+        auto const  image = b.image == graph.backbuffer ? swapchain.images[imageIndex] : state.image;
+        // . Kept images come from the previous frame as it left them, the first frame from nothing
+        auto const oldLayout = b.oldLayout == VK_IMAGE_LAYOUT_UNDEFINED && state.primed ? state.lastAccess.layout
+                                                                                        : b.oldLayout;
+        barriers.push_back({
+            .sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+            .srcAccessMask       = b.srcAccess,
+            .dstAccessMask       = b.dstAccess,
+            .oldLayout           = oldLayout,
+            .newLayout           = b.newLayout,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .image               = image,
+            .subresourceRange    = {state.aspect, 0, 1, 0, 1},
+        });
+    }
+    auto const srcStages = batch.srcStages ? batch.srcStages : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+    auto const dstStages = batch.dstStages ? batch.dstStages : VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+    vkCmdPipelineBarrier(cmd, srcStages, dstStages, 0, 0, nullptr, 0, nullptr, GetCountU32(barriers), GetData(barriers));
+}
+} // namespace
+
+//=============================================================================
+
+// === DECLARATION
+
+//-------------------------------------
+
+GraphImage_t graphBackbuffer(RenderGraph_t &graph)
+{
+    if (graph.backbuffer == UINT32_MAX)
+        graph.backbuffer = addGraphImage(graph, {.name = "backbuffer"});
+    return graph.backbuffer;
+}
+
+//-------------------------------------
+
+GraphImage_t addGraphImage(RenderGraph_t &graph, GraphImageDesc_t desc)
+{
+    graph.images.push_back(std::move(desc));
+    return GetCountU32(graph.images) - 1;
+}
+
+//-------------------------------------
+
+uint32_t addGraphPass(
+    RenderGraph_t                                   &graph,
+    std::string                                      name,
+    std::vector<std::pair<GraphImage_t, GraphUse_t>> uses,
+    std::function<void(VkCommandBuffer)>             record,
+    bool                                             keep)
+{
+    GraphPass_t pass;
+    pass.name   = std::move(name);
+    pass.uses   = std::move(uses);
+    pass.record = std::move(record);
+    pass.keep   = keep;
+    graph.passes.push_back(std::move(pass));
+    return GetCountU32(graph.passes) - 1;
+}
+
+//=============================================================================
+
+// === COMPILE
+
+//-------------------------------------
+
+void compileRenderGraph(Device_t const &device, SwapChain_t const &swapchain, RenderGraph_t &graph)
+{
+    destroyRenderGraph(device, graph);
+
+    auto const passCount  = GetCountU32(graph.passes);
+    auto const imageCount = GetCountU32(graph.images);
+
+    // ::: 1. Dependencies : writes of an image chained in declaration order, its reads after the last one
+    std::vector<std::vector<uint32_t>> writers(imageCount);
+    for (uint32_t p = 0; p < passCount; ++p)
+    {
+        std::set<GraphImage_t> seen;
+        for (auto const &[image, use] : graph.passes[p].uses)
+        {
+            AbortIfMsg(image >= imageCount, "Render graph pass using an undeclared image!");
+            AbortIfMsgf(!seen.insert(image).second, "Render graph pass '{}' uses an image twice", graph.passes[p].name);
+            if (useInfo(use).write)
+                writers[image].push_back(p);
+        }
+    }
+    std::vector<std::vector<uint32_t>> deps(passCount);
+    for (uint32_t p = 0; p < passCount; ++p)
+    {
+        for (auto const &[image, use] : graph.passes[p].uses)
+        {
+            auto const &w = writers[image];
+            if (useInfo(use).write)
+            {
+                auto const it = std::find(w.begin(), w.end(), p);
+                if (it != w.begin())
+                    deps[p].push_back(*(it - 1));
+            }
+            else if (!w.empty())
+            {
+                deps[p].push_back(w.back());
+            }
+        }
+    }
+
+    // ::: 2. Culling : what the roots need, back through the dependencies
+    std::vector<bool>     alive(passCount, false);
+    std::vector<uint32_t> pending;
+    for (uint32_t p = 0; p < passCount; ++p)
+    {
+        auto const &pass = graph.passes[p];
+        bool const  root = pass.keep || std::any_of(pass.uses.begin(), pass.uses.end(), [&](auto const &u) {
+                              return useInfo(u.second).write && (u.first == graph.backbuffer || graph.images[u.first].keep);
+                          });
+        if (root)
+            pending.push_back(p);
+    }
+    while (!pending.empty())
+    {
+        auto const p = pending.back();
+        pending.pop_back();
+        if (alive[p])
+            continue;
+        alive[p] = true;
+        pending.insert(pending.end(), deps[p].begin(), deps[p].end());
+    }
+
+    // ::: 3. Order : the earliest declared first among the ready ones
+    std::vector<uint32_t>              indegree(passCount, 0u);
+    std::vector<std::vector<uint32_t>> dependents(passCount);
+    for (uint32_t p = 0; p < passCount; ++p)
+    {
+        if (!alive[p])
+            continue;
+        std::set<uint32_t> const unique(deps[p].begin(), deps[p].end());
+        indegree[p] = GetCountU32(unique);
+        for (auto const d : unique)
+            dependents[d].push_back(p);
+    }
+    std::set<uint32_t> ready;
+    for (uint32_t p = 0; p < passCount; ++p)
+    {
+        if (alive[p] && indegree[p] == 0)
+            ready.insert(p);
+    }
+    while (!ready.empty())
+    {
+        auto const p = *ready.begin();
+        ready.erase(ready.begin());
+        graph.order.push_back(p);
+        for (auto const d : dependents[p])
+        {
+            if (--indegree[d] == 0)
+                ready.insert(d);
+        }
+    }
+    AbortIfMsg(graph.order.size() != size_t(std::count(alive.begin(), alive.end(), true)), "Render graph with a cycle!");
+
+    // ::: 4. Lifetimes and usages, over the passes kept
+    graph.states.assign(imageCount, {});
+    for (uint32_t pos = 0; pos < graph.order.size(); ++pos)
+    {
+        for (auto const &[image, use] : graph.passes[graph.order[pos]].uses)
+        {
+            auto &state    = graph.states[image];
+            state.firstUse = std::min(state.firstUse, pos);
+            state.lastUse  = std::max(state.lastUse, pos);
+            state.usage |= useInfo(use).usage;
+        }
+    }
+
+    // ::: 5. Images : created unbound, to know their requirements
+    std::vector<GraphImage_t> transients;
+    for (GraphImage_t i = 0; i < imageCount; ++i)
+    {
+        auto       &state = graph.states[i];
+        auto const &desc  = graph.images[i];
+        if (state.firstUse == UINT32_MAX)
+            continue;
+
+        if (i == graph.backbuffer)
+        {
+            state.format = swapchain.colorFormat;
+            state.extent = swapchain.extent2D;
+            state.aspect = VK_IMAGE_ASPECT_COLOR_BIT;
+            continue;
+        }
+
+        state.format = desc.format;
+        state.extent = desc.extent.width > 0 ? desc.extent
+                                             : VkExtent2D{
+                                                   std::max(uint32_t(swapchain.extent2D.width * desc.scale), 1u),
+                                                   std::max(uint32_t(swapchain.extent2D.height * desc.scale), 1u),
+                                               };
+        bool const depth = isDepthFormat(desc.format);
+        state.aspect     = !depth ? VK_IMAGE_ASPECT_COLOR_BIT
+                                  : VK_IMAGE_ASPECT_DEPTH_BIT | (hasStencil(desc.format) ? VK_IMAGE_ASPECT_STENCIL_BIT : 0u);
+
+        VkImageCreateInfo const imageCI{
+            .sType       = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+            .imageType   = VK_IMAGE_TYPE_2D,
+            .format      = desc.format,
+            .extent      = {state.extent.width, state.extent.height, 1},
+            .mipLevels   = 1,
+            .arrayLayers = 1,
+            .samples     = desc.samples,
+            .tiling      = VK_IMAGE_TILING_OPTIMAL,
+            .usage       = state.usage,
+        };
+        VkCheck(vkCreateImage(device.handle, &imageCI, nullptr, &state.image));
+        vkGetImageMemoryRequirements(device.handle, state.image, &state.reqs);
+        transients.push_back(i);
+    }
+
+    // ::: 6. Placement : biggest first, at the lowest offset clear of every image alive at the same time
+    //        Kept images are alive the whole frame (and across frames) : they never share
+    auto const spans = [&](GraphImage_t i) {
+        auto const &s = graph.states[i];
+        return graph.images[i].keep ? std::pair{0u, UINT32_MAX} : std::pair{s.firstUse, s.lastUse};
+    };
+    std::sort(transients.begin(), transients.end(), [&](GraphImage_t a, GraphImage_t b) {
+        return graph.states[a].reqs.size > graph.states[b].reqs.size;
+    });
+    VkMemoryRequirements      heapReqs{.size = 0u, .alignment = 1u, .memoryTypeBits = ~0u};
+    std::vector<GraphImage_t> placed;
+    for (auto const i : transients)
+    {
+        auto &state              = graph.states[i];
+        auto const [first, last] = spans(i);
+        state.offset             = 0u;
+        for (bool moved = true; moved;)
+        {
+            moved = false;
+            for (auto const q : placed)
+            {
+                auto const &other                  = graph.states[q];
+                auto const [otherFirst, otherLast] = spans(q);
+                if (overlaps(first, last, otherFirst, otherLast) && sharesMemory(state, other))
+                {
+                    state.offset = alignUp(other.offset + other.reqs.size, state.reqs.alignment);
+                    moved        = true;
+                }
+            }
+        }
+        placed.push_back(i);
+        heapReqs.size      = std::max(heapReqs.size, state.offset + state.reqs.size);
+        heapReqs.alignment = std::max(heapReqs.alignment, state.reqs.alignment);
+        heapReqs.memoryTypeBits &= state.reqs.memoryTypeBits;
+        graph.unaliasedBytes += alignUp(state.reqs.size, state.reqs.alignment);
+    }
+    if (!transients.empty())
+    {
+        AbortIfMsg(heapReqs.memoryTypeBits == 0u, "Render graph images without a memory type in common!");
+        graph.memory = vonk::allocateAliasedMemory(
+            *device.pAllocator, heapReqs, MemoryCategory_t::Attachment, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    }
+    for (auto const i : transients)
+    {
+        auto &state = graph.states[i];
+        VkCheck(vkBindImageMemory(device.handle, state.image, graph.memory.memory, graph.memory.offset + state.offset));
+
+        // . Views : depth only on combined formats, shaders sample one aspect
+        VkImageAspectFlags const    viewAspect = state.aspect & ~VkImageAspectFlags(VK_IMAGE_ASPECT_STENCIL_BIT);
+        VkImageViewCreateInfo const viewCI{
+            .sType            = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+            .image            = state.image,
+            .viewType         = VK_IMAGE_VIEW_TYPE_2D,
+            .format           = state.format,
+            .subresourceRange = {viewAspect, 0, 1, 0, 1},
+        };
+        VkCheck(vkCreateImageView(device.handle, &viewCI, nullptr, &state.view));
+    }
+
+    // ::: 7. Barriers : simulated once to know where each image ends the frame, then for real
+    //        A new barrier when the layout changes or a write is involved, consecutive reads share one
+    std::vector<GraphAccess_t> ends(imageCount);
+    auto const                 track = [&](bool emit) {
+        std::vector<GraphAccess_t> current(imageCount);
+        std::vector<bool>          dirty(imageCount, false); // Written since its last barrier
+        std::vector<bool>          started(imageCount, false);
+        for (uint32_t pos = 0; pos < graph.order.size(); ++pos)
+        {
+            auto &pass = graph.passes[graph.order[pos]];
+            for (auto const &[image, use] : pass.uses)
+            {
+                auto const info = useInfo(use);
+                if (!started[image])
+                {
+                    // . First of the frame : after whatever used its memory last, i.e. the previous frame
+                    started[image] = true;
+                    GraphAccess_t from;
+                    if (image == graph.backbuffer)
+                    {
+                        from.stages = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT; // Where the acquire is waited
+                    }
+                    else
+                    {
+                        auto const &state = graph.states[image];
+                        auto        prev  = image;
+                        for (auto const q : transients)
+                        {
+                            if (q == image || !sharesMemory(state, graph.states[q]))
+                                continue;
+                            // . Latest end before it starts, wrapping around the frame otherwise
+                            auto const rank = [&](GraphImage_t x) {
+                                auto const end = graph.states[x].lastUse;
+                                return end < state.firstUse ? end + graph.order.size() : end;
+                            };
+                            if (rank(q) > rank(prev))
+                                prev = q;
+                        }
+                        from.stages = ends[prev].stages;
+                        from.access = ends[prev].access & (VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT
+                                                           | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT
+                                                           | VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT);
+                    }
+                    if (emit)
+                        addBarrier(pass.before, image, from, info.access);
+                    current[image] = info.access;
+                    dirty[image]   = info.write;
+                    continue;
+                }
+
+                auto &cur = current[image];
+                if (cur.layout != info.access.layout || dirty[image] || info.write)
+                {
+                    if (emit)
+                        addBarrier(pass.before, image, cur, info.access);
+                    cur          = info.access;
+                    dirty[image] = info.write;
+                }
+                else
+                {
+                    cur.stages |= info.access.stages;
+                    cur.access |= info.access.access;
+                }
+            }
+        }
+        return current;
+    };
+    ends = track(false);
+    track(true);
+    for (GraphImage_t i = 0; i < imageCount; ++i)
+        graph.states[i].lastAccess = ends[i];
+    if (graph.backbuffer != UINT32_MAX && graph.states[graph.backbuffer].firstUse != UINT32_MAX)
+    {
+        addBarrier(graph.after, graph.backbuffer, ends[graph.backbuffer], {VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, 0u, 0u});
+    }
+
+    // ::: 8. Render passes : one subpass, in the layouts the barriers left. Clear on the first write of the frame,
+    //        store only what is used later, kept, or presented
+    for (uint32_t pos = 0; pos < graph.order.size(); ++pos)
+    {
+        auto            &pass = graph.passes[graph.order[pos]];
+        RenderPassData_t rpd;
+        std::vector<GraphImage_t> attachments;
+        int32_t                   depthRef = -1;
+        for (auto const &[image, use] : pass.uses)
+        {
+            auto const info = useInfo(use);
+            if (!info.attachment)
+                continue;
+
+            auto const &state  = graph.states[image];
+            bool const  first  = state.firstUse == pos && info.write;
+            bool const  stored = state.lastUse > pos || graph.images[image].keep || image == graph.backbuffer;
+            auto const  loadOp = first ? VK_ATTACHMENT_LOAD_OP_CLEAR : VK_ATTACHMENT_LOAD_OP_LOAD;
+            auto const  storeOp = stored && info.write ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+            bool const  stencil = state.aspect & VK_IMAGE_ASPECT_STENCIL_BIT;
+            rpd.attachments.push_back({
+                .format         = state.format,
+                .samples        = image == graph.backbuffer ? VK_SAMPLE_COUNT_1_BIT : graph.images[image].samples,
+                .loadOp         = loadOp,
+                .storeOp        = storeOp,
+                .stencilLoadOp  = stencil ? loadOp : VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+                .stencilStoreOp = stencil ? storeOp : VK_ATTACHMENT_STORE_OP_DONT_CARE,
+                .initialLayout  = info.access.layout,
+                .finalLayout    = info.access.layout,
+            });
+            rpd.attachmentRefs.push_back({GetCountU32(attachments), info.access.layout});
+            if (use != GraphUse_t::ColorAttachment)
+            {
+                AbortIfMsgf(depthRef >= 0, "Render graph pass '{}' with two depth attachments", pass.name);
+                depthRef = static_cast<int32_t>(attachments.size());
+            }
+            attachments.push_back(image);
+            pass.clears.push_back(graph.images[image].clear);
+
+            AbortIfMsgf(
+                pass.extent.width > 0 && (pass.extent.width != state.extent.width || pass.extent.height != state.extent.height),
+                "Render graph pass '{}' with attachments of different sizes",
+                pass.name);
+            pass.extent = state.extent;
+        }
+        if (attachments.empty())
+            continue;
+
+        // . Colors first on the subpass, in declaration order
+        std::vector<VkAttachmentReference> colorRefs;
+        for (size_t i = 0; i < rpd.attachmentRefs.size(); ++i)
+        {
+            if (int32_t(i) != depthRef)
+                colorRefs.push_back(rpd.attachmentRefs[i]);
+        }
+        rpd.subpassDescs = {{
+            .pipelineBindPoint       = VK_PIPELINE_BIND_POINT_GRAPHICS,
+            .colorAttachmentCount    = GetCountU32(colorRefs),
+            .pColorAttachments       = GetData(colorRefs),
+            .pDepthStencilAttachment = depthRef >= 0 ? &rpd.attachmentRefs[depthRef] : nullptr,
+        }};
+        pass.renderPass = vonk::createRenderPass(device.handle, rpd);
+
+        // . Framebuffers : the backbuffer changes with the swapchain image
+        bool const onBackbuffer = std::find(attachments.begin(), attachments.end(), graph.backbuffer) != attachments.end();
+        auto const count        = onBackbuffer ? swapchain.views.size() : size_t{1};
+        for (size_t f = 0; f < count; ++f)
+        {
+            std::vector<VkImageView> views;
+            for (auto const image : attachments)
+                views.push_back(image == graph.backbuffer ? swapchain.views[f] : graph.states[image].view);
+            VkFramebufferCreateInfo const framebufferCI{
+                .sType           = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO,
+                .renderPass      = pass.renderPass,
+                .attachmentCount = GetCountU32(views),
+                .pAttachments    = GetData(views),
+                .width           = pass.extent.width,
+                .height          = pass.extent.height,
+                .layers          = 1,
+            };
+            VkCheck(vkCreateFramebuffer(device.handle, &framebufferCI, nullptr, &pass.frameBuffers.emplace_back()));
+        }
+    }
+}
+
+//-------------------------------------
+
+void recordRenderGraph(VkCommandBuffer cmd, RenderGraph_t &graph, SwapChain_t const &swapchain, uint32_t imageIndex)
+{
+    for (auto const p : graph.order)
+    {
+        auto const &pass = graph.passes[p];
+        emitBarriers(cmd, pass.before, graph, swapchain, imageIndex);
+
+        if (!pass.renderPass)
+        {
+            if (pass.record)
+                pass.record(cmd);
+            continue;
+        }
+
+        auto const                  frameBuffer = pass.frameBuffers.size() > 1 ? pass.frameBuffers[imageIndex] : pass.frameBuffers[0];
+        VkRenderPassBeginInfo const renderpassBI{
+            .sType           = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
+            .renderPass      = pass.renderPass,
+            .framebuffer     = frameBuffer,
+            .renderArea      = {{0, 0}, pass.extent},
+            .clearValueCount = GetCountU32(pass.clears),
+            .pClearValues    = GetData(pass.clears),
+        };
+        vkCmdBeginRenderPass(cmd, &renderpassBI, VK_SUBPASS_CONTENTS_INLINE);
+
+        // . The whole pass by default : the pipelines have them dynamic
+        VkViewport const viewport{0.f, 0.f, float(pass.extent.width), float(pass.extent.height), 0.f, 1.f};
+        VkRect2D const   scissor{{0, 0}, pass.extent};
+        vkCmdSetViewport(cmd, 0, 1, &viewport);
+        vkCmdSetScissor(cmd, 0, 1, &scissor);
+        if (pass.record)
+            pass.record(cmd);
+
+        vkCmdEndRenderPass(cmd);
+    }
+    emitBarriers(cmd, graph.after, graph, swapchain, imageIndex);
+
+    for (GraphImage_t i = 0; i < graph.images.size(); ++i)
+    {
+        if (graph.images[i].keep && graph.states[i].firstUse != UINT32_MAX)
+            graph.states[i].primed = true;
+    }
+}
+
+//-------------------------------------
+
+void destroyRenderGraph(Device_t const &device, RenderGraph_t &graph)
+{
+    for (auto &pass : graph.passes)
+    {
+        for (auto const frameBuffer : pass.frameBuffers)
+            vkDestroyFramebuffer(device.handle, frameBuffer, nullptr);
+        if (pass.renderPass)
+            vkDestroyRenderPass(device.handle, pass.renderPass, nullptr);
+        pass.frameBuffers.clear();
+        pass.clears.clear();
+        pass.renderPass = VK_NULL_HANDLE;
+        pass.extent     = {0u, 0u};
+        pass.before     = {};
+    }
+    for (auto &state : graph.states)
+    {
+        if (state.view)
+            vkDestroyImageView(device.handle, state.view, nullptr);
+        if (state.image)
+            vkDestroyImage(device.handle, state.image, nullptr);
+    }
+    vonk::freeMemory(*device.pAllocator, graph.memory);
+
+    graph.order.clear();
+    graph.states.clear();
+    graph.after          = {};
+    graph.unaliasedBytes = 0u;
+}
+
+//-------------------------------------
+
+void logRenderGraph(RenderGraph_t const &graph)
+{
+    std::string passes;
+    for (auto const p : graph.order)
+        passes += fmt::format("{}{}", passes.empty() ? "" : " -> ", graph.passes[p].name);
+
+    size_t barriers = graph.after.barriers.size();
+    for (auto const p : graph.order)
+        barriers += graph.passes[p].before.barriers.size();
+
+    LogInfof(
+        "RENDER GRAPH -> {} of {} passes ({}), {} barriers, {:.1f}MB of images in {:.1f}MB",
+        graph.order.size(),
+        graph.passes.size(),
+        passes,
+        barriers,
+        graph.unaliasedBytes / (1024.0 * 1024.0),
+        graph.memory.size / (1024.0 * 1024.0));
+}
+
+//-------------------------------------
+
+//=============================================================================
+
+} // namespace vonk
@@ -0,0 +1,461 @@
+#include "VonkImport.h"
+#include "Utils.h"
+
+// . Geometry only : images are neither decoded nor written
+#define TINYGLTF_IMPLEMENTATION
+#define TINYGLTF_NO_STB_IMAGE
+#define TINYGLTF_NO_STB_IMAGE_WRITE
+#define TINYGLTF_NO_EXTERNAL_IMAGE
+#include "tiny_gltf.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <limits>
+#include <numeric>
+#include <type_traits>
+
+namespace vonk
+{ //
+
+//=============================================================================
+
+// === HELPERs
+
+//-------------------------------------
+
+namespace
+{
+template <typename T>
+float toFloat(T v, bool normalized)
+{
+    if constexpr (std::is_floating_point_v<T>)
+        return v;
+    else if constexpr (std::is_signed_v<T>)
+        return normalized ? std::max(static_cast<float>(v) / std::numeric_limits<T>::max(), -1.f)
+                          : static_cast<float>(v);
+    else
+        return normalized ? static_cast<float>(v) / std::numeric_limits<T>::max() : static_cast<float>(v);
+}
+
+//---
+
+template <typename Fn>
+void withComponentType(int componentType, Fn &&fn)
+{
+    switch (componentType)
+    {
+        case TINYGLTF_COMPONENT_TYPE_BYTE: fn(int8_t{}); break;
+        case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE: fn(uint8_t{}); break;
+        case TINYGLTF_COMPONENT_TYPE_SHORT: fn(int16_t{}); break;
+        case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT: fn(uint16_t{}); break;
+        case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT: fn(uint32_t{}); break;
+        case TINYGLTF_COMPONENT_TYPE_FLOAT: fn(float{}); break;
+        default: break;
+    }
+}
+
+//---
+
+// . 'count' elements of 'srcComps' components each into 'dstComps' floats at 'dstStride' bytes
+template <typename T>
+void decodeFloats(
+    uint8_t const *src,
+    size_t         srcStride,
+    size_t         count,
+    uint32_t       srcComps,
+    bool           normalized,
+    uint8_t       *dst,
+    size_t         dstStride,
+    uint32_t       dstComps)
+{
+    auto const comps = std::min(srcComps, dstComps);
+    for (size_t i = 0; i < count; ++i)
+    {
+        auto const *elem = src + i * srcStride;
+        auto       *out  = reinterpret_cast<float *>(dst + i * dstStride);
+        for (uint32_t c = 0; c < comps; ++c)
+        {
+            T v;
+            memcpy(&v, elem + c * sizeof(T), sizeof(T)); // glTF only guarantees component alignment
+            out[c] = toFloat(v, normalized);
+        }
+    }
+}
+
+//---
+
+uint8_t const *viewData(tinygltf::Model const &model, int bufferView, size_t byteOffset)
+{
+    auto const &view = model.bufferViews[bufferView];
+    return model.buffers[view.buffer].data.data() + view.byteOffset + byteOffset;
+}
+
+//---
+
+// . 'count' elements of 'size' bytes every 'stride' from 'byteOffset' : inside the view, and the view inside its buffer
+bool fitsView(tinygltf::Model const &model, int bufferView, size_t byteOffset, size_t count, size_t stride, size_t size)
+{
+    if (bufferView < 0 || static_cast<size_t>(bufferView) >= model.bufferViews.size())
+        return false;
+    auto const &view = model.bufferViews[bufferView];
+    if (view.buffer < 0 || static_cast<size_t>(view.buffer) >= model.buffers.size()
+        || view.byteOffset + view.byteLength > model.buffers[view.buffer].data.size())
+        return false;
+    return count < 1 || byteOffset + (count - 1) * stride + size <= view.byteLength;
+}
+
+//---
+
+// . Into 'dst' (one element every 'dstStride' bytes, 'dstComps' floats each) : strided and sparse accessors
+//   False when any of its data falls out of its buffers, or a sparse index out of its 'count' : 'dst' is left partial
+bool decodeAccessor(tinygltf::Model const &model, int accessorIdx, void *dst, size_t dstStride, uint32_t dstComps)
+{
+    auto const &acc   = model.accessors[accessorIdx];
+    auto const  comps = static_cast<uint32_t>(tinygltf::GetNumComponentsInType(acc.type));
+    auto const  size  = static_cast<size_t>(tinygltf::GetComponentSizeInBytes(acc.componentType)) * comps;
+    auto *const out   = static_cast<uint8_t *>(dst);
+
+    // . Dense part : no buffer view means all zeros (what a sparse accessor starts from)
+    if (acc.bufferView >= 0)
+    {
+        auto const stride = acc.bufferView < static_cast<int>(model.bufferViews.size())
+                                ? acc.ByteStride(model.bufferViews[acc.bufferView])
+                                : -1;
+        if (stride < 1 || !fitsView(model, acc.bufferView, acc.byteOffset, acc.count, stride, size))
+        {
+            LogErrorf("glTF : accessor {} out of its buffer view", accessorIdx);
+            return false;
+        }
+        auto const src = viewData(model, acc.bufferView, acc.byteOffset);
+        withComponentType(acc.componentType, [&](auto tag) {
+            using T = decltype(tag);
+            decodeFloats<T>(src, stride, acc.count, comps, acc.normalized, out, dstStride, dstComps);
+        });
+    }
+
+    // . Sparse part : tightly packed values for the listed elements
+    if (acc.sparse.isSparse)
+    {
+        auto const &sparse  = acc.sparse;
+        auto const  count   = static_cast<size_t>(std::max(sparse.count, 0));
+        auto const  idxSize = static_cast<size_t>(std::max(tinygltf::GetComponentSizeInBytes(sparse.indices.componentType), 0));
+        if (idxSize < 1 || !fitsView(model, sparse.indices.bufferView, sparse.indices.byteOffset, count, idxSize, idxSize)
+            || !fitsView(model, sparse.values.bufferView, sparse.values.byteOffset, count, size, size))
+        {
+            LogErrorf("glTF : sparse accessor {} out of its buffer views", accessorIdx);
+            return false;
+        }
+
+        auto const indices = viewData(model, sparse.indices.bufferView, sparse.indices.byteOffset);
+        auto const values  = viewData(model, sparse.values.bufferView, sparse.values.byteOffset);
+        bool       valid   = true;
+        withComponentType(sparse.indices.componentType, [&](auto idxTag) {
+            using I = decltype(idxTag);
+            withComponentType(acc.componentType, [&](auto tag) {
+                using T = decltype(tag);
+                for (size_t i = 0; i < count && valid; ++i)
+                {
+                    I idx;
+                    memcpy(&idx, indices + i * sizeof(I), sizeof(I));
+                    auto const element = static_cast<size_t>(idx);
+                    if (!std::is_unsigned_v<I> || element >= acc.count)
+                    {
+                        LogErrorf("glTF : sparse accessor {} writes element {} of {}", accessorIdx, element, acc.count);
+                        valid = false;
+                        break;
+                    }
+                    decodeFloats<T>(
+                        values + i * size, size, 1, comps, acc.normalized, out + element * dstStride, dstStride, dstComps);
+                }
+            });
+        });
+        return valid;
+    }
+    return true;
+}
+
+//---
+
+// . Any index type widened to 32 bits. Empty when they fall out of their buffer, or any reaches past 'vertexCount'
+std::vector<uint32_t> decodeIndices(tinygltf::Model const &model, int accessorIdx, size_t vertexCount)
+{
+    auto const &acc  = model.accessors[accessorIdx];
+    auto const  size = static_cast<size_t>(std::max(tinygltf::GetComponentSizeInBytes(acc.componentType), 0));
+    auto const  stride =
+        acc.bufferView >= 0 && acc.bufferView < static_cast<int>(model.bufferViews.size())
+            ? acc.ByteStride(model.bufferViews[acc.bufferView])
+            : -1;
+    if (size < 1 || stride < 1 || !fitsView(model, acc.bufferView, acc.byteOffset, acc.count, stride, size))
+    {
+        LogErrorf("glTF : index accessor {} out of its buffer view", accessorIdx);
+        return {};
+    }
+
+    std::vector<uint32_t> indices(acc.count);
+    auto const            src = viewData(model, acc.bufferView, acc.byteOffset);
+    withComponentType(acc.componentType, [&](auto tag) {
+        using T = decltype(tag);
+        for (size_t i = 0; i < acc.count; ++i)
+        {
+            T v;
+            memcpy(&v, src + i * stride, sizeof(T));
+            indices[i] = static_cast<uint32_t>(v);
+        }
+    });
+
+    // . The GPU would fetch past the mesh's vertices
+    auto const beyond = std::find_if(indices.begin(), indices.end(), [vertexCount](uint32_t i) { return i >= vertexCount; });
+    if (beyond != indices.end())
+    {
+        LogErrorf("glTF : index accessor {} references vertex {} of {}", accessorIdx, *beyond, vertexCount);
+        return {};
+    }
+    return indices;
+}
+
+//---
+
+struct PrimitiveJob_t
+{
+    tinygltf::Primitive const *pPrimitive;
+    glm::mat4                  world;
+};
+
+//---
+
+MeshData_t decodePrimitive(tinygltf::Model const &model, PrimitiveJob_t const &job)
+{
+    auto const &attrs = job.pPrimitive->attributes;
+    auto const  find  = [&attrs, &model](char const *name) {
+        auto const it = attrs.find(name);
+        return it != attrs.end() && it->second < static_cast<int>(model.accessors.size()) ? it->second : -1;
+    };
+
+    MeshData_t data;
+    auto const positions = find("POSITION");
+    if (positions < 0)
+        return data;
+
+    // . Vertices : each attribute decoded straight into its Vertex_t field
+    auto const vertexCount = model.accessors[positions].count;
+    Vertex_t   defaults;
+    defaults.vertex    = glm::vec3(0.f);
+    defaults.uv        = glm::vec2(0.f);
+    defaults.normal    = glm::vec3(0.f);
+    defaults.tangent   = glm::vec3(0.f);
+    defaults.bitangent = glm::vec3(0.f);
+    defaults.color     = glm::vec3(1.f);
+    data.vertices.assign(vertexCount, defaults);
+
+    // . Malformed accessors reject the whole primitive : empty, it gets dropped
+    auto const decodeInto = [&](int accessorIdx, size_t fieldOffset, uint32_t comps) {
+        if (accessorIdx < 0 || model.accessors[accessorIdx].count != vertexCount)
+            return true;
+        auto *const dst = reinterpret_cast<uint8_t *>(data.vertices.data()) + fieldOffset;
+        return decodeAccessor(model, accessorIdx, dst, sizeof(Vertex_t), comps);
+    };
+    bool const decoded = decodeInto(positions, offsetof(Vertex_t, vertex), 3)
+                         && decodeInto(find("TEXCOORD_0"), offsetof(Vertex_t, uv), 2)
+                         && decodeInto(find("NORMAL"), offsetof(Vertex_t, normal), 3)
+                         && decodeInto(find("COLOR_0"), offsetof(Vertex_t, color), 3);
+    if (!decoded)
+        return MeshData_t{};
+
+    // . Tangents : the w sign gives the bitangent handedness
+    if (auto const tangents = find("TANGENT"); tangents >= 0 && model.accessors[tangents].count == vertexCount)
+    {
+        std::vector<glm::vec4> tangents4(vertexCount, glm::vec4(0.f, 0.f, 0.f, 1.f));
+        if (!decodeAccessor(model, tangents, tangents4.data(), sizeof(glm::vec4), 4))
+            return MeshData_t{};
+        for (size_t i = 0; i < vertexCount; ++i)
+        {
+            auto &v     = data.vertices[i];
+            v.tangent   = glm::vec3(tangents4[i]);
+            v.bitangent = glm::cross(v.normal, v.tangent) * tangents4[i].w;
+        }
+    }
+
+    // . Indices : non-indexed primitives get the trivial list
+    if (job.pPrimitive->indices >= 0)
+    {
+        if (job.pPrimitive->indices < static_cast<int>(model.accessors.size()))
+            data.indices = decodeIndices(model, job.pPrimitive->indices, vertexCount);
+        if (data.indices.empty())
+            return MeshData_t{};
+    }
+    else
+    {
+        data.indices.resize(vertexCount);
+        std::iota(data.indices.begin(), data.indices.end(), 0u);
+    }
+    if (data.indices.size() % 3 != 0)
+    {
+        LogErrorf("glTF : triangle list of {} indices", data.indices.size());
+        return MeshData_t{};
+    }
+
+    // . Bake the node transform
+    if (job.world != glm::mat4(1.f))
+    {
+        auto const linear = glm::mat3(job.world);
+        auto const normal = glm::transpose(glm::inverse(linear));
+        for (auto &v : data.vertices)
+        {
+            v.vertex = glm::vec3(job.world * glm::vec4(v.vertex, 1.f));
+            if (v.normal != glm::vec3(0.f))
+                v.normal = glm::normalize(normal * v.normal);
+            if (v.tangent != glm::vec3(0.f))
+                v.tangent = glm::normalize(linear * v.tangent);
+            if (v.bitangent != glm::vec3(0.f))
+                v.bitangent = glm::normalize(linear * v.bitangent);
+        }
+        // . Mirroring transforms flip the winding
+        if (glm::determinant(linear) < 0.f)
+        {
+            for (size_t i = 0; i + 2 < data.indices.size(); i += 3)
+                std::swap(data.indices[i + 1], data.indices[i + 2]);
+        }
+    }
+
+    return data;
+}
+
+//---
+
+glm::mat4 localMatrix(tinygltf::Node const &node)
+{
+    if (node.matrix.size() == 16)
+        return glm::mat4(glm::make_mat4(node.matrix.data()));
+
+    glm::mat4 m(1.f);
+    if (node.translation.size() == 3)
+        m = glm::translate(m, glm::vec3(glm::make_vec3(node.translation.data())));
+    if (node.rotation.size() == 4)
+    {
+        auto const &r = node.rotation;
+        m *= glm::mat4_cast(glm::quat(float(r[3]), float(r[0]), float(r[1]), float(r[2])));
+    }
+    if (node.scale.size() == 3)
+        m = glm::scale(m, glm::vec3(glm::make_vec3(node.scale.data())));
+    return m;
+}
+
+//---
+
+// . Nodes form trees : out-of-range references and nodes reached twice (cycles included) count in 'broken', and
+//   are not followed
+void gatherPrimitives(
+    tinygltf::Model const       &model,
+    int                          nodeIdx,
+    glm::mat4 const             &parent,
+    std::vector<PrimitiveJob_t> &jobs,
+    std::vector<bool>           &visited,
+    uint32_t                    &skipped,
+    uint32_t                    &broken)
+{
+    if (nodeIdx < 0 || static_cast<size_t>(nodeIdx) >= model.nodes.size() || visited[nodeIdx])
+    {
+        ++broken;
+        return;
+    }
+    visited[nodeIdx] = true;
+
+    auto const &node  = model.nodes[nodeIdx];
+    auto const  world = parent * localMatrix(node);
+
+    if (node.mesh >= 0 && static_cast<size_t>(node.mesh) >= model.meshes.size())
+    {
+        ++broken;
+    }
+    else if (node.mesh >= 0)
+    {
+        for (auto const &primitive : model.meshes[node.mesh].primitives)
+        {
+            // . Just triangle lists ( -1 : unset, defaults to triangles )
+            if (primitive.mode != TINYGLTF_MODE_TRIANGLES && primitive.mode != -1)
+            {
+                ++skipped;
+                continue;
+            }
+            jobs.push_back({&primitive, world});
+        }
+    }
+
+    for (auto const child : node.children)
+        gatherPrimitives(model, child, world, jobs, visited, skipped, broken);
+}
+} // namespace
+
+//-------------------------------------
+
+//=============================================================================
+
+// === IMPORT
+
+//-------------------------------------
+
+std::vector<MeshData_t> importGltf(std::string const &filepath)
+{
+    // . Load : images are skipped, just the buffers are needed
+    tinygltf::Model    model;
+    tinygltf::TinyGLTF loader;
+    loader.SetImageLoader(
+        [](tinygltf::Image *, int const, std::string *, std::string *, int, int, unsigned char const *, int, void *) {
+            return true;
+        },
+        nullptr);
+
+    std::string err, warn;
+    auto const  ext = std::filesystem::path(filepath).extension().string();
+    bool const  ok  = ext == ".glb"    ? loader.LoadBinaryFromFile(&model, &err, &warn, filepath)
+                      : ext == ".gltf" ? loader.LoadASCIIFromFile(&model, &err, &warn, filepath)
+                                       : (err = "Unsupported extension '" + ext + "'", false);
+    if (!warn.empty())
+        LogWarnf("glTF '{}' : {}", filepath, warn);
+    if (!ok)
+    {
+        LogErrorf("glTF '{}' : {}", filepath, err);
+        return {};
+    }
+
+    // . Primitives instanced by the default scene ( every mesh, untransformed, when there is no scene )
+    std::vector<PrimitiveJob_t> jobs;
+    uint32_t                    skipped = 0u;
+    uint32_t                    broken  = 0u;
+    if (!model.scenes.empty())
+    {
+        auto sceneIdx = std::max(model.defaultScene, 0);
+        if (static_cast<size_t>(sceneIdx) >= model.scenes.size())
+        {
+            LogErrorf("glTF '{}' : default scene {} out of range, the first one instead", filepath, sceneIdx);
+            sceneIdx = 0;
+        }
+        std::vector<bool> visited(model.nodes.size(), false);
+        for (auto const nodeIdx : model.scenes[sceneIdx].nodes)
+            gatherPrimitives(model, nodeIdx, glm::mat4(1.f), jobs, visited, skipped, broken);
+    }
+    else
+    {
+        for (auto const &mesh : model.meshes)
+            for (auto const &primitive : mesh.primitives)
+                jobs.push_back({&primitive, glm::mat4(1.f)});
+    }
+    if (skipped > 0)
+        LogWarnf("glTF '{}' : skipped {} non-triangle-list primitives", filepath, skipped);
+    if (broken > 0)
+        LogErrorf("glTF '{}' : skipped {} node / mesh references out of range or making cycles", filepath, broken);
+
+    // . Decode : one primitive per job, across the worker threads
+    std::vector<MeshData_t> meshes(jobs.size());
+    vo::jobs::parallelFor(jobs.size(), [&](size_t i) { meshes[i] = decodePrimitive(model, jobs[i]); });
+
+    std::erase_if(meshes, [](auto const &m) { return m.vertices.empty() || m.indices.empty(); });
+    return meshes;
+}
+
+//-------------------------------------
+
+//=============================================================================
+
+} // namespace vonk
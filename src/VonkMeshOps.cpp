@@ -0,0 +1,1429 @@
+#include "VonkMeshOps.h"
+#include "Utils.h"
+
+#include <algorithm>
+#include <array>
+#include <cfloat>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstddef>
+#include <string_view>
+#include <unordered_map>
+
+#if defined(__AVX__) || defined(__SSE__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
+namespace vonk
+{ //
+
+//=============================================================================
+
+// === HELPERs
+
+//-------------------------------------
+
+namespace
+{
+// . FIFO cache : a vertex is cached while less than 'sCacheSize' misses happened since its own
+struct CacheSim_t
+{
+    std::vector<uint32_t> stamps;
+    uint32_t              time = MeshMetrics_t::sCacheSize + 1;
+
+    explicit CacheSim_t(size_t vertexCount) : stamps(vertexCount, 0u) {}
+
+    uint32_t access(uint32_t v)
+    {
+        if (time - stamps[v] <= MeshMetrics_t::sCacheSize)
+            return 0u;
+        stamps[v] = time++;
+        return 1u;
+    }
+    uint32_t triangle(uint32_t const *tri) { return access(tri[0]) + access(tri[1]) + access(tri[2]); }
+    void     flush() { time += MeshMetrics_t::sCacheSize + 1; }
+};
+
+//---
+
+// . Triangles using each vertex : 'offsets[v]' to 'offsets[v + 1]' in 'triangles'
+struct Adjacency_t
+{
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> triangles;
+
+    Adjacency_t(std::vector<uint32_t> const &indices, size_t vertexCount) : offsets(vertexCount + 1, 0u)
+    {
+        for (auto const v : indices)
+            ++offsets[v + 1];
+        for (size_t v = 0; v < vertexCount; ++v)
+            offsets[v + 1] += offsets[v];
+
+        triangles.resize(indices.size());
+        auto cursor = offsets;
+        for (size_t i = 0; i < indices.size(); ++i)
+            triangles[cursor[indices[i]]++] = static_cast<uint32_t>(i / 3);
+    }
+};
+
+//---
+
+// . Depth-tested raster of one orthographic view, 'shaded' counts every fragment that passed
+template <uint32_t Res>
+void rasterize(std::vector<glm::vec3> const &points, std::vector<uint32_t> const &indices, MeshMetrics_t &metrics)
+{
+    std::vector<float> depth(Res * Res, FLT_MAX);
+
+    for (size_t t = 0; t + 2 < indices.size(); t += 3)
+    {
+        auto const &a = points[indices[t]];
+        auto const &b = points[indices[t + 1]];
+        auto const &c = points[indices[t + 2]];
+
+        // . Back faces are culled, as the GPU would
+        auto const area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+        if (area <= 0.f)
+            continue;
+
+        auto const minX = static_cast<int>(std::max(std::min({a.x, b.x, c.x}), 0.f));
+        auto const minY = static_cast<int>(std::max(std::min({a.y, b.y, c.y}), 0.f));
+        auto const maxX = static_cast<int>(std::min(std::max({a.x, b.x, c.x}), float(Res - 1)));
+        auto const maxY = static_cast<int>(std::min(std::max({a.y, b.y, c.y}), float(Res - 1)));
+
+        for (int y = minY; y <= maxY; ++y)
+        {
+            for (int x = minX; x <= maxX; ++x)
+            {
+                auto const px = x + 0.5f;
+                auto const py = y + 0.5f;
+                auto const w0 = (c.x - b.x) * (py - b.y) - (c.y - b.y) * (px - b.x);
+                auto const w1 = (a.x - c.x) * (py - c.y) - (a.y - c.y) * (px - c.x);
+                auto const w2 = (b.x - a.x) * (py - a.y) - (b.y - a.y) * (px - a.x);
+                if (w0 < 0.f || w1 < 0.f || w2 < 0.f)
+                    continue;
+
+                auto const z = (w0 * a.z + w1 * b.z + w2 * c.z) / area;
+                auto      &d = depth[y * Res + x];
+                if (z < d)
+                {
+                    d = z;
+                    ++metrics.pixelsShaded;
+                }
+            }
+        }
+    }
+
+    metrics.pixelsCovered += std::count_if(depth.begin(), depth.end(), [](float d) { return d != FLT_MAX; });
+}
+
+//---
+
+// . Tipsify : next fanning vertex, the cached one whose triangles fit the cache best, or a dead end
+int32_t nextFanningVertex(
+    std::vector<uint32_t> const &candidates,
+    std::vector<uint32_t> const &live,
+    std::vector<uint32_t> const &stamps,
+    uint32_t                     time,
+    std::vector<uint32_t>       &deadEnds,
+    uint32_t                    &cursor)
+{
+    auto constexpr cacheSize = MeshMetrics_t::sCacheSize;
+
+    int32_t  best         = -1;
+    uint32_t bestPriority = 0u;
+    for (auto const v : candidates)
+    {
+        if (live[v] < 1)
+            continue;
+        // . Still in cache after emitting all its triangles : the older the better, else the lowest
+        uint32_t priority = 0u;
+        if (time - stamps[v] + 2 * live[v] <= cacheSize)
+            priority = time - stamps[v];
+        if (best < 0 || priority > bestPriority)
+        {
+            best         = static_cast<int32_t>(v);
+            bestPriority = priority;
+        }
+    }
+    if (best >= 0)
+        return best;
+
+    // . Dead end : recent vertices first, then the next live one in input order
+    while (!deadEnds.empty())
+    {
+        auto const v = deadEnds.back();
+        deadEnds.pop_back();
+        if (live[v] > 0)
+            return static_cast<int32_t>(v);
+    }
+    for (; cursor < live.size(); ++cursor)
+    {
+        if (live[cursor] > 0)
+            return static_cast<int32_t>(cursor);
+    }
+    return -1;
+}
+
+//---
+
+// . Tipsify triangle order of 'input', see 'optimizeVertexCache'
+std::vector<uint32_t> tipsify(std::vector<uint32_t> const &input, size_t vertexCount)
+{
+    auto const  triangleCount = input.size() / 3;
+    Adjacency_t adjacency(input, vertexCount);
+
+    std::vector<uint32_t> live(vertexCount);
+    for (size_t v = 0; v < vertexCount; ++v)
+        live[v] = adjacency.offsets[v + 1] - adjacency.offsets[v];
+
+    std::vector<uint32_t> stamps(vertexCount, 0u);
+    std::vector<bool>     emitted(triangleCount, false);
+    std::vector<uint32_t> deadEnds, candidates, indices;
+    indices.reserve(input.size());
+
+    uint32_t time   = MeshMetrics_t::sCacheSize + 1;
+    uint32_t cursor = 0u;
+    int32_t  fan    = nextFanningVertex({}, live, stamps, time, deadEnds, cursor);
+
+    while (fan >= 0)
+    {
+        // . Emit every live triangle around the fanning vertex
+        candidates.clear();
+        for (auto a = adjacency.offsets[fan]; a < adjacency.offsets[fan + 1]; ++a)
+        {
+            auto const t = adjacency.triangles[a];
+            if (emitted[t])
+                continue;
+            emitted[t] = true;
+
+            for (uint32_t k = 0; k < 3; ++k)
+            {
+                auto const v = input[t * 3 + k];
+                indices.push_back(v);
+                deadEnds.push_back(v);
+                candidates.push_back(v);
+                --live[v];
+                if (time - stamps[v] > MeshMetrics_t::sCacheSize)
+                    stamps[v] = time++;
+            }
+        }
+        fan = nextFanningVertex(candidates, live, stamps, time, deadEnds, cursor);
+    }
+
+    return indices;
+}
+
+//---
+
+// . SIMD lanes : AVX, SSE or a single scalar lane, the face kernels are written once on top of them
+#if defined(__AVX__)
+struct Lanes_t
+{
+    static constexpr uint32_t sWidth = 8u;
+    __m256                    v;
+
+    static Lanes_t load(float const *p) { return {_mm256_load_ps(p)}; }
+    void           store(float *p) const { _mm256_store_ps(p, v); }
+    friend Lanes_t operator+(Lanes_t a, Lanes_t b) { return {_mm256_add_ps(a.v, b.v)}; }
+    friend Lanes_t operator-(Lanes_t a, Lanes_t b) { return {_mm256_sub_ps(a.v, b.v)}; }
+    friend Lanes_t operator*(Lanes_t a, Lanes_t b) { return {_mm256_mul_ps(a.v, b.v)}; }
+};
+#elif defined(__SSE__) || defined(_M_X64)
+struct Lanes_t
+{
+    static constexpr uint32_t sWidth = 4u;
+    __m128                    v;
+
+    static Lanes_t load(float const *p) { return {_mm_load_ps(p)}; }
+    void           store(float *p) const { _mm_store_ps(p, v); }
+    friend Lanes_t operator+(Lanes_t a, Lanes_t b) { return {_mm_add_ps(a.v, b.v)}; }
+    friend Lanes_t operator-(Lanes_t a, Lanes_t b) { return {_mm_sub_ps(a.v, b.v)}; }
+    friend Lanes_t operator*(Lanes_t a, Lanes_t b) { return {_mm_mul_ps(a.v, b.v)}; }
+};
+#else
+struct Lanes_t
+{
+    static constexpr uint32_t sWidth = 1u;
+    float                     v;
+
+    static Lanes_t load(float const *p) { return {*p}; }
+    void           store(float *p) const { *p = v; }
+    friend Lanes_t operator+(Lanes_t a, Lanes_t b) { return {a.v + b.v}; }
+    friend Lanes_t operator-(Lanes_t a, Lanes_t b) { return {a.v - b.v}; }
+    friend Lanes_t operator*(Lanes_t a, Lanes_t b) { return {a.v * b.v}; }
+};
+#endif
+
+// . Triangle corners as SoA rows, a block of triangles at a time : every row loads as whole registers
+//   Sized for L1, and a multiple of any width : the last registers of a short block read padding
+constexpr size_t sCornerBlock = 256u;
+
+template <uint32_t Rows>
+struct Corners_t
+{
+    alignas(32) float rows[Rows][sCornerBlock] = {};
+};
+
+struct Lanes3_t
+{
+    Lanes_t x, y, z;
+
+    friend Lanes3_t operator-(Lanes3_t const &a, Lanes3_t const &b) { return {a.x - b.x, a.y - b.y, a.z - b.z}; }
+    friend Lanes3_t operator*(Lanes3_t const &a, Lanes_t s) { return {a.x * s, a.y * s, a.z * s}; }
+
+    template <uint32_t Rows>
+    static Lanes3_t load(Corners_t<Rows> const &block, uint32_t row, size_t l)
+    {
+        auto const *r = &block.rows[row][l];
+        return {Lanes_t::load(r), Lanes_t::load(r + sCornerBlock), Lanes_t::load(r + 2 * sCornerBlock)};
+    }
+    template <uint32_t Rows>
+    void store(Corners_t<Rows> &block, uint32_t row, size_t l) const
+    {
+        x.store(&block.rows[row][l]);
+        y.store(&block.rows[row + 1][l]);
+        z.store(&block.rows[row + 2][l]);
+    }
+};
+
+Lanes3_t cross(Lanes3_t const &a, Lanes3_t const &b)
+{
+    return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x};
+}
+
+// . Row 'row + k * dims + d' : float 'd' of the attribute at byte 'offset' of Vertex_t, on corner 'k' of the
+//   triangles [first, first + count). AVX2 gathers 8 triangles at a time in hardware : the corner's indices, 3
+//   apart, then its floats, a vertex apart
+template <uint32_t Rows>
+void gatherCorners(
+    MeshData_t const &mesh, size_t first, size_t count, size_t offset, uint32_t dims, uint32_t row, Corners_t<Rows> &out)
+{
+    auto const *indices = mesh.indices.data() + first * 3;
+    auto const *base    = reinterpret_cast<char const *>(mesh.vertices.data()) + offset;
+
+    size_t t = 0u;
+#if defined(__AVX2__)
+    if (mesh.vertices.size() * sizeof(Vertex_t) <= size_t{INT32_MAX})
+    {
+        auto const corners = _mm256_setr_epi32(0, 3, 6, 9, 12, 15, 18, 21);
+        auto const stride  = _mm256_set1_epi32(static_cast<int>(sizeof(Vertex_t)));
+        for (; t + 8 <= count; t += 8)
+        {
+            for (uint32_t k = 0; k < 3; ++k)
+            {
+                auto const idx = _mm256_i32gather_epi32(reinterpret_cast<int const *>(indices + t * 3 + k), corners, 4);
+                auto const at  = _mm256_mullo_epi32(idx, stride);
+                for (uint32_t d = 0; d < dims; ++d)
+                {
+                    auto const *src = reinterpret_cast<float const *>(base + d * sizeof(float));
+                    _mm256_store_ps(&out.rows[row + k * dims + d][t], _mm256_i32gather_ps(src, at, 1));
+                }
+            }
+        }
+    }
+#endif
+    for (; t < count; ++t)
+    {
+        for (uint32_t k = 0; k < 3; ++k)
+        {
+            auto const *src = reinterpret_cast<float const *>(base + size_t{indices[t * 3 + k]} * sizeof(Vertex_t));
+            for (uint32_t d = 0; d < dims; ++d)
+                out.rows[row + k * dims + d][t] = src[d];
+        }
+    }
+}
+
+//---
+
+// . Splits [0, count) in chunks, across the worker threads or inline (when the caller already is one)
+void forChunks(size_t count, bool parallel, std::function<void(size_t, size_t)> const &fn)
+{
+    constexpr size_t sChunkSize = 16384u;
+
+    auto const chunks = (count + sChunkSize - 1) / sChunkSize;
+    auto const chunk  = [&](size_t c) { fn(c * sChunkSize, std::min(count, (c + 1) * sChunkSize)); };
+    if (parallel)
+        vo::jobs::parallelFor(chunks, chunk);
+    else
+        for (size_t c = 0; c < chunks; ++c)
+            chunk(c);
+}
+
+//---
+
+// . Area-weighted face normals (the cross product is not normalized) of triangles [first, last)
+void faceNormals(MeshData_t const &mesh, size_t first, size_t last, glm::vec3 *out)
+{
+    constexpr auto W = Lanes_t::sWidth;
+    Corners_t<9u>  in;
+    Corners_t<3u>  res;
+    for (size_t base = first; base < last; base += sCornerBlock)
+    {
+        auto const count = std::min(sCornerBlock, last - base);
+        gatherCorners(mesh, base, count, offsetof(Vertex_t, vertex), 3u, 0u, in);
+
+        for (size_t l = 0; l < count; l += W)
+        {
+            auto const a = Lanes3_t::load(in, 0, l);
+            cross(Lanes3_t::load(in, 3, l) - a, Lanes3_t::load(in, 6, l) - a).store(res, 0, l);
+        }
+        for (size_t l = 0; l < count; ++l)
+            out[base + l] = glm::vec3(res.rows[0][l], res.rows[1][l], res.rows[2][l]);
+    }
+}
+
+//---
+
+// . MikkTSpace face frames of triangles [first, last) : the uv-space derivatives, oriented by the sign
+//   of the uv area (scaled by it, which keeps the direction and avoids the division)
+void faceTangents(MeshData_t const &mesh, size_t first, size_t last, glm::vec3 *outT, glm::vec3 *outB)
+{
+    constexpr auto W = Lanes_t::sWidth;
+    Corners_t<15u> in;
+    Corners_t<6u>  res;
+    for (size_t base = first; base < last; base += sCornerBlock)
+    {
+        auto const count = std::min(sCornerBlock, last - base);
+        gatherCorners(mesh, base, count, offsetof(Vertex_t, vertex), 3u, 0u, in);
+        gatherCorners(mesh, base, count, offsetof(Vertex_t, uv), 2u, 9u, in);
+
+        for (size_t l = 0; l < count; l += W)
+        {
+            auto const a     = Lanes3_t::load(in, 0, l);
+            auto const e1    = Lanes3_t::load(in, 3, l) - a;
+            auto const e2    = Lanes3_t::load(in, 6, l) - a;
+            auto const lanes = [&](uint32_t row) { return Lanes_t::load(&in.rows[row][l]); };
+            auto const s1    = lanes(11) - lanes(9);
+            auto const t1    = lanes(12) - lanes(10);
+            auto const s2    = lanes(13) - lanes(9);
+            auto const t2    = lanes(14) - lanes(10);
+            auto const r     = s1 * t2 - s2 * t1;
+            ((e1 * t2 - e2 * t1) * r).store(res, 0, l);
+            ((e2 * s1 - e1 * s2) * r).store(res, 3, l);
+        }
+        for (size_t l = 0; l < count; ++l)
+        {
+            outT[base + l] = glm::vec3(res.rows[0][l], res.rows[1][l], res.rows[2][l]);
+            outB[base + l] = glm::vec3(res.rows[3][l], res.rows[4][l], res.rows[5][l]);
+        }
+    }
+}
+
+//---
+
+// . Angle of triangle 't' at its corner 'v'
+float cornerAngle(MeshData_t const &mesh, uint32_t t, uint32_t v)
+{
+    auto const *tri = &mesh.indices[t * 3];
+    auto const  k   = tri[0] == v ? 0u : (tri[1] == v ? 1u : 2u);
+    auto const &p   = mesh.vertices[tri[k]].vertex;
+    auto const  e0  = mesh.vertices[tri[(k + 1) % 3]].vertex - p;
+    auto const  e1  = mesh.vertices[tri[(k + 2) % 3]].vertex - p;
+    auto const  len = glm::length(e0) * glm::length(e1);
+    if (len <= 0.f)
+        return 0.f;
+    return std::acos(std::clamp(glm::dot(e0, e1) / len, -1.f, 1.f));
+}
+
+//---
+
+// . Any unit vector orthogonal to 'n', for the vertices without a usable uv frame
+glm::vec3 anyTangent(glm::vec3 const &n)
+{
+    auto const axis = std::abs(n.x) < 0.9f ? glm::vec3(1.f, 0.f, 0.f) : glm::vec3(0.f, 1.f, 0.f);
+    return glm::normalize(axis - n * glm::dot(n, axis));
+}
+
+//---
+
+void logMetrics(char const *stage, MeshMetrics_t const &m, bool overdraw = true)
+{
+    if (overdraw)
+        LogInfof("  {:<14} -> acmr:{:.3f} overdraw:{:.3f} triangles:{}", stage, m.acmr(), m.overdraw(), m.triangles);
+    else
+        LogInfof("  {:<14} -> acmr:{:.3f} triangles:{}", stage, m.acmr(), m.triangles);
+}
+
+//---
+
+// . Added up over all the meshes, measured on the worker threads
+MeshMetrics_t analyzeMeshes(std::vector<MeshData_t> const &meshes, bool overdraw)
+{
+    std::vector<MeshMetrics_t> perMesh(meshes.size());
+    vo::jobs::parallelFor(meshes.size(), [&](size_t i) { perMesh[i] = analyzeMesh(meshes[i], overdraw); });
+
+    MeshMetrics_t total;
+    for (auto const &m : perMesh)
+    {
+        total.triangles += m.triangles;
+        total.cacheMisses += m.cacheMisses;
+        total.pixelsShaded += m.pixelsShaded;
+        total.pixelsCovered += m.pixelsCovered;
+    }
+    return total;
+}
+
+//---
+
+// . Weighted squared distances to a set of planes : p'Ap + 2b'p + c, 'A' symmetric
+struct Quadric_t
+{
+    std::array<double, 10> m      = {}; // a00 a01 a02 a11 a12 a22 b0 b1 b2 c
+    double                 weight = 0.;
+
+    // . Plane 'dot(n, p) + d = 0', 'n' normalized
+    static Quadric_t plane(glm::vec3 const &n, float d, double w)
+    {
+        Quadric_t q;
+        q.m = {n.x * n.x, n.x * n.y, n.x * n.z, n.y * n.y, n.y * n.z, n.z * n.z, n.x * d, n.y * d, n.z * d, d * d};
+        for (auto &v : q.m)
+            v *= w;
+        q.weight = w;
+        return q;
+    }
+
+    void add(Quadric_t const &o)
+    {
+        for (size_t i = 0; i < m.size(); ++i)
+            m[i] += o.m[i];
+        weight += o.weight;
+    }
+
+    // . Mean squared distance at 'p'
+    double error(glm::vec3 const &p) const
+    {
+        double const x = p.x, y = p.y, z = p.z;
+        double const e = m[0] * x * x + m[3] * y * y + m[5] * z * z + 2. * (m[1] * x * y + m[2] * x * z + m[4] * y * z)
+                       + 2. * (m[6] * x + m[7] * y + m[8] * z) + m[9];
+        return weight > 0. ? std::max(e, 0.) / weight : 0.;
+    }
+};
+
+//---
+
+// . What a vertex may do in a collapse : 'Border' ones only slide along their border, 'Locked' ones stay
+//   (uv / normal seams, non-manifold edges)
+enum class VertexKind_t : uint8_t
+{
+    Free,
+    Border,
+    Locked,
+};
+
+inline uint64_t edgeKey(uint32_t a, uint32_t b)
+{
+    return a < b ? (uint64_t(a) << 32) | b : (uint64_t(b) << 32) | a;
+}
+
+//---
+
+// . Edge collapses onto existing vertices, the cheapest quadric error first. In passes : the candidates are sorted
+//   once and the ones with no neighbour in common are taken, until 'targetTriangles' or nothing else can go
+std::vector<uint32_t> collapseEdges(
+    std::vector<uint32_t> const &input,
+    std::vector<Vertex_t> const &vertices,
+    size_t                       targetTriangles,
+    float                       &outError)
+{
+    auto const vertexCount = vertices.size();
+    auto const position    = [&vertices](uint32_t v) { return vertices[v].vertex; };
+
+    // . Welded by position : the surface collapses as one, the vertices split by their attributes are locked
+    std::unordered_map<std::string_view, uint32_t> unique;
+    unique.reserve(vertexCount);
+    std::vector<uint32_t> welded(vertexCount);
+    std::vector<uint32_t> copies(vertexCount, 0u);
+    for (size_t v = 0; v < vertexCount; ++v)
+    {
+        auto const key = std::string_view(reinterpret_cast<char const *>(&vertices[v].vertex), sizeof(glm::vec3));
+        welded[v]      = unique.emplace(key, static_cast<uint32_t>(v)).first->second;
+        ++copies[welded[v]];
+    }
+
+    std::vector<uint32_t>                  indices = input;
+    std::unordered_map<uint64_t, uint32_t> edgeUses;
+    auto const                             countEdges = [&]() {
+        edgeUses.clear();
+        for (size_t i = 0; i < indices.size(); i += 3)
+            for (uint32_t k = 0; k < 3; ++k)
+                ++edgeUses[edgeKey(welded[indices[i + k]], welded[indices[i + (k + 1) % 3]])];
+    };
+    countEdges();
+
+    std::vector<VertexKind_t> kinds(vertexCount, VertexKind_t::Free);
+    for (size_t v = 0; v < vertexCount; ++v)
+        if (copies[v] > 1)
+            kinds[v] = VertexKind_t::Locked;
+    for (auto const &[key, uses] : edgeUses)
+    {
+        for (auto const v : {uint32_t(key >> 32), uint32_t(key)})
+        {
+            if (uses > 2)
+                kinds[v] = VertexKind_t::Locked;
+            else if (uses == 1 && kinds[v] == VertexKind_t::Free)
+                kinds[v] = VertexKind_t::Border;
+        }
+    }
+
+    // . Quadrics : the planes of the faces around, weighted by area, plus the borders perpendicular to them
+    std::vector<Quadric_t> quadrics(vertexCount);
+    for (size_t i = 0; i < indices.size(); i += 3)
+    {
+        uint32_t const w[3] = {welded[indices[i]], welded[indices[i + 1]], welded[indices[i + 2]]};
+        auto const     p0   = position(w[0]);
+        auto           n    = glm::cross(position(w[1]) - p0, position(w[2]) - p0);
+        auto const     area = glm::length(n);
+        if (area <= 0.f)
+            continue;
+        n /= area;
+
+        auto const face = Quadric_t::plane(n, -glm::dot(n, p0), area * 0.5);
+        for (auto const v : w)
+            quadrics[v].add(face);
+
+        for (uint32_t k = 0; k < 3; ++k)
+        {
+            auto const a = w[k], b = w[(k + 1) % 3];
+            auto const edge = position(b) - position(a);
+            auto const len  = glm::length(edge);
+            if (edgeUses[edgeKey(a, b)] != 1 || len <= 0.f)
+                continue;
+            auto const side   = glm::cross(edge, n) / len;
+            auto const border = Quadric_t::plane(side, -glm::dot(side, position(a)), double(len) * len);
+            quadrics[a].add(border);
+            quadrics[b].add(border);
+        }
+    }
+
+    struct Collapse_t
+    {
+        uint32_t from;
+        uint32_t to;
+        double   cost;
+    };
+    std::vector<Collapse_t> collapses;
+    std::vector<uint32_t>   weldedIndices;
+    std::vector<uint32_t>   collapseTo(vertexCount);
+    std::vector<bool>       touched(vertexCount);
+
+    double maxCost   = 0.;
+    size_t triangles = indices.size() / 3;
+    while (triangles > targetTriangles)
+    {
+        weldedIndices.resize(indices.size());
+        for (size_t i = 0; i < indices.size(); ++i)
+            weldedIndices[i] = welded[indices[i]];
+        Adjacency_t adjacency(weldedIndices, vertexCount);
+
+        // . Candidates : both ways of every edge, when the source can move that way. Movable sources have
+        //   a single copy, so they are their own welded vertex
+        collapses.clear();
+        for (size_t i = 0; i < indices.size(); i += 3)
+        {
+            for (uint32_t k = 0; k < 3; ++k)
+            {
+                auto const a = indices[i + k], b = indices[i + (k + 1) % 3];
+                for (auto const &[from, to] : {std::pair{a, b}, std::pair{b, a}})
+                {
+                    auto const wf = welded[from], wt = welded[to];
+                    if (kinds[wf] == VertexKind_t::Locked)
+                        continue;
+                    if (kinds[wf] == VertexKind_t::Border
+                        && (kinds[wt] == VertexKind_t::Free || edgeUses[edgeKey(wf, wt)] != 1))
+                        continue;
+                    auto q = quadrics[wf];
+                    q.add(quadrics[wt]);
+                    collapses.push_back({from, to, q.error(position(wt))});
+                }
+            }
+        }
+        std::sort(collapses.begin(), collapses.end(), [](auto const &x, auto const &y) {
+            return x.cost != y.cost ? x.cost < y.cost : x.from < y.from;
+        });
+
+        for (size_t v = 0; v < vertexCount; ++v)
+            collapseTo[v] = static_cast<uint32_t>(v);
+        std::fill(touched.begin(), touched.end(), false);
+
+        size_t applied = 0u;
+        for (auto const &c : collapses)
+        {
+            if (triangles <= targetTriangles)
+                break;
+            auto const wf = c.from, wt = welded[c.to];
+            if (touched[wf] || touched[wt])
+                continue;
+
+            // . Around the source : the triangles on the edge go away, the others must not flip
+            size_t     removed = 0u;
+            bool       flips   = false;
+            auto const target  = position(wt);
+            for (auto a = adjacency.offsets[wf]; a < adjacency.offsets[wf + 1] && !flips; ++a)
+            {
+                auto const *tri = &weldedIndices[adjacency.triangles[a] * 3];
+                if (tri[0] == wt || tri[1] == wt || tri[2] == wt)
+                {
+                    ++removed;
+                    continue;
+                }
+                glm::vec3 p[3], q[3];
+                for (uint32_t k = 0; k < 3; ++k)
+                {
+                    p[k] = position(tri[k]);
+                    q[k] = tri[k] == wf ? target : p[k];
+                }
+                flips = glm::dot(glm::cross(p[1] - p[0], p[2] - p[0]), glm::cross(q[1] - q[0], q[2] - q[0])) <= 0.f;
+            }
+            if (flips)
+                continue;
+
+            collapseTo[wf] = c.to;
+            quadrics[wt].add(quadrics[wf]);
+            for (auto a = adjacency.offsets[wf]; a < adjacency.offsets[wf + 1]; ++a)
+                for (uint32_t k = 0; k < 3; ++k)
+                    touched[weldedIndices[adjacency.triangles[a] * 3 + k]] = true;
+            triangles -= removed;
+            maxCost = std::max(maxCost, c.cost);
+            ++applied;
+        }
+        if (applied < 1)
+            break;
+
+        // . Rewrite, without the triangles left degenerate
+        size_t count = 0u;
+        for (size_t i = 0; i < indices.size(); i += 3)
+        {
+            uint32_t const t[3] = {collapseTo[indices[i]], collapseTo[indices[i + 1]], collapseTo[indices[i + 2]]};
+            if (welded[t[0]] == welded[t[1]] || welded[t[1]] == welded[t[2]] || welded[t[0]] == welded[t[2]])
+                continue;
+            for (uint32_t k = 0; k < 3; ++k)
+                indices[count++] = t[k];
+        }
+        indices.resize(count);
+        triangles = count / 3;
+        countEdges();
+    }
+
+    outError = static_cast<float>(std::sqrt(maxCost));
+    return indices;
+}
+} // namespace
+
+//-------------------------------------
+
+//=============================================================================
+
+// === METRICs
+
+//-------------------------------------
+
+MeshMetrics_t analyzeMesh(MeshData_t const &mesh, bool overdraw)
+{
+    MeshMetrics_t metrics;
+    metrics.triangles = mesh.indices.size() / 3;
+
+    // . ACMR
+    CacheSim_t cache(mesh.vertices.size());
+    for (size_t t = 0; t + 2 < mesh.indices.size(); t += 3)
+        metrics.cacheMisses += cache.triangle(&mesh.indices[t]);
+
+    // . Overdraw : bounds mapped to the grid, then one raster per axis and direction
+    if (!overdraw)
+        return metrics;
+    constexpr uint32_t sRes = 256u;
+    glm::vec3          lo(FLT_MAX), hi(-FLT_MAX);
+    for (auto const &v : mesh.vertices)
+    {
+        lo = glm::min(lo, v.vertex);
+        hi = glm::max(hi, v.vertex);
+    }
+    auto const extent = glm::compMax(hi - lo);
+    if (extent <= 0.f)
+        return metrics;
+    auto const scale = float(sRes - 1) / extent;
+
+    std::vector<glm::vec3> points(mesh.vertices.size());
+    for (uint32_t axis = 0; axis < 3; ++axis)
+    {
+        for (float const sign : {1.f, -1.f})
+        {
+            for (size_t i = 0; i < points.size(); ++i)
+            {
+                auto const p = (mesh.vertices[i].vertex - lo) * scale;
+                auto const u = p[(axis + 1) % 3];
+                auto const w = p[(axis + 2) % 3];
+                // . Looking the other way : mirror one axis so the winding keeps meaning front
+                points[i] = sign > 0.f ? glm::vec3(u, w, -p[axis]) : glm::vec3(float(sRes - 1) - u, w, p[axis]);
+            }
+            rasterize<sRes>(points, mesh.indices, metrics);
+        }
+    }
+
+    return metrics;
+}
+
+//-------------------------------------
+
+//=============================================================================
+
+// === PASSes
+
+//-------------------------------------
+
+void deduplicateVertices(MeshData_t &mesh)
+{
+    // . Keyed by the raw bytes : Vertex_t is tightly packed floats
+    std::unordered_map<std::string_view, uint32_t> unique;
+    unique.reserve(mesh.vertices.size());
+
+    std::vector<uint32_t> remap(mesh.vertices.size());
+    std::vector<Vertex_t> vertices;
+    vertices.reserve(mesh.vertices.size());
+
+    for (size_t i = 0; i < mesh.vertices.size(); ++i)
+    {
+        auto const key      = std::string_view(reinterpret_cast<char const *>(&mesh.vertices[i]), sizeof(Vertex_t));
+        auto const [it, ok] = unique.emplace(key, GetCountU32(vertices));
+        if (ok)
+            vertices.push_back(mesh.vertices[i]);
+        remap[i] = it->second;
+    }
+
+    for (auto &idx : mesh.indices)
+        idx = remap[idx];
+    mesh.vertices = std::move(vertices);
+}
+
+//-------------------------------------
+
+void optimizeVertexCache(MeshData_t &mesh)
+{
+    mesh.indices = tipsify(mesh.indices, mesh.vertices.size());
+}
+
+//-------------------------------------
+
+void optimizeOverdraw(MeshData_t &mesh, float threshold)
+{
+    auto const triangleCount = mesh.indices.size() / 3;
+    if (triangleCount < 2)
+        return;
+
+    // . Hard boundaries : triangles with 3 misses, the cache order restarts there anyway
+    std::vector<uint32_t> misses(triangleCount);
+    {
+        CacheSim_t cache(mesh.vertices.size());
+        for (size_t t = 0; t < triangleCount; ++t)
+            misses[t] = cache.triangle(&mesh.indices[t * 3]);
+    }
+    std::vector<size_t> hard = {0u};
+    for (size_t t = 1; t < triangleCount; ++t)
+    {
+        if (misses[t] == 3)
+            hard.push_back(t);
+    }
+    hard.push_back(triangleCount);
+
+    // . Soft boundaries : split a hard cluster wherever its running ACMR is within 'threshold' of the whole one
+    std::vector<size_t> bounds;
+    CacheSim_t          cache(mesh.vertices.size());
+    for (size_t h = 0; h + 1 < hard.size(); ++h)
+    {
+        uint64_t clusterMisses = 0u;
+        for (auto t = hard[h]; t < hard[h + 1]; ++t)
+            clusterMisses += misses[t];
+        auto const limit = float(clusterMisses) / float(hard[h + 1] - hard[h]) * threshold;
+
+        cache.flush();
+        uint64_t running = 0u;
+        auto     start   = hard[h];
+        bounds.push_back(start);
+        for (auto t = hard[h]; t < hard[h + 1]; ++t)
+        {
+            running += cache.triangle(&mesh.indices[t * 3]);
+            if (t + 1 < hard[h + 1] && float(running) <= float(t - start + 1) * limit)
+            {
+                start   = t + 1;
+                running = 0u;
+                cache.flush();
+                bounds.push_back(start);
+            }
+        }
+    }
+    bounds.push_back(triangleCount);
+
+    // . Sort key : clusters far from the center and facing away from it go first (they occlude the rest)
+    glm::vec3 meshCenter(0.f);
+    for (auto const &v : mesh.vertices)
+        meshCenter += v.vertex;
+    meshCenter /= float(std::max<size_t>(mesh.vertices.size(), 1u));
+
+    struct Cluster_t
+    {
+        size_t begin, end;
+        float  key;
+    };
+    std::vector<Cluster_t> clusters;
+    clusters.reserve(bounds.size() - 1);
+    for (size_t c = 0; c + 1 < bounds.size(); ++c)
+    {
+        glm::vec3 center(0.f), normal(0.f);
+        float     area = 0.f;
+        for (auto t = bounds[c]; t < bounds[c + 1]; ++t)
+        {
+            auto const &a     = mesh.vertices[mesh.indices[t * 3]].vertex;
+            auto const &b     = mesh.vertices[mesh.indices[t * 3 + 1]].vertex;
+            auto const &d     = mesh.vertices[mesh.indices[t * 3 + 2]].vertex;
+            auto const  cross = glm::cross(b - a, d - a);
+            auto const  len   = glm::length(cross);
+            center += (a + b + d) / 3.f * len;
+            normal += cross;
+            area += len;
+        }
+        if (area > 0.f)
+            center /= area;
+        auto const n = glm::length(normal) > 0.f ? glm::normalize(normal) : glm::vec3(0.f);
+        clusters.push_back({bounds[c], bounds[c + 1], glm::dot(center - meshCenter, n)});
+    }
+    std::stable_sort(clusters.begin(), clusters.end(), [](auto const &a, auto const &b) { return a.key > b.key; });
+
+    std::vector<uint32_t> indices;
+    indices.reserve(mesh.indices.size());
+    for (auto const &c : clusters)
+        indices.insert(indices.end(), mesh.indices.begin() + c.begin * 3, mesh.indices.begin() + c.end * 3);
+    mesh.indices = std::move(indices);
+}
+
+//-------------------------------------
+
+void optimizeVertexFetch(MeshData_t &mesh)
+{
+    std::vector<uint32_t> remap(mesh.vertices.size(), UINT32_MAX);
+    std::vector<Vertex_t> vertices;
+    vertices.reserve(mesh.vertices.size());
+
+    for (auto &idx : mesh.indices)
+    {
+        if (remap[idx] == UINT32_MAX)
+        {
+            remap[idx] = GetCountU32(vertices);
+            vertices.push_back(mesh.vertices[idx]);
+        }
+        idx = remap[idx];
+    }
+    mesh.vertices = std::move(vertices);
+}
+
+//-------------------------------------
+
+void optimizeMeshes(std::vector<MeshData_t> &meshes, uint32_t level, bool passOverdraw)
+{
+    using Pass_t = void (*)(MeshData_t &);
+    static std::array<std::pair<char const *, Pass_t>, 4> const sPasses = {{
+        {"deduplicate", deduplicateVertices},
+        {"vertex cache", optimizeVertexCache},
+        {"overdraw", [](MeshData_t &m) { optimizeOverdraw(m); }},
+        {"vertex fetch", optimizeVertexFetch},
+    }};
+
+    auto const passCount = std::min<size_t>(level, sPasses.size());
+    if (passCount < 1 || meshes.empty())
+        return;
+
+    auto const measure = [&meshes](bool overdraw) { return analyzeMeshes(meshes, overdraw); };
+    LogInfof("MESH OPTIMIZATION -> level {} on {} meshes", level, meshes.size());
+    logMetrics("input", measure(true));
+    for (size_t p = 0; p < passCount; ++p)
+    {
+        auto const &[name, pass] = sPasses[p];
+        vo::jobs::parallelFor(meshes.size(), [&, pass = pass](size_t i) { pass(meshes[i]); });
+        bool const overdraw = passOverdraw || p + 1 == passCount;
+        logMetrics(name, measure(overdraw), overdraw);
+    }
+}
+
+//-------------------------------------
+
+//=============================================================================
+
+// === GENERATION
+
+//-------------------------------------
+
+void generateNormals(MeshData_t &mesh, bool threaded)
+{
+    auto const vertexCount   = mesh.vertices.size();
+    auto const triangleCount = mesh.indices.size() / 3;
+    if (triangleCount < 1)
+        return;
+
+    // . Smooth across uv and material seams : vertices at the same position share the normal
+    std::unordered_map<std::string_view, uint32_t> unique;
+    unique.reserve(vertexCount);
+    std::vector<uint32_t> welded(vertexCount);
+    for (size_t v = 0; v < vertexCount; ++v)
+    {
+        auto const key = std::string_view(reinterpret_cast<char const *>(&mesh.vertices[v].vertex), sizeof(glm::vec3));
+        welded[v]      = unique.emplace(key, static_cast<uint32_t>(v)).first->second;
+    }
+    std::vector<uint32_t> weldedIndices(mesh.indices.size());
+    for (size_t i = 0; i < mesh.indices.size(); ++i)
+        weldedIndices[i] = welded[mesh.indices[i]];
+    Adjacency_t adjacency(weldedIndices, vertexCount);
+
+    std::vector<glm::vec3> faces(triangleCount);
+    forChunks(triangleCount, threaded, [&](size_t first, size_t last) { faceNormals(mesh, first, last, faces.data()); });
+
+    forChunks(vertexCount, threaded, [&](size_t first, size_t last) {
+        for (size_t v = first; v < last; ++v)
+        {
+            auto const w = welded[v];
+            glm::vec3  n(0.f);
+            for (auto i = adjacency.offsets[w]; i < adjacency.offsets[w + 1]; ++i)
+                n += faces[adjacency.triangles[i]];
+
+            auto const len          = glm::length(n);
+            mesh.vertices[v].normal = len > 0.f ? n / len : glm::vec3(0.f, 0.f, 1.f);
+        }
+    });
+}
+
+//-------------------------------------
+
+void generateUVs(MeshData_t &mesh, bool threaded)
+{
+    glm::vec3 lo(FLT_MAX), hi(-FLT_MAX);
+    for (auto const &v : mesh.vertices)
+    {
+        lo = glm::min(lo, v.vertex);
+        hi = glm::max(hi, v.vertex);
+    }
+    auto const extent = glm::compMax(hi - lo);
+    if (extent <= 0.f)
+        return;
+    auto const scale = 1.f / extent;
+
+    // . Box projection : u goes right and v down, as seen from outside the bounds face
+    forChunks(mesh.vertices.size(), threaded, [&](size_t first, size_t last) {
+        for (size_t v = first; v < last; ++v)
+        {
+            auto      &vtx = mesh.vertices[v];
+            auto const n   = glm::abs(vtx.normal);
+            auto const p   = (vtx.vertex - lo) * scale;
+            if (n.x >= n.y && n.x >= n.z)
+                vtx.uv = glm::vec2(vtx.normal.x < 0.f ? p.z : 1.f - p.z, 1.f - p.y);
+            else if (n.y >= n.z)
+                vtx.uv = glm::vec2(p.x, vtx.normal.y < 0.f ? 1.f - p.z : p.z);
+            else
+                vtx.uv = glm::vec2(vtx.normal.z < 0.f ? 1.f - p.x : p.x, 1.f - p.y);
+        }
+    });
+}
+
+//-------------------------------------
+
+void generateTangents(MeshData_t &mesh, bool threaded)
+{
+    auto const vertexCount   = mesh.vertices.size();
+    auto const triangleCount = mesh.indices.size() / 3;
+    if (triangleCount < 1)
+        return;
+
+    Adjacency_t adjacency(mesh.indices, vertexCount);
+
+    std::vector<glm::vec3> faceT(triangleCount), faceB(triangleCount);
+    forChunks(triangleCount, threaded, [&](size_t first, size_t last) {
+        faceTangents(mesh, first, last, faceT.data(), faceB.data());
+    });
+
+    // . As MikkTSpace : face frames projected on the normal plane, normalized and weighted by the corner angle
+    forChunks(vertexCount, threaded, [&](size_t first, size_t last) {
+        for (size_t v = first; v < last; ++v)
+        {
+            auto      &vtx = mesh.vertices[v];
+            auto const n   = vtx.normal;
+            glm::vec3  t(0.f), b(0.f);
+            for (auto i = adjacency.offsets[v]; i < adjacency.offsets[v + 1]; ++i)
+            {
+                auto const f  = adjacency.triangles[i];
+                auto const ft = faceT[f] - n * glm::dot(n, faceT[f]);
+                auto const fb = faceB[f] - n * glm::dot(n, faceB[f]);
+                auto const lt = glm::length(ft);
+                auto const lb = glm::length(fb);
+                if (lt <= 0.f)
+                    continue;
+
+                auto const angle = cornerAngle(mesh, f, static_cast<uint32_t>(v));
+                t += ft * (angle / lt);
+                if (lb > 0.f)
+                    b += fb * (angle / lb);
+            }
+
+            // . The bitangent is rebuilt from the frame, only its handedness comes from the uvs
+            auto const len  = glm::length(t);
+            vtx.tangent     = len > 0.f ? t / len : anyTangent(n);
+            auto const side = glm::cross(n, vtx.tangent);
+            vtx.bitangent   = glm::dot(side, b) < 0.f ? -side : side;
+        }
+    });
+}
+
+//-------------------------------------
+
+void generateAttributes(std::vector<MeshData_t> &meshes, bool uvs, bool normals, bool tangents)
+{
+    if (!(uvs || normals || tangents) || meshes.empty())
+        return;
+
+    using Clock        = std::chrono::steady_clock;
+    using Milliseconds = std::chrono::duration<double, std::milli>;
+    auto const start   = Clock::now();
+
+    // . Normals first : the uv projection picks its plane from them, and the tangents are built around them
+    auto const generate = [&](MeshData_t &mesh, bool threaded) {
+        if (normals)
+            generateNormals(mesh, threaded);
+        if (uvs)
+            generateUVs(mesh, threaded);
+        if (tangents)
+            generateTangents(mesh, threaded);
+    };
+
+    // . Big meshes are chunked across the threads one after the other, the small ones go one per thread
+    constexpr size_t sBigMesh = 65536u; // Triangles
+
+    std::vector<size_t> small;
+    uint64_t            triangles = 0u;
+    for (size_t i = 0; i < meshes.size(); ++i)
+    {
+        auto const count = meshes[i].indices.size() / 3;
+        triangles += count;
+        if (count >= sBigMesh)
+            generate(meshes[i], true);
+        else
+            small.push_back(i);
+    }
+    vo::jobs::parallelFor(small.size(), [&](size_t i) { generate(meshes[small[i]], false); });
+
+    LogInfof(
+        "MESH GENERATION -> uvs:{} normals:{} tangents:{} on {} meshes, {} triangles : {:.1f}ms ({} lanes)",
+        uvs,
+        normals,
+        tangents,
+        meshes.size(),
+        triangles,
+        Milliseconds(Clock::now() - start).count(),
+        Lanes_t::sWidth);
+}
+
+//-------------------------------------
+
+//=============================================================================
+
+// === MESHLETs
+
+//-------------------------------------
+
+void buildMeshlets(MeshData_t &mesh, uint32_t maxVertices, uint32_t maxTriangles)
+{
+    mesh.meshlets.clear();
+    auto const triangleCount = mesh.indices.size() / 3;
+    if (triangleCount < 1)
+        return;
+
+    Adjacency_t            adjacency(mesh.indices, mesh.vertices.size());
+    std::vector<glm::vec3> faces(triangleCount);
+    faceNormals(mesh, 0, triangleCount, faces.data());
+
+    // . Stamped with the meshlet being built : its vertices, and the triangles already queued as candidates
+    uint32_t              meshlet = 0u;
+    std::vector<uint32_t> inMeshlet(mesh.vertices.size(), UINT32_MAX);
+    std::vector<uint32_t> queued(triangleCount, UINT32_MAX);
+    std::vector<bool>     emitted(triangleCount, false);
+
+    std::vector<uint32_t> order; // Triangles, meshlet after meshlet
+    std::vector<uint32_t> vertices;
+    std::vector<uint32_t> candidates;
+    order.reserve(triangleCount);
+    vertices.reserve(maxVertices);
+
+    size_t first  = 0u; // In 'order', of the meshlet being built
+    size_t cursor = 0u; // Next triangle in input order, to seed from when the candidates run out
+
+    auto const newVertices = [&](uint32_t t) {
+        uint32_t count = 0u;
+        for (uint32_t k = 0; k < 3; ++k)
+            count += inMeshlet[mesh.indices[t * 3 + k]] != meshlet;
+        return count;
+    };
+
+    auto const add = [&](uint32_t t) {
+        emitted[t] = true;
+        order.push_back(t);
+        for (uint32_t k = 0; k < 3; ++k)
+        {
+            auto const v = mesh.indices[t * 3 + k];
+            if (inMeshlet[v] == meshlet)
+                continue;
+            inMeshlet[v] = meshlet;
+            vertices.push_back(v);
+            for (auto i = adjacency.offsets[v]; i < adjacency.offsets[v + 1]; ++i)
+            {
+                auto const n = adjacency.triangles[i];
+                if (!emitted[n] && queued[n] != meshlet)
+                {
+                    queued[n] = meshlet;
+                    candidates.push_back(n);
+                }
+            }
+        }
+    };
+
+    auto const close = [&]() {
+        // . Its triangles back in input order : the vertex cache order of the optimization passes
+        std::sort(order.begin() + first, order.end());
+
+        Meshlet_t m;
+        m.firstIndex = static_cast<uint32_t>(first * 3);
+        m.indexCount = static_cast<uint32_t>((order.size() - first) * 3);
+
+        // . Sphere around the center of the bounds
+        glm::vec3 lo(FLT_MAX), hi(-FLT_MAX);
+        for (auto const v : vertices)
+        {
+            lo = glm::min(lo, mesh.vertices[v].vertex);
+            hi = glm::max(hi, mesh.vertices[v].vertex);
+        }
+        auto const center = (lo + hi) * 0.5f;
+        float      radius = 0.f;
+        for (auto const v : vertices)
+            radius = std::max(radius, glm::distance(center, mesh.vertices[v].vertex));
+        m.sphere = glm::vec4(center, radius);
+
+        // . Cone : the spread of the face normals widened by 90 degrees, 'sin(spread)' as the cutoff
+        //   Too wide (or no area at all) : 1, it can't pass the test
+        glm::vec3 axis(0.f);
+        for (auto i = first; i < order.size(); ++i)
+            if (auto const len = glm::length(faces[order[i]]); len > 0.f)
+                axis += faces[order[i]] / len;
+        float cutoff = 1.f;
+        if (auto const len = glm::length(axis); len > 0.f)
+        {
+            axis /= len;
+            float minDot = 1.f;
+            for (auto i = first; i < order.size(); ++i)
+                if (auto const l = glm::length(faces[order[i]]); l > 0.f)
+                    minDot = std::min(minDot, glm::dot(axis, faces[order[i]] / l));
+            if (minDot > 0.1f)
+                cutoff = std::sqrt(1.f - minDot * minDot);
+        }
+        m.cone = glm::vec4(axis, cutoff);
+        mesh.meshlets.push_back(m);
+
+        ++meshlet;
+        first = order.size();
+        vertices.clear();
+        candidates.clear();
+    };
+
+    while (order.size() < triangleCount)
+    {
+        // . Best candidate : the fewest new vertices, the earliest in the input (the optimized order) on ties
+        uint32_t best     = UINT32_MAX;
+        uint32_t bestCost = 4u;
+        size_t   live     = 0u;
+        for (size_t i = 0; i < candidates.size(); ++i)
+        {
+            auto const t = candidates[i];
+            if (emitted[t])
+                continue;
+            candidates[live++] = t;
+            if (auto const cost = newVertices(t); cost < bestCost || (cost == bestCost && t < best))
+            {
+                best     = t;
+                bestCost = cost;
+            }
+        }
+        candidates.resize(live);
+
+        // . Island done : continue on the input order
+        if (best == UINT32_MAX)
+        {
+            while (emitted[cursor])
+                ++cursor;
+            best     = static_cast<uint32_t>(cursor);
+            bestCost = newVertices(best);
+        }
+
+        // . Full : the triangle that didn't fit seeds the next one, next to this
+        if (vertices.size() + bestCost > maxVertices || order.size() - first >= maxTriangles)
+            close();
+        add(best);
+    }
+    close();
+
+    // . Meshlets in the order of their first triangle : the overdraw pass's cluster order, as far as they follow it
+    std::stable_sort(mesh.meshlets.begin(), mesh.meshlets.end(), [&order](Meshlet_t const &a, Meshlet_t const &b) {
+        return order[a.firstIndex / 3] < order[b.firstIndex / 3];
+    });
+    std::vector<uint32_t> indices;
+    indices.reserve(mesh.indices.size());
+    for (auto &m : mesh.meshlets)
+    {
+        auto const begin = m.firstIndex / 3;
+        m.firstIndex     = GetCountU32(indices);
+        for (auto i = begin; i < begin + m.indexCount / 3; ++i)
+        {
+            auto const t = order[i];
+            indices.insert(indices.end(), mesh.indices.begin() + t * 3, mesh.indices.begin() + t * 3 + 3);
+        }
+    }
+    mesh.indices = std::move(indices);
+}
+
+//-------------------------------------
+
+void buildMeshlets(std::vector<MeshData_t> &meshes)
+{
+    using Clock        = std::chrono::steady_clock;
+    using Milliseconds = std::chrono::duration<double, std::milli>;
+    auto const start   = Clock::now();
+
+    vo::jobs::parallelFor(meshes.size(), [&](size_t i) { buildMeshlets(meshes[i]); });
+
+    size_t   count     = 0u;
+    uint64_t triangles = 0u;
+    for (auto const &mesh : meshes)
+    {
+        count += mesh.meshlets.size();
+        triangles += mesh.indices.size() / 3;
+    }
+    LogInfof(
+        "MESHLETS -> {} on {} meshes, {:.1f} triangles each : {:.1f}ms",
+        count,
+        meshes.size(),
+        count ? double(triangles) / double(count) : 0.0,
+        Milliseconds(Clock::now() - start).count());
+}
+
+//-------------------------------------
+
+//=============================================================================
+
+// === LODs
+
+//-------------------------------------
+
+std::vector<uint32_t> simplifyMesh(MeshData_t const &mesh, float targetRatio, float *outError)
+{
+    auto const base = mesh.lods.empty() ? mesh.indices.size() : size_t{mesh.lods[0].indexCount};
+    std::vector<uint32_t> const input(mesh.indices.begin(), mesh.indices.begin() + base);
+
+    float      error   = 0.f;
+    auto const target  = static_cast<size_t>(double(input.size() / 3) * targetRatio);
+    auto       indices = collapseEdges(input, mesh.vertices, target, error);
+    if (outError)
+        *outError = error;
+    return indices;
+}
+
+//-------------------------------------
+
+void buildLods(MeshData_t &mesh, uint32_t maxLevels)
+{
+    // . Too few triangles left, or less than a quarter of them gone : not worth a level
+    constexpr size_t sMinTriangles = 64u;
+
+    mesh.lods.clear();
+    auto const vertexCount = mesh.vertices.size();
+    maxLevels              = std::min(maxLevels, sMaxMeshLods);
+
+    std::vector<MeshLod_t> lods = {{0u, GetCountU32(mesh.indices), 0.f}};
+    std::vector<uint32_t>  level(mesh.indices);
+    float                  error = 0.f;
+    while (lods.size() < maxLevels && level.size() / 3 >= sMinTriangles * 2)
+    {
+        // . Each level from the previous one : the deviations add up
+        float levelError = 0.f;
+        auto  next       = collapseEdges(level, mesh.vertices, level.size() / 6, levelError);
+        if (next.size() / 3 < sMinTriangles || next.size() * 4 > level.size() * 3)
+            break;
+        error += levelError;
+
+        next = tipsify(next, vertexCount);
+        lods.push_back({GetCountU32(mesh.indices), GetCountU32(next), error});
+        mesh.indices.insert(mesh.indices.end(), next.begin(), next.end());
+        level = std::move(next);
+    }
+    if (lods.size() > 1)
+        mesh.lods = std::move(lods);
+}
+
+//-------------------------------------
+
+void buildLods(std::vector<MeshData_t> &meshes, uint32_t maxLevels)
+{
+    using Clock        = std::chrono::steady_clock;
+    using Milliseconds = std::chrono::duration<double, std::milli>;
+    auto const start   = Clock::now();
+
+    vo::jobs::parallelFor(meshes.size(), [&](size_t i) { buildLods(meshes[i], maxLevels); });
+
+    size_t   levels    = 0u;
+    uint64_t triangles = 0u, coarsest = 0u;
+    for (auto const &mesh : meshes)
+    {
+        levels += std::max<size_t>(mesh.lods.size(), 1u);
+        triangles += (mesh.lods.empty() ? mesh.indices.size() : mesh.lods.front().indexCount) / 3;
+        coarsest += (mesh.lods.empty() ? mesh.indices.size() : mesh.lods.back().indexCount) / 3;
+    }
+    LogInfof(
+        "MESH LODs -> {} levels on {} meshes, {} triangles down to {} : {:.1f}ms",
+        levels,
+        meshes.size(),
+        triangles,
+        coarsest,
+        Milliseconds(Clock::now() - start).count());
+}
+
+//-------------------------------------
+
+//=============================================================================
+
+// === PIPELINE
+
+//-------------------------------------
+
+void prepareMeshes(
+    std::vector<MeshData_t> &meshes,
+    uint32_t                 optimizationLevel,
+    bool                     uvs,
+    bool                     normals,
+    bool                     tangents,
+    uint32_t                 lodLevels,
+    bool                     passOverdraw)
+{
+    // . Generate : before optimizing, so the deduplication sees the final attributes
+    generateAttributes(meshes, uvs, normals, tangents);
+
+    // . Optimize : dedup -> vertex cache -> overdraw -> vertex fetch, as many passes as the level says
+    optimizeMeshes(meshes, optimizationLevel, passOverdraw);
+
+    // . Meshlets : grown and laid out along the optimized order, so the first-use order of the vertices is redone
+    //   after them. What gets uploaded is measured there, before the LODs get appended
+    //   LODs : appended after the base level, over the same vertices
+    buildMeshlets(meshes);
+    if (optimizationLevel > 0 && !meshes.empty())
+        logMetrics("meshlets", analyzeMeshes(meshes, true));
+    if (lodLevels > 1)
+        buildLods(meshes, lodLevels);
+    if (optimizationLevel >= 4)
+        vo::jobs::parallelFor(meshes.size(), [&](size_t i) { optimizeVertexFetch(meshes[i]); });
+}
+
+//-------------------------------------
+
+//=============================================================================
+
+} // namespace vonk
@@ -0,0 +1,168 @@
+#include "VonkResidency.h"
+
+#include <algorithm>
+
+namespace vonk
+{ //
+
+//=============================================================================
+
+// === RESIDENCY
+
+//-------------------------------------
+
+Residency_t createResidency(uint32_t framesInFlight)
+{
+    Residency_t residency;
+    residency.framesInFlight = std::max(framesInFlight, 1u);
+    return residency;
+}
+
+//-------------------------------------
+
+void destroyResidency(Residency_t &residency) { residency = Residency_t{}; }
+
+//-------------------------------------
+
+uint32_t addResident(
+    Residency_t          &residency,
+    uint32_t              domain,
+    VkDeviceSize          bytes,
+    std::function<void()> evict,
+    std::function<void()> restore)
+{
+    Resident_t resident{
+        .domain   = domain,
+        .bytes    = bytes,
+        .lastUsed = residency.frame,
+        .resident = true,
+        .pinned   = residency.pinning,
+        .evict    = std::move(evict),
+        .restore  = std::move(restore),
+    };
+
+    if (!residency.freeSlots.empty())
+    {
+        auto const id = residency.freeSlots.back();
+        residency.freeSlots.pop_back();
+        residency.residents[id] = std::move(resident);
+        return id;
+    }
+
+    residency.residents.push_back(std::move(resident));
+    return GetCountU32(residency.residents) - 1;
+}
+
+//-------------------------------------
+
+void removeResident(Residency_t &residency, uint32_t id)
+{
+    if (id >= residency.residents.size())
+        return;
+
+    residency.residents[id] = Resident_t{};
+    residency.freeSlots.push_back(id);
+}
+
+//-------------------------------------
+
+void touchResident(Residency_t &residency, uint32_t id)
+{
+    if (id >= residency.residents.size())
+        return;
+
+    auto &resident    = residency.residents[id];
+    resident.lastUsed = residency.frame;
+    resident.pinned   = resident.pinned || residency.pinning;
+
+    if (!resident.resident)
+    {
+        // . Flagged before restoring : making room for it must not pick it
+        resident.resident = true;
+        resident.restore();
+        ++residency.restores;
+    }
+}
+
+//-------------------------------------
+
+void pinResident(Residency_t &residency, uint32_t id)
+{
+    if (id >= residency.residents.size())
+        return;
+
+    touchResident(residency, id);
+    residency.residents[id].pinned = true;
+}
+
+//-------------------------------------
+
+VkDeviceSize evictResidents(Residency_t &residency, uint32_t domain, VkDeviceSize bytes)
+{
+    // . Candidates : not pinned and not used by the frames in flight
+    std::vector<uint32_t> candidates;
+    for (uint32_t id = 0; id < residency.residents.size(); ++id)
+    {
+        auto const &r = residency.residents[id];
+        if (r.evict && r.resident && !r.pinned && r.domain == domain
+            && r.lastUsed + residency.framesInFlight <= residency.frame)
+            candidates.push_back(id);
+    }
+    std::sort(candidates.begin(), candidates.end(), [&](uint32_t a, uint32_t b) {
+        return residency.residents[a].lastUsed < residency.residents[b].lastUsed;
+    });
+
+    VkDeviceSize freed = 0u;
+    for (auto const id : candidates)
+    {
+        if (freed >= bytes)
+            break;
+
+        auto &resident    = residency.residents[id];
+        resident.resident = false;
+        resident.evict();
+        freed += resident.bytes;
+        ++residency.evictions;
+    }
+    return freed;
+}
+
+//-------------------------------------
+
+void updateResidency(Residency_t &residency, MemoryBudget_t const &budget)
+{
+    ++residency.frame;
+
+    for (uint32_t heap = 0; heap < budget.heapCount; ++heap)
+    {
+        auto const high = static_cast<VkDeviceSize>(budget.budget[heap] * Residency_t::sHighWatermark);
+        auto const low  = static_cast<VkDeviceSize>(budget.budget[heap] * Residency_t::sLowWatermark);
+        if (budget.usage[heap] > high)
+            evictResidents(residency, heap, budget.usage[heap] - low);
+    }
+}
+
+//-------------------------------------
+
+void logResidency(Residency_t const &residency, MemoryBudget_t const &budget)
+{
+    auto const evicted = std::count_if(
+        residency.residents.begin(), residency.residents.end(), [](auto const &r) { return r.evict && !r.resident; });
+    LogInfof(
+        "RESIDENCY -> residents:{} evicted:{} evictions:{} restores:{}",
+        residency.residents.size() - residency.freeSlots.size(),
+        evicted,
+        residency.evictions,
+        residency.restores);
+
+    for (uint32_t heap = 0; heap < budget.heapCount; ++heap)
+    {
+        LogInfof("  HEAP {} -> usage:{}MB budget:{}MB", heap, budget.usage[heap] >> 20, budget.budget[heap] >> 20);
+    }
+}
+
+//-------------------------------------
+
+//=============================================================================
+
+} // namespace vonk
@@ -149,8 +149,13 @@ Gpu_t pickGpu(Instance_t &instance, bool enableGraphics, bool enablePresent, boo
     // Get physical-device info
     gpu.handle = gpuHandle;
     vkGetPhysicalDeviceFeatures(gpu.handle, &gpu.features);
+    gpu.features12 = { .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES };
+    VkPhysicalDeviceFeatures2 features2 { .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2, .pNext = &gpu.features12 };
+    vkGetPhysicalDeviceFeatures2(gpu.handle, &features2);
+    gpu.features12.pNext = nullptr;
     vkGetPhysicalDeviceProperties(gpu.handle, &gpu.properties);
     vkGetPhysicalDeviceMemoryProperties(gpu.handle, &gpu.memory);
+    gpu.hostVisibleVram = vonk::hasHostVisibleVram(gpu.memory);
     gpu.surfSupp = vonk::getSurfaceSupport(gpu.handle, instance.surface);
 
     // Queues Indices
@@ -198,10 +203,15 @@ Gpu_t pickGpu(Instance_t &instance, bool enableGraphics, bool enablePresent, boo
       !(hasGraphics and gpu.queueFamily.present.has_value() and hasTransfer and hasCompute)  // @DANI review!!!
       or (gpu.surfSupp.presentModes.empty() or gpu.surfSupp.formats.empty())
       or !vonk::checkGpuExtensionsSupport(gpu)  //
+      or !gpu.features12.timelineSemaphore      //
     ) {
       return gpu;
     }
 
+    // Optional extensions
+    gpu.memoryBudget = vonk::checkGpuExtensionSupport(gpu.handle, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+    if (gpu.memoryBudget) { gpu.exts.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME); }
+
     // Get score from a valid gpu
     uint32_t const isDiscreteGPU = (gpu.properties.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU);
     uint32_t const score         = (1000 * isDiscreteGPU) + gpu.properties.limits.maxImageDimension2D;
@@ -250,9 +260,17 @@ Device_t createDevice(Instance_t const &instance, Gpu_t const &gpu)
     });
   }
 
+  // . Vulkan 1.2 features : just the ones in use
+  VkPhysicalDeviceVulkan12Features const features12 {
+    .sType             = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES,
+    .drawIndirectCount = gpu.features12.drawIndirectCount,
+    .timelineSemaphore = gpu.features12.timelineSemaphore,
+  };
+
   // . Device's Create Info
   VkDeviceCreateInfo const deviceCI {
     .sType                   = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
+    .pNext                   = &features12,
     .pEnabledFeatures        = &gpu.features,
     .queueCreateInfoCount    = GetCountU32(queueCIs),
     .pQueueCreateInfos       = GetData(queueCIs),
@@ -308,10 +326,11 @@ void destroyDevice(Device_t &device)
 
 //-------------------------------------
 
-VkCommandPool createCommandPool(Device_t const &device, uint32_t idx)
+VkCommandPool createCommandPool(Device_t const &device, uint32_t idx, VkCommandPoolCreateFlags flags)
 {
   VkCommandPoolCreateInfo const cmdPoolCI {
     .sType            = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+    .flags            = flags,
     .queueFamilyIndex = idx,
   };
   VkCommandPool cmdPool;
@@ -321,6 +340,74 @@ VkCommandPool createCommandPool(Device_t const &device, uint32_t idx)
 
 //-------------------------------------
 
+FrameCommands_t createFrameCommands(Device_t const &device, uint32_t workerCount)
+{
+  auto const      family = device.pGpu->queueFamily.graphics.value();
+  FrameCommands_t frame;
+  frame.pool = createCommandPool(device, family, VK_COMMAND_POOL_CREATE_TRANSIENT_BIT);
+  for (uint32_t i = 0; i < workerCount; ++i) {
+    frame.workerPools.push_back(createCommandPool(device, family, VK_COMMAND_POOL_CREATE_TRANSIENT_BIT));
+  }
+  frame.workerBuffers.resize(workerCount);
+
+  VkCommandBuffer                   buffers[3];
+  VkCommandBufferAllocateInfo const allocInfo {
+    .sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+    .commandPool        = frame.pool,
+    .level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+    .commandBufferCount = 3,
+  };
+  VkCheck(vkAllocateCommandBuffers(device.handle, &allocInfo, buffers));
+  frame.update = buffers[0];
+  frame.draw   = buffers[1];
+  frame.late   = buffers[2];
+  return frame;
+}
+
+//-------------------------------------
+
+void resetFrameCommands(Device_t const &device, FrameCommands_t &frame)
+{
+  VkCheck(vkResetCommandPool(device.handle, frame.pool, 0));
+  for (auto const pool : frame.workerPools) { VkCheck(vkResetCommandPool(device.handle, pool, 0)); }
+  frame.splitPasses = 0u;
+}
+
+//-------------------------------------
+
+std::vector<VkCommandBuffer> nextFrameSecondaries(VkDevice device, FrameCommands_t &frame)
+{
+  auto const                   pass = frame.splitPasses++;
+  std::vector<VkCommandBuffer> secondaries;
+  secondaries.reserve(frame.workerPools.size());
+  for (size_t i = 0; i < frame.workerPools.size(); ++i) {
+    auto &buffers = frame.workerBuffers[i];
+    if (buffers.size() <= pass) {
+      VkCommandBufferAllocateInfo const allocInfo {
+        .sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+        .commandPool        = frame.workerPools[i],
+        .level              = VK_COMMAND_BUFFER_LEVEL_SECONDARY,
+        .commandBufferCount = 1,
+      };
+      VkCheck(vkAllocateCommandBuffers(device, &allocInfo, &buffers.emplace_back()));
+    }
+    secondaries.push_back(buffers[pass]);
+  }
+  return secondaries;
+}
+
+//-------------------------------------
+
+void destroyFrameCommands(Device_t const &device, FrameCommands_t &frame)
+{
+  // . The buffers go with their pool
+  if (frame.pool) vkDestroyCommandPool(device.handle, frame.pool, nullptr);
+  for (auto const pool : frame.workerPools) { vkDestroyCommandPool(device.handle, pool, nullptr); }
+  frame = {};
+}
+
+//-------------------------------------
+
 //=============================================================================
 
 // === RENDER PASSes
@@ -426,6 +513,78 @@ VkRenderPass createDefaultRenderPass(VkDevice device, VkFormat colorFormat, VkFo
 
 //-------------------------------------
 
+VkRenderPass createLoadRenderPass(VkDevice device, VkFormat colorFormat, VkFormat depthFormat)
+{
+  // . As the default one, loading what it left instead of clearing : its framebuffers work with this one too
+  RenderPassData_t rpd;
+  rpd.attachments = {
+    {
+      .format         = colorFormat,
+      .samples        = VK_SAMPLE_COUNT_1_BIT,
+      .loadOp         = VK_ATTACHMENT_LOAD_OP_LOAD,
+      .storeOp        = VK_ATTACHMENT_STORE_OP_STORE,
+      .stencilLoadOp  = VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+      .stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
+      .initialLayout  = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+      .finalLayout    = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+    },
+    {
+      .format         = depthFormat,
+      .samples        = VK_SAMPLE_COUNT_1_BIT,
+      .loadOp         = VK_ATTACHMENT_LOAD_OP_LOAD,
+      .storeOp        = VK_ATTACHMENT_STORE_OP_STORE,
+      .stencilLoadOp  = VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+      .stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
+      .initialLayout  = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+      .finalLayout    = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+    },
+  };
+  rpd.attachmentRefs = {
+    {
+      .attachment = 0,
+      .layout     = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+    },
+    {
+      .attachment = 1,
+      .layout     = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+    },
+  };
+  rpd.subpassDescs = {
+    {
+      .pipelineBindPoint       = VK_PIPELINE_BIND_POINT_GRAPHICS,
+      .colorAttachmentCount    = 1,
+      .pColorAttachments       = &rpd.attachmentRefs[0],
+      .pDepthStencilAttachment = &rpd.attachmentRefs[1],
+    },
+  };
+  // . The color the previous pass wrote is loaded after it : the depth comes through its own barrier
+  auto const fragmentTests = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+  rpd.subpassDeps = {
+    {
+      .srcSubpass      = VK_SUBPASS_EXTERNAL,
+      .dstSubpass      = 0,
+      .srcStageMask    = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+      .dstStageMask    = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | fragmentTests,
+      .srcAccessMask   = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+      .dstAccessMask   = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+      .dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT,
+    },
+    {
+      .srcSubpass      = 0,
+      .dstSubpass      = VK_SUBPASS_EXTERNAL,
+      .srcStageMask    = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+      .dstStageMask    = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+      .srcAccessMask   = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+      .dstAccessMask   = VK_ACCESS_MEMORY_READ_BIT,
+      .dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT,
+    },
+  };
+
+  return vonk::createRenderPass(device, rpd);
+}
+
+//-------------------------------------
+
 //=============================================================================
 
 // === TEXTUREs
@@ -433,40 +592,38 @@ VkRenderPass createDefaultRenderPass(VkDevice device, VkFormat colorFormat, VkFo
 //-------------------------------------
 
 Texture_t createTexture(
-  VkDevice                                device,
-  VkPhysicalDeviceMemoryProperties const &memProps,
-  VkExtent2D const &                      extent2D,
-  VkFormat const &                        format,
-  VkSampleCountFlagBits const &           samples,
-  VkImageUsageFlags const &               usage,
-  VkImageAspectFlagBits const &           aspectMaskBits)
+  Device_t const &              device,
+  MemoryCategory_t              category,
+  VkExtent2D const &            extent2D,
+  VkFormat const &              format,
+  VkSampleCountFlagBits const & samples,
+  VkImageUsageFlags const &     usage,
+  VkImageAspectFlagBits const & aspectMaskBits)
 {
   Texture_t tex;
 
-  // . Image
+  // . Image : as the buffers, the ones touched by the transfer queue are also used on the others
+  auto const uFamilies  = getUniqueQueueFamilies(*device.pGpu);
+  bool const concurrent = (usage & VK_IMAGE_USAGE_TRANSFER_DST_BIT) and uFamilies.size() > 1;
   VkImageCreateInfo const imageCI {
-    .sType       = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
-    .imageType   = VK_IMAGE_TYPE_2D,
-    .format      = format,
-    .extent      = { extent2D.width, extent2D.height, 1 },
-    .mipLevels   = 1,
-    .arrayLayers = 1,
-    .samples     = samples,
-    .tiling      = VK_IMAGE_TILING_OPTIMAL,
-    .usage       = usage,
+    .sType                 = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+    .imageType             = VK_IMAGE_TYPE_2D,
+    .format                = format,
+    .extent                = { extent2D.width, extent2D.height, 1 },
+    .mipLevels             = 1,
+    .arrayLayers           = 1,
+    .samples               = samples,
+    .tiling                = VK_IMAGE_TILING_OPTIMAL,
+    .usage                 = usage,
+    .sharingMode           = concurrent ? VK_SHARING_MODE_CONCURRENT : VK_SHARING_MODE_EXCLUSIVE,
+    .queueFamilyIndexCount = concurrent ? GetCountU32(uFamilies) : 0,
+    .pQueueFamilyIndices   = concurrent ? GetData(uFamilies) : nullptr,
   };
-  VkCheck(vkCreateImage(device, &imageCI, nullptr, &tex.image));
+  VkCheck(vkCreateImage(device.handle, &imageCI, nullptr, &tex.image));
 
   // . Memory
-  VkMemoryRequirements memReqs {};
-  vkGetImageMemoryRequirements(device, tex.image, &memReqs);
-  VkMemoryAllocateInfo const memAlloc {
-    .sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
-    .allocationSize  = memReqs.size,
-    .memoryTypeIndex = vonk::getMemoryType(memProps, memReqs.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT),
-  };
-  VkCheck(vkAllocateMemory(device, &memAlloc, nullptr, &tex.memory));
-  VkCheck(vkBindImageMemory(device, tex.image, tex.memory, 0));
+  tex.allocation =
+    vonk::allocateImageMemory(*device.pAllocator, tex.image, category, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
 
   // . View : add stencil bit if is depth texture and the format allows
   bool const needStencilBit = (VK_IMAGE_ASPECT_DEPTH_BIT & aspectMaskBits) && format >= VK_FORMAT_D16_UNORM_S8_UINT;
@@ -482,23 +639,36 @@ Texture_t createTexture(
     .subresourceRange.layerCount     = 1,
     .subresourceRange.aspectMask     = aspectMaskBits | stencilBit,
   };
-  VkCheck(vkCreateImageView(device, &imageViewCI, nullptr, &tex.view));
+  VkCheck(vkCreateImageView(device.handle, &imageViewCI, nullptr, &tex.view));
+
+  return tex;
+}
+
+//-------------------------------------
 
+Texture_t createTexture(Device_t const &device, VkExtent2D const &extent2D, VkFormat format, DataInfo_t texels)
+{
+  auto const usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+  auto       tex   = vonk::createTexture(
+    device, MemoryCategory_t::Texture, extent2D, format, VK_SAMPLE_COUNT_1_BIT, usage, VK_IMAGE_ASPECT_COLOR_BIT);
+
+  // . Non-blocking : the graphics queue waits on the uploader's timeline
+  vonk::uploadImage(*device.pUploader, texels, tex.image, extent2D);
   return tex;
 }
 
 //-------------------------------------
 
-void destroyTexture(VkDevice device, Texture_t const &tex)
+void destroyTexture(Device_t const &device, Texture_t &tex)
 {
-  vkDestroyImageView(device, tex.view, nullptr);
-  vkFreeMemory(device, tex.memory, nullptr);
-  vkDestroyImage(device, tex.image, nullptr);
+  vkDestroyImageView(device.handle, tex.view, nullptr);
+  vkDestroyImage(device.handle, tex.image, nullptr);
+  vonk::freeMemory(*device.pAllocator, tex.allocation);
 }
 
 //-------------------------------------
 
-bool isEmptyTexture(Texture_t const &tex) { return !tex.view or !tex.memory or !tex.image; }
+bool isEmptyTexture(Texture_t const &tex) { return !tex.view or !tex.allocation.memory or !tex.image; }
 
 //-------------------------------------
 
@@ -550,7 +720,7 @@ void destroySwapChain(SwapChain_t &swapchain, bool justForRecreation)
   Device_t const &device = *swapchain.pDevice;
 
   // . Defaults : DepthTexture, FrameBuffers, ImageViews
-  vonk::destroyTexture(device.handle, swapchain.defaultDepthTexture);
+  vonk::destroyTexture(device, swapchain.defaultDepthTexture);
   for (auto framebuffer : swapchain.defaultFrameBuffers) { vkDestroyFramebuffer(device.handle, framebuffer, nullptr); }
   for (auto imageView : swapchain.views) { vkDestroyImageView(device.handle, imageView, nullptr); }
 
@@ -727,12 +897,12 @@ SwapChain_t createSwapChain(Device_t const &device, SwapChain_t oldSwapChain)
 
   // . Setup default framebuffers' depth-stencil if needed
   swapchain.defaultDepthTexture = vonk::createTexture(
-    device.handle,
-    gpu.memory,
+    device,
+    MemoryCategory_t::Attachment,
     swapchain.extent2D,
     swapchain.depthFormat,
     VK_SAMPLE_COUNT_1_BIT,
-    VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
+    VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,  // Sampled : see 'createDepthPyramid'
     VK_IMAGE_ASPECT_DEPTH_BIT);
 
   // . Setup default framebuffers
@@ -987,11 +1157,19 @@ DrawPipeline_t createPipeline(
       .pScissors     = GetData(ci.scissors),
     };
 
+    // . Vertex input : the pipeline's own, or the whole vertex / the positions of the arena's layout
+    auto const *vertexInput = ci.pVertexInput;
+    if (!vertexInput) {
+      auto const format = ci.vertexFormat;
+      vertexInput       = ci.positionsOnly and pipeline.useMeshes ? InputStatePositions(format, ci.splitStreams)
+                                                                  : InputStateVertex(!pipeline.useMeshes, format, ci.splitStreams);
+    }
+
     VkGraphicsPipelineCreateInfo const graphicsPipelineCI {
       .sType               = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
       .stageCount          = GetCountU32(pipeline.stagesCI),
       .pStages             = GetData(pipeline.stagesCI),
-      .pVertexInputState   = InputStateVertex(!pipeline.useMeshes),
+      .pVertexInputState   = vertexInput,
       .pInputAssemblyState = InputStateAssembly(),
       .pViewportState      = &viewportStateCI,
       .pRasterizationState = &rasterizationStateCI,
@@ -1011,28 +1189,6 @@ DrawPipeline_t createPipeline(
   // Commands !
 
   auto const createPipeline_commands = [&]() {
-    // . Set Viewports and Scissors.
-    // NOTE_1: If the Viewport size is negative, read it as percentage of current swapchain-size
-    // NOTE_2: If the Scissor size is UINT32_MAX, set the current swapchain-size
-    float const             swapH = swapchain.extent2D.height;
-    float const             swapW = swapchain.extent2D.width;
-    std::vector<VkViewport> viewports;
-    viewports.reserve(ci.viewports.size());
-    for (auto const &viewport : ci.viewports) {
-      auto &v = viewports.emplace_back(viewport);
-      if (v.x < 0) { v.x = swapW * (-viewport.x * 0.005f); }
-      if (v.y < 0) { v.y = swapH * (-viewport.y * 0.005f); }
-      if (v.width < 0) { v.width = swapW * (-viewport.width * 0.01f); }
-      if (v.height < 0) { v.height = swapH * (-viewport.height * 0.01f); }
-    }
-    std::vector<VkRect2D> scissors;
-    scissors.reserve(ci.scissors.size());
-    for (auto const &scissor : ci.scissors) {
-      auto &s = scissors.emplace_back(scissor);
-      if (s.extent.height == UINT32_MAX) { s.extent.height = swapH; }
-      if (s.extent.width == UINT32_MAX) { s.extent.width = swapW; }
-    }
-
     // // . Set framebuffers
     // if (useAsOutput) {
     //   pipeline.frameBuffers.resize(swapchain.views.size());
@@ -1062,61 +1218,1453 @@ DrawPipeline_t createPipeline(
     };
     VkCheck(vkAllocateCommandBuffers(device, &commandBufferAllocInfo, GetData(pipeline.commandBuffers)));
 
-    // . Commad Buffers Recording
-    for (auto const &commandBuffesData : ci.commandBuffersData) {
-      VkCommandBufferBeginInfo const commandBufferBI {
+    // . Commad Buffers Recording : once, replayed every frame
+    VkCommandBufferBeginInfo const commandBufferBI {
+      .sType            = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+      .flags            = VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT,  // @DANI : Review
+      .pInheritanceInfo = nullptr,                                       // Optional
+    };
+    for (size_t i = 0; i < pipeline.commandBuffers.size(); ++i) {
+      auto const commandBuffer = pipeline.commandBuffers[i];
+      VkCheck(vkBeginCommandBuffer(commandBuffer, &commandBufferBI));
+      recordPipelineCommands(commandBuffer, pipeline, ci, swapchain, frameBuffers.at(i));  // pipeline.frameBuffers[i];
+      VkCheck(vkEndCommandBuffer(commandBuffer));
+    }
+  };
+
+  if (oldPipelineHandle == VK_NULL_HANDLE) { createPipeline_pipeline(); }
+  pipeline.recordPerFrame = ci.recordPerFrame;
+  if (not ci.recordPerFrame and ci.graphPass == UINT32_MAX) { createPipeline_commands(); }
+
+  return pipeline;
+}
+
+//-------------------------------------
+
+void destroyPipeline(SwapChain_t const &swapchain, DrawPipeline_t const &pipeline)
+{
+  auto const &device = swapchain.pDevice->handle;
+
+  vkDestroyPipeline(device, pipeline.handle, nullptr);
+  vkDestroyPipelineLayout(device, pipeline.layout, nullptr);
+  // . The render pass is borrowed : the swapchain's, or a render graph pass's
+}
+
+//-------------------------------------
+
+// . Set Viewports and Scissors.
+// NOTE_1: If the Viewport size is negative, read it as percentage of current swapchain-size
+// NOTE_2: If the Scissor size is UINT32_MAX, set the current swapchain-size
+static void setPipelineViewports(
+  DrawPipelineData_t const & ci,
+  SwapChain_t const &        swapchain,
+  std::vector<VkViewport> &  viewports,
+  std::vector<VkRect2D> &    scissors)
+{
+  float const swapH = swapchain.extent2D.height;
+  float const swapW = swapchain.extent2D.width;
+  viewports.reserve(ci.viewports.size());
+  for (auto const &viewport : ci.viewports) {
+    auto &v = viewports.emplace_back(viewport);
+    if (v.x < 0) { v.x = swapW * (-viewport.x * 0.005f); }
+    if (v.y < 0) { v.y = swapH * (-viewport.y * 0.005f); }
+    if (v.width < 0) { v.width = swapW * (-viewport.width * 0.01f); }
+    if (v.height < 0) { v.height = swapH * (-viewport.height * 0.01f); }
+  }
+  scissors.reserve(ci.scissors.size());
+  for (auto const &scissor : ci.scissors) {
+    auto &s = scissors.emplace_back(scissor);
+    if (s.extent.height == UINT32_MAX) { s.extent.height = swapH; }
+    if (s.extent.width == UINT32_MAX) { s.extent.width = swapW; }
+  }
+}
+
+void recordPipelineCommands(
+  VkCommandBuffer            cmd,
+  DrawPipeline_t const &     pipeline,
+  DrawPipelineData_t const & ci,
+  SwapChain_t const &        swapchain,
+  VkFramebuffer              frameBuffer,
+  FrameCommands_t *          pFrame)
+{
+  std::vector<VkViewport> viewports;
+  std::vector<VkRect2D>   scissors;
+  setPipelineViewports(ci, swapchain, viewports, scissors);
+
+  for (auto const &commandBuffesData : ci.commandBuffersData) {
+    std::vector<VkClearValue> const clearValues { { .color = commandBuffesData.clearColor },
+                                                  { .depthStencil = commandBuffesData.clearDephtStencil } };
+
+    VkRenderPassBeginInfo const renderpassBI {
+      .sType           = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
+      .renderPass      = pipeline.renderpass,  // with multiple renderpasses use commandBuffesData.renderPassIdx
+      .framebuffer     = frameBuffer,
+      .clearValueCount = GetCountU32(clearValues),
+      .pClearValues    = GetData(clearValues),
+      // ?? Use this both for blitting.
+      .renderArea.offset = { 0, 0 },
+      .renderArea.extent = swapchain.extent2D,
+    };
+
+    // . Split : each worker records its chunk into its own secondary, the primary only runs them
+    auto const split = commandBuffesData.chunkCommands and pFrame and not pFrame->workerPools.empty();
+    if (split) {
+      auto const secondaries = nextFrameSecondaries(swapchain.pDevice->handle, *pFrame);
+      auto const chunkCount  = GetCountU32(secondaries);
+
+      VkCommandBufferInheritanceInfo const inheritanceInfo {
+        .sType       = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO,
+        .renderPass  = pipeline.renderpass,
+        .subpass     = 0,
+        .framebuffer = frameBuffer,
+      };
+      VkCommandBufferBeginInfo const secondaryBI {
         .sType            = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
-        .flags            = VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT,  // @DANI : Review
-        .pInheritanceInfo = nullptr,                                       // Optional
+        .flags            = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT,
+        .pInheritanceInfo = &inheritanceInfo,
       };
+      vo::jobs::parallelFor(chunkCount, [&](size_t i) {
+        auto const secondary = secondaries[i];
+        VkCheck(vkBeginCommandBuffer(secondary, &secondaryBI));
+        // . Nothing is inherited but the pass : the state is set again on each one
+        vkCmdBindPipeline(secondary, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline.handle);
+        vkCmdSetViewport(secondary, 0, GetCountU32(viewports), GetData(viewports));
+        vkCmdSetScissor(secondary, 0, GetCountU32(scissors), GetData(scissors));
+        if (i == 0 and commandBuffesData.commands) { commandBuffesData.commands(secondary); }
+        commandBuffesData.chunkCommands(secondary, static_cast<uint32_t>(i), chunkCount);
+        VkCheck(vkEndCommandBuffer(secondary));
+      });
+
+      vkCmdBeginRenderPass(cmd, &renderpassBI, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+      vkCmdExecuteCommands(cmd, chunkCount, GetData(secondaries));
+      vkCmdEndRenderPass(cmd);
+      continue;
+    }
 
-      std::vector<VkClearValue> const clearValues { { .color = commandBuffesData.clearColor },
-                                                    { .depthStencil = commandBuffesData.clearDephtStencil } };
-
-      VkRenderPassBeginInfo renderpassBI {
-        .sType           = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
-        .renderPass      = pipeline.renderpass,  // with multiple renderpasses use commandBuffesData.renderPassIdx
-        .clearValueCount = GetCountU32(clearValues),
-        .pClearValues    = GetData(clearValues),
-        // ?? Use this both for blitting.
-        .renderArea.offset = { 0, 0 },
-        .renderArea.extent = swapchain.extent2D,
-      };
+    vkCmdBeginRenderPass(cmd, &renderpassBI, VK_SUBPASS_CONTENTS_INLINE);
 
-      for (size_t i = 0; i < pipeline.commandBuffers.size(); ++i) {
-        auto const commandBuffer = pipeline.commandBuffers[i];
-        renderpassBI.framebuffer = frameBuffers.at(i);  // pipeline.frameBuffers[i];
-        VkCheck(vkBeginCommandBuffer(commandBuffer, &commandBufferBI));
-        vkCmdBeginRenderPass(commandBuffer, &renderpassBI, VK_SUBPASS_CONTENTS_INLINE);
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline.handle);
 
-        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline.handle);
+    vkCmdSetViewport(cmd, 0, GetCountU32(viewports), GetData(viewports));  // Dynamic Viewport
+    vkCmdSetScissor(cmd, 0, GetCountU32(scissors), GetData(scissors));     // Dynamic Scissors
 
-        vkCmdSetViewport(commandBuffer, 0, GetCountU32(viewports), GetData(viewports));  // Dynamic Viewport
-        vkCmdSetScissor(commandBuffer, 0, GetCountU32(scissors), GetData(scissors));     // Dynamic Scissors
+    if (commandBuffesData.commands) { commandBuffesData.commands(cmd); }
+    // . Not split (i.e. baked) : the chunks one after the other
+    if (commandBuffesData.chunkCommands) { commandBuffesData.chunkCommands(cmd, 0u, 1u); }
 
-        if (commandBuffesData.commands) { commandBuffesData.commands(commandBuffer); }
+    vkCmdEndRenderPass(cmd);
+  }
+}
 
-        vkCmdEndRenderPass(commandBuffer);
-        VkCheck(vkEndCommandBuffer(commandBuffer));
-      }
-    }
+//-------------------------------------
+
+void recordLateCommands(
+  VkCommandBuffer            cmd,
+  DrawPipeline_t const &     pipeline,
+  DrawPipelineData_t const & ci,
+  SwapChain_t const &        swapchain,
+  VkRenderPass               renderPass,
+  VkFramebuffer              frameBuffer)
+{
+  std::vector<VkViewport> viewports;
+  std::vector<VkRect2D>   scissors;
+  setPipelineViewports(ci, swapchain, viewports, scissors);
+
+  VkRenderPassBeginInfo const renderpassBI {
+    .sType             = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
+    .renderPass        = renderPass,
+    .framebuffer       = frameBuffer,
+    .renderArea.offset = { 0, 0 },
+    .renderArea.extent = swapchain.extent2D,
   };
+  vkCmdBeginRenderPass(cmd, &renderpassBI, VK_SUBPASS_CONTENTS_INLINE);
+  vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline.handle);
+  vkCmdSetViewport(cmd, 0, GetCountU32(viewports), GetData(viewports));
+  vkCmdSetScissor(cmd, 0, GetCountU32(scissors), GetData(scissors));
+  ci.lateCommands(cmd);
+  vkCmdEndRenderPass(cmd);
+}
 
-  if (oldPipelineHandle == VK_NULL_HANDLE) { createPipeline_pipeline(); }
-  createPipeline_commands();
+//-------------------------------------
+
+ComputePipeline_t createComputePipeline(
+  Device_t const &                      device,
+  Shader_t const &                      shader,
+  uint32_t                              bufferCount,
+  uint32_t                              pushConstantSize,
+  std::vector<VkDescriptorType> const & images)
+{
+  ComputePipeline_t pipeline;
+
+  // . Descriptors : one set, with its own pool, the buffers and images written later
+  auto const                                bindingCount = bufferCount + GetCountU32(images);
+  std::vector<VkDescriptorSetLayoutBinding> bindings(bindingCount);
+  std::vector<VkDescriptorPoolSize>         poolSizes { { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, std::max(bufferCount, 1u) } };
+  for (uint32_t i = 0; i < bindingCount; ++i) {
+    auto const type = i < bufferCount ? VK_DESCRIPTOR_TYPE_STORAGE_BUFFER : images[i - bufferCount];
+    bindings[i]     = VkDescriptorSetLayoutBinding {
+      .binding         = i,
+      .descriptorType  = type,
+      .descriptorCount = 1,
+      .stageFlags      = VK_SHADER_STAGE_COMPUTE_BIT,
+    };
+    if (i >= bufferCount) { poolSizes.push_back({ type, 1u }); }
+  }
+  VkDescriptorSetLayoutCreateInfo const setLayoutCI {
+    .sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+    .bindingCount = GetCountU32(bindings),
+    .pBindings    = GetData(bindings),
+  };
+  VkCheck(vkCreateDescriptorSetLayout(device.handle, &setLayoutCI, nullptr, &pipeline.setLayout));
+
+  VkDescriptorPoolCreateInfo const poolCI {
+    .sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+    .maxSets       = 1,
+    .poolSizeCount = GetCountU32(poolSizes),
+    .pPoolSizes    = GetData(poolSizes),
+  };
+  VkCheck(vkCreateDescriptorPool(device.handle, &poolCI, nullptr, &pipeline.pool));
+
+  VkDescriptorSetAllocateInfo const setAI {
+    .sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+    .descriptorPool     = pipeline.pool,
+    .descriptorSetCount = 1,
+    .pSetLayouts        = &pipeline.setLayout,
+  };
+  VkCheck(vkAllocateDescriptorSets(device.handle, &setAI, &pipeline.set));
+
+  // . Layout : the set plus the push constants, if any
+  VkPushConstantRange const pushRange { VK_SHADER_STAGE_COMPUTE_BIT, 0u, pushConstantSize };
+  VkPipelineLayoutCreateInfo const layoutCI {
+    .sType                  = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+    .setLayoutCount         = 1,
+    .pSetLayouts            = &pipeline.setLayout,
+    .pushConstantRangeCount = pushConstantSize > 0 ? 1u : 0u,
+    .pPushConstantRanges    = pushConstantSize > 0 ? &pushRange : nullptr,
+  };
+  VkCheck(vkCreatePipelineLayout(device.handle, &layoutCI, nullptr, &pipeline.layout));
+
+  VkComputePipelineCreateInfo const computePipelineCI {
+    .sType  = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+    .stage  = shader.stageCI,
+    .layout = pipeline.layout,
+  };
+  VkCheck(vkCreateComputePipelines(device.handle, VK_NULL_HANDLE, 1, &computePipelineCI, nullptr, &pipeline.handle));
 
   return pipeline;
 }
 
 //-------------------------------------
 
-void destroyPipeline(SwapChain_t const &swapchain, DrawPipeline_t const &pipeline)
+void bindComputeBuffers(Device_t const &device, ComputePipeline_t const &pipeline, std::vector<Buffer_t const *> const &buffers)
 {
-  auto const &device = swapchain.pDevice->handle;
+  std::vector<VkDescriptorBufferInfo> infos;
+  std::vector<VkWriteDescriptorSet>   writes;
+  infos.reserve(buffers.size());
+  writes.reserve(buffers.size());
+  for (uint32_t i = 0; i < buffers.size(); ++i) {
+    infos.push_back({ buffers[i]->handle, 0u, VK_WHOLE_SIZE });
+    writes.push_back(VkWriteDescriptorSet {
+      .sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+      .dstSet          = pipeline.set,
+      .dstBinding      = i,
+      .descriptorCount = 1,
+      .descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+      .pBufferInfo     = &infos.back(),
+    });
+  }
+  vkUpdateDescriptorSets(device.handle, GetCountU32(writes), GetData(writes), 0, nullptr);
+}
 
-  vkDestroyPipeline(device, pipeline.handle, nullptr);
-  vkDestroyPipelineLayout(device, pipeline.layout, nullptr);
-  if (pipeline.renderpass != swapchain.defaultRenderPass) vkDestroyRenderPass(device, pipeline.renderpass, nullptr);
+//-------------------------------------
+
+void bindComputeImage(
+  Device_t const &device, VkDescriptorSet set, uint32_t binding, VkDescriptorType type, VkDescriptorImageInfo const &info)
+{
+  VkWriteDescriptorSet const write {
+    .sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+    .dstSet          = set,
+    .dstBinding      = binding,
+    .descriptorCount = 1,
+    .descriptorType  = type,
+    .pImageInfo      = &info,
+  };
+  vkUpdateDescriptorSets(device.handle, 1, &write, 0, nullptr);
+}
+
+//-------------------------------------
+
+void destroyComputePipeline(Device_t const &device, ComputePipeline_t &pipeline)
+{
+  vkDestroyPipeline(device.handle, pipeline.handle, nullptr);
+  vkDestroyPipelineLayout(device.handle, pipeline.layout, nullptr);
+  vkDestroyDescriptorPool(device.handle, pipeline.pool, nullptr);
+  vkDestroyDescriptorSetLayout(device.handle, pipeline.setLayout, nullptr);
+  pipeline = ComputePipeline_t {};
+}
+
+//-------------------------------------
+
+//=============================================================================
+
+// === STAGING RING
+
+//-------------------------------------
+
+StagingRing_t createStagingRing(Device_t const &device, VkDeviceSize bytesPerFrame, uint32_t frameCount)
+{
+  StagingRing_t ring;
+
+  // . Every slice must be usable as copy source, uniform or storage range
+  auto const &limits = device.pGpu->properties.limits;
+  ring.alignment     = std::max({ ring.alignment,
+                              limits.minUniformBufferOffsetAlignment,
+                              limits.minStorageBufferOffsetAlignment,
+                              limits.optimalBufferCopyOffsetAlignment });
+  ring.frameSize     = (bytesPerFrame + ring.alignment - 1) / ring.alignment * ring.alignment;
+
+  auto const usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT
+                     | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT
+                     | VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
+  auto const props = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+  ring.buffer      = vonk::createBuffer(device, MemoryCategory_t::Staging, ring.frameSize, frameCount, usage, props);
+  ring.uploadTickets.assign(frameCount, 0u);
+
+  return ring;
+}
+
+//-------------------------------------
+
+void destroyStagingRing(Device_t const &device, StagingRing_t &ring)
+{
+  vonk::destroyBuffer(device, ring.buffer);
+  ring = StagingRing_t {};
+}
+
+//-------------------------------------
+
+void beginStagingFrame(StagingRing_t &ring, uint32_t frame, Uploader_t &uploader)
+{
+  ring.frame = frame % ring.buffer.count;
+  ring.head  = 0u;
+  vonk::waitUpload(uploader, ring.uploadTickets[ring.frame]);
+}
+
+//-------------------------------------
+
+StagingSlice_t allocateStaging(StagingRing_t &ring, VkDeviceSize size)
+{
+  auto const offset = (ring.head + ring.alignment - 1) / ring.alignment * ring.alignment;
+  if (size < 1 or offset + size > ring.frameSize) return {};
+
+  ring.head          = offset + size;
+  auto const global  = ring.frame * ring.frameSize + offset;
+  auto *const pBytes = static_cast<char *>(ring.buffer.allocation.pMapped);
+  return { ring.buffer.handle, global, size, pBytes + global };
+}
+
+//-------------------------------------
+
+//=============================================================================
+
+// === BUFFER UPDATEs
+
+//-------------------------------------
+
+void queueBufferUpdate(BufferUpdates_t &updates, Buffer_t const &dst, VkDeviceSize dstOffset, DataInfo_t di)
+{
+  auto const bytes = VkDeviceSize { di.elemSize } * di.count;
+  if (bytes < 1) return;
+  AbortIfMsg(dstOffset + bytes > dst.size, "Buffer update out of bounds!");
+
+  auto const dataOffset = updates.data.size();
+  updates.data.resize(dataOffset + bytes);
+  memcpy(updates.data.data() + dataOffset, di.data, bytes);
+  updates.writes.push_back({ dst.handle, dst.usage, dstOffset, bytes, dataOffset });
+}
+
+//-------------------------------------
+
+// . Stages and accesses a buffer's usage implies on the GPU side : what an update of it has to be ordered with
+static std::pair<VkPipelineStageFlags, VkAccessFlags> bufferReaders(VkBufferUsageFlags usage)
+{
+  VkPipelineStageFlags stages = 0u;
+  VkAccessFlags        access = 0u;
+  if (usage & VK_BUFFER_USAGE_VERTEX_BUFFER_BIT) {
+    stages |= VK_PIPELINE_STAGE_VERTEX_INPUT_BIT;
+    access |= VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT;
+  }
+  if (usage & VK_BUFFER_USAGE_INDEX_BUFFER_BIT) {
+    stages |= VK_PIPELINE_STAGE_VERTEX_INPUT_BIT;
+    access |= VK_ACCESS_INDEX_READ_BIT;
+  }
+  if (usage & VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT) {
+    stages |= VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT;
+    access |= VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+  }
+  if (usage & (VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT)) {
+    stages |= VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+    access |= VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_UNIFORM_READ_BIT;
+  }
+  // . Unknown readers : everything
+  if (stages == 0u) { return { VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_ACCESS_MEMORY_READ_BIT }; }
+  return { stages, access };
+}
+
+//-------------------------------------
+
+bool recordBufferUpdates(Device_t const &device, BufferUpdates_t &updates, StagingRing_t &ring, VkCommandBuffer cmd)
+{
+  // . The region's frame is done : so are the copies out of its overflow
+  updates.overflow.resize(ring.buffer.count);
+  auto &overflow = updates.overflow[ring.frame];
+  for (auto &staging : overflow) { vonk::destroyBuffer(device, staging); }
+  overflow.clear();
+
+  if (updates.writes.empty()) return false;
+
+  // . Coalesce : touching or overlapping ranges of the same buffer become a single copy
+  struct Span_t
+  {
+    VkBuffer           dst;
+    VkBufferUsageFlags usage;
+    VkDeviceSize       begin;
+    VkDeviceSize       end;
+  };
+  std::vector<Span_t> spans;
+  spans.reserve(updates.writes.size());
+  for (auto const &w : updates.writes) { spans.push_back({ w.dst, w.usage, w.dstOffset, w.dstOffset + w.size }); }
+  std::sort(spans.begin(), spans.end(), [](auto const &a, auto const &b) {
+    return a.dst != b.dst ? a.dst < b.dst : a.begin < b.begin;
+  });
+  std::vector<Span_t> merged;
+  for (auto const &span : spans) {
+    if (!merged.empty() and merged.back().dst == span.dst and span.begin <= merged.back().end) {
+      merged.back().end = std::max(merged.back().end, span.end);
+    } else {
+      merged.push_back(span);
+    }
+  }
+
+  // . Stage every merged span, replaying the writes in queue order so the newest bytes win
+  std::vector<StagingSlice_t> slices;
+  slices.reserve(merged.size());
+  for (auto const &span : merged) {
+    auto const bytes = span.end - span.begin;
+    auto       slice = vonk::allocateStaging(ring, bytes);
+    if (!slice.pData) {
+      // . Region full (big updates, or loads staged on it) : a buffer of its own, as the uploader does
+      auto const hostProps = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+      auto const staging   = vonk::createBuffer(
+        device, MemoryCategory_t::Staging, bytes, 1u, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, hostProps);
+      overflow.push_back(staging);
+      slice = { staging.handle, 0u, bytes, staging.allocation.pMapped };
+    }
+    slices.push_back(slice);
+  }
+  for (auto const &w : updates.writes) {
+    auto const it = std::find_if(merged.begin(), merged.end(), [&](auto const &span) {
+      return span.dst == w.dst and w.dstOffset >= span.begin and w.dstOffset + w.size <= span.end;
+    });
+    auto const &slice = slices[std::distance(merged.begin(), it)];
+    memcpy(static_cast<char *>(slice.pData) + (w.dstOffset - it->begin), updates.data.data() + w.dataOffset, w.size);
+  }
+
+  // . Barriers on the merged ranges alone, from / to the stages reading their buffers : the copies don't wait
+  //   on the whole previous frame, and the draws of this one only on the ranges they fetch
+  VkPipelineStageFlags               readers = 0u;
+  std::vector<VkBufferMemoryBarrier> before, after;
+  before.reserve(merged.size());
+  after.reserve(merged.size());
+  for (auto const &span : merged) {
+    auto const [stages, access] = bufferReaders(span.usage);
+    readers |= stages;
+    VkBufferMemoryBarrier barrier {
+      .sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+      .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+      .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+      .buffer              = span.dst,
+      .offset              = span.begin,
+      .size                = span.end - span.begin,
+    };
+    // . Previous frames' reads of the range must be done before overwriting it (WAR) : no memory to make visible
+    barrier.srcAccessMask = 0u;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    before.push_back(barrier);
+    // . And this frame's reads must see the new bytes (RAW)
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = access;
+    after.push_back(barrier);
+  }
+
+  vkCmdPipelineBarrier(
+    cmd, readers, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, GetCountU32(before), GetData(before), 0, nullptr);
+
+  for (size_t i = 0; i < merged.size(); ++i) {
+    VkBufferCopy const copyRegion {
+      .srcOffset = slices[i].offset,
+      .dstOffset = merged[i].begin,
+      .size      = merged[i].end - merged[i].begin,
+    };
+    vkCmdCopyBuffer(cmd, slices[i].buffer, merged[i].dst, 1, &copyRegion);
+  }
+
+  vkCmdPipelineBarrier(
+    cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, readers, 0, 0, nullptr, GetCountU32(after), GetData(after), 0, nullptr);
+
+  updates.writes.clear();
+  updates.data.clear();
+  return true;
+}
+
+//-------------------------------------
+
+void destroyBufferUpdates(Device_t const &device, BufferUpdates_t &updates)
+{
+  for (auto &overflow : updates.overflow) {
+    for (auto &staging : overflow) { vonk::destroyBuffer(device, staging); }
+  }
+  updates = BufferUpdates_t {};
+}
+
+//-------------------------------------
+
+//=============================================================================
+
+// === GEOMETRY ARENA
+
+//-------------------------------------
+
+static std::optional<uint32_t> takeRange(std::map<uint32_t, uint32_t> &freeRanges, uint32_t count)
+{
+  // . First fit : keeps the low part of the arena packed
+  for (auto it = freeRanges.begin(); it != freeRanges.end(); ++it) {
+    auto const [offset, available] = *it;
+    if (available < count) continue;
+
+    freeRanges.erase(it);
+    if (available > count) { freeRanges.emplace(offset + count, available - count); }
+    return offset;
+  }
+  return std::nullopt;
+}
+
+//-------------------------------------
+
+static void releaseRange(std::map<uint32_t, uint32_t> &freeRanges, uint32_t offset, uint32_t count)
+{
+  if (count < 1) return;
+
+  auto [it, _] = freeRanges.emplace(offset, count);
+
+  // . Merge with the next one
+  if (auto next = std::next(it); next != freeRanges.end() and it->first + it->second == next->first) {
+    it->second += next->second;
+    freeRanges.erase(next);
+  }
+  // . Merge with the previous one
+  if (it != freeRanges.begin()) {
+    if (auto prev = std::prev(it); prev->first + prev->second == it->first) {
+      prev->second += it->second;
+      freeRanges.erase(it);
+    }
+  }
+}
+
+//-------------------------------------
+
+GeometryArena_t createGeometryArena(
+  Device_t const &device,
+  uint32_t        maxVertices,
+  uint32_t        maxIndices,
+  VertexFormat_t  format,
+  bool            split,
+  uint32_t        maxMeshes,
+  uint32_t        maxMeshlets)
+{
+  GeometryArena_t arena;
+  arena.format         = format;
+  arena.split          = split;
+  arena.stride         = vonk::vertexStride(format, split);
+  arena.positionStride = vonk::positionStride(format, split);
+
+  auto const devProps = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+  auto const devPrefs = vonk::getUploadPreferredProps(*device.pGpu);
+  auto const idxUsage = VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
+  auto const vtxUsage = VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+
+  auto const category = MemoryCategory_t::Mesh;
+  arena.indices  = vonk::createBuffer(device, category, sizeof(uint32_t), maxIndices, idxUsage, devProps, devPrefs);
+  arena.vertices = vonk::createBuffer(device, category, arena.stride, maxVertices, vtxUsage, devProps, devPrefs);
+  if (split) {
+    auto const stride = arena.positionStride;
+    arena.positions   = vonk::createBuffer(device, category, stride, maxVertices, vtxUsage, devProps, devPrefs);
+  }
+
+  // . Meshlets : read by the cluster culling, which writes their draws
+  auto const mlUsage = VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+  auto const drUsage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT;
+  auto const drSize  = sizeof(VkDrawIndexedIndirectCommand);
+  arena.meshlets = vonk::createBuffer(device, category, sizeof(Meshlet_t), maxMeshlets, mlUsage, devProps, devPrefs);
+  arena.draws    = vonk::createBuffer(device, category, drSize, maxMeshlets, drUsage, devProps);
+
+  arena.freeIndices  = { { 0u, maxIndices } };
+  arena.freeVertices = { { 0u, maxVertices } };
+  arena.freeMeshlets = { { 0u, maxMeshlets } };
+
+  // . Packed : positions are relative to their mesh bounds, one slot per mesh
+  if (format == VertexFormat_t::Packed) {
+    arena.bounds = vonk::createBuffer(device, category, sizeof(MeshBounds_t), maxMeshes, vtxUsage, devProps, devPrefs);
+    arena.freeBounds.resize(maxMeshes);
+    for (uint32_t i = 0; i < maxMeshes; ++i) { arena.freeBounds[i] = maxMeshes - 1 - i; }
+  }
+
+  return arena;
+}
+
+//-------------------------------------
+
+void destroyGeometryArena(Device_t const &device, GeometryArena_t &arena)
+{
+  vonk::destroyBuffer(device, arena.indices);
+  vonk::destroyBuffer(device, arena.vertices);
+  if (arena.positions.handle) { vonk::destroyBuffer(device, arena.positions); }
+  if (arena.bounds.handle) { vonk::destroyBuffer(device, arena.bounds); }
+  vonk::destroyBuffer(device, arena.meshlets);
+  vonk::destroyBuffer(device, arena.draws);
+  arena = GeometryArena_t {};
+}
+
+//-------------------------------------
+
+void bindGeometryArena(VkCommandBuffer cmd, GeometryArena_t const &arena, bool positionsOnly)
+{
+  // . Same order as the layouts of 'InputStateVertex' / 'InputStatePositions'
+  std::array<VkBuffer, 3> buffers;
+  uint32_t                count = 0u;
+  if (arena.split) { buffers[count++] = arena.positions.handle; }
+  if (!arena.split or !positionsOnly) { buffers[count++] = arena.vertices.handle; }
+  if (arena.format == VertexFormat_t::Packed) { buffers[count++] = arena.bounds.handle; }
+
+  std::array<VkDeviceSize, 3> const offsets {};
+  vkCmdBindVertexBuffers(cmd, 0, count, GetData(buffers), GetData(offsets));
+  vkCmdBindIndexBuffer(cmd, arena.indices.handle, 0, VK_INDEX_TYPE_UINT32);
+}
+
+//-------------------------------------
+
+bool fitsGeometryArena(GeometryArena_t const &arena, uint32_t indexSlots, uint32_t vertexCount, uint32_t meshletCount)
+{
+  static auto const fits = [](std::map<uint32_t, uint32_t> const &freeRanges, uint32_t count) {
+    return count < 1 or std::any_of(freeRanges.begin(), freeRanges.end(), [count](auto const &r) { return r.second >= count; });
+  };
+  return fits(arena.freeIndices, indexSlots) and fits(arena.freeVertices, vertexCount)
+         and fits(arena.freeMeshlets, meshletCount);
+}
+
+//-------------------------------------
+
+//=============================================================================
+
+// === MESHes
+
+//-------------------------------------
+
+// . Packed meshes take a MeshBounds_t slot : their vertices are relative to it
+static void placeMeshBounds(Device_t const &device, GeometryArena_t &arena, MeshBounds_t const &bounds, Mesh_t &mesh)
+{
+  AbortIfMsg(arena.freeBounds.empty(), "Geometry arena is out of mesh bounds slots!");
+  mesh.bounds = arena.freeBounds.back();
+  arena.freeBounds.pop_back();
+
+  auto const dstOffset = VkDeviceSize { mesh.bounds } * sizeof(MeshBounds_t);
+  vonk::uploadBuffer(*device.pUploader, { sizeof(MeshBounds_t), 1u, &bounds }, arena.bounds, dstOffset);
+}
+
+//-------------------------------------
+
+// . Encodes in the arena's format and streams
+static void encodeMeshVertices(
+  Device_t const &             device,
+  GeometryArena_t &            arena,
+  std::vector<Vertex_t> const &vertices,
+  Mesh_t &                     mesh,
+  VertexStreams_t &            streams)
+{
+  if (vertices.empty()) return;
+
+  MeshBounds_t bounds;
+  if (arena.format == VertexFormat_t::Packed) {
+    bounds = vonk::computeBounds(vertices);
+    placeMeshBounds(device, arena, bounds, mesh);
+  }
+
+  vonk::encodeVertices(vertices, arena.format, arena.split, bounds, streams);
+}
+
+//-------------------------------------
+
+static void uploadVertexStreams(
+  Device_t const &       device,
+  GeometryArena_t const &arena,
+  VertexStreams_t const &streams,
+  uint32_t               firstVertex)
+{
+  auto &uploader = *device.pUploader;
+  vonk::uploadBuffer(uploader, GetDataInfo(streams.vertices), arena.vertices, firstVertex * VkDeviceSize { arena.stride });
+  if (arena.split) {
+    auto const dstOffset = firstVertex * VkDeviceSize { arena.positionStride };
+    vonk::uploadBuffer(uploader, GetDataInfo(streams.positions), arena.positions, dstOffset);
+  }
+}
+
+//-------------------------------------
+
+// . Picks the mesh's index type, places it from the arena slot 'firstSlot' and writes its indices in 'dst'
+static void encodeMeshIndices(std::vector<uint32_t> const &indices, Mesh_t &mesh, uint32_t firstSlot, uint32_t *dst)
+{
+  mesh.indexType  = vonk::meshIndexType(mesh.vertexCount);
+  mesh.firstIndex = firstSlot * (4u / vonk::indexSize(mesh.indexType));
+
+  if (mesh.indexType == VK_INDEX_TYPE_UINT16) {
+    auto *const dst16 = reinterpret_cast<uint16_t *>(dst);
+    for (size_t i = 0; i < indices.size(); ++i) { dst16[i] = static_cast<uint16_t>(indices[i]); }
+  } else {
+    std::copy(indices.begin(), indices.end(), dst);
+  }
+}
+
+//-------------------------------------
+
+// . Rebased as the mesh's draw, so the culling writes them as is : after its indices and vertices are placed
+static void
+  encodeMeshlets(std::span<Meshlet_t const> meshlets, Mesh_t &mesh, uint32_t firstMeshlet, std::vector<Meshlet_t> &dst)
+{
+  mesh.firstMeshlet = firstMeshlet;
+  mesh.meshletCount = static_cast<uint32_t>(meshlets.size());
+  for (auto meshlet : meshlets) {
+    meshlet.firstIndex += mesh.firstIndex;
+    meshlet.vertexOffset  = mesh.vertexOffset;
+    meshlet.firstInstance = mesh.bounds;
+    dst.push_back(meshlet);
+  }
+}
+
+//-------------------------------------
+
+// . Levels rebased as the mesh's indices, and the sphere their selection measures the distance to
+static void encodeMeshLods(MeshData_t const &data, Mesh_t &mesh)
+{
+  mesh.lodCount = 1u;
+  mesh.lods[0]  = { mesh.firstIndex, mesh.indexCount, 0.f };
+  if (!data.lods.empty()) {
+    mesh.lodCount = std::min(GetCountU32(data.lods), sMaxMeshLods);
+    for (uint32_t i = 0; i < mesh.lodCount; ++i) {
+      mesh.lods[i] = data.lods[i];
+      mesh.lods[i].firstIndex += mesh.firstIndex;
+    }
+  }
+
+  mesh.sphere = vonk::boundingSphere(vonk::computeBounds(data.vertices));
+}
+
+//-------------------------------------
+
+Mesh_t createMesh(Device_t const &device, GeometryArena_t &arena, MeshData_t const &data)
+{
+  auto const indexSlots   = vonk::meshIndexSlots(GetCountU32(data.indices), GetCountU32(data.vertices));
+  auto const firstSlot    = takeRange(arena.freeIndices, indexSlots);
+  auto const firstVertex  = takeRange(arena.freeVertices, GetCountU32(data.vertices));
+  auto const firstMeshlet = takeRange(arena.freeMeshlets, GetCountU32(data.meshlets));
+  AbortIfMsg(
+    !firstSlot.has_value() or !firstVertex.has_value() or !firstMeshlet.has_value(), "Geometry arena is full!");
+
+  Mesh_t mesh;
+  mesh.indexCount   = GetCountU32(data.indices);
+  mesh.vertexOffset = static_cast<int32_t>(firstVertex.value());
+  mesh.vertexCount  = GetCountU32(data.vertices);
+
+  std::vector<uint32_t> slots(indexSlots, 0u);
+  encodeMeshIndices(data.indices, mesh, firstSlot.value(), GetData(slots));
+  encodeMeshLods(data, mesh);
+
+  VertexStreams_t streams;
+  encodeMeshVertices(device, arena, data.vertices, mesh, streams);
+  vonk::uploadBuffer(*device.pUploader, GetDataInfo(slots), arena.indices, firstSlot.value() * sizeof(uint32_t));
+  uploadVertexStreams(device, arena, streams, firstVertex.value());
+
+  std::vector<Meshlet_t> placed;
+  encodeMeshlets(data.meshlets, mesh, firstMeshlet.value(), placed);
+  if (!placed.empty()) {
+    auto const dstOffset = firstMeshlet.value() * VkDeviceSize { sizeof(Meshlet_t) };
+    vonk::uploadBuffer(*device.pUploader, GetDataInfo(placed), arena.meshlets, dstOffset);
+  }
+
+  return mesh;
+}
+
+//-------------------------------------
+
+std::vector<Mesh_t>
+  createMeshes(Device_t const &device, GeometryArena_t &arena, std::vector<MeshData_t> const &meshesData)
+{
+  // . Totals
+  uint32_t indexSlots   = 0u;
+  uint32_t vertexCount  = 0u;
+  uint32_t meshletCount = 0u;
+  for (auto const &data : meshesData) {
+    indexSlots += vonk::meshIndexSlots(GetCountU32(data.indices), GetCountU32(data.vertices));
+    vertexCount += GetCountU32(data.vertices);
+    meshletCount += GetCountU32(data.meshlets);
+  }
+
+  // . One range for all of them : each mesh is a slice of it
+  auto const firstSlot   = takeRange(arena.freeIndices, indexSlots);
+  auto const firstVertex  = takeRange(arena.freeVertices, vertexCount);
+  auto const firstMeshlet = takeRange(arena.freeMeshlets, meshletCount);
+  AbortIfMsg(
+    !firstSlot.has_value() or !firstVertex.has_value() or !firstMeshlet.has_value(), "Geometry arena is full!");
+
+  std::vector<Mesh_t>    meshes;
+  std::vector<uint32_t>  slots(indexSlots, 0u);
+  VertexStreams_t        streams;
+  std::vector<Meshlet_t> meshlets;
+  meshes.reserve(meshesData.size());
+  meshlets.reserve(meshletCount);
+
+  uint32_t meshSlot   = 0u;
+  uint32_t meshVertex = firstVertex.value();
+  for (auto const &data : meshesData) {
+    Mesh_t mesh;
+    mesh.indexCount   = GetCountU32(data.indices);
+    mesh.vertexOffset = static_cast<int32_t>(meshVertex);
+    mesh.vertexCount  = GetCountU32(data.vertices);
+    meshVertex += mesh.vertexCount;
+
+    encodeMeshIndices(data.indices, mesh, firstSlot.value() + meshSlot, GetData(slots) + meshSlot);
+    meshSlot += vonk::meshIndexSlots(mesh.indexCount, mesh.vertexCount);
+    encodeMeshLods(data, mesh);
+
+    encodeMeshVertices(device, arena, data.vertices, mesh, streams);
+    encodeMeshlets(data.meshlets, mesh, firstMeshlet.value() + GetCountU32(meshlets), meshlets);
+    meshes.push_back(mesh);
+  }
+
+  // . Indices stay local to each mesh : 'vertexOffset' rebases them at draw time
+  vonk::uploadBuffer(*device.pUploader, GetDataInfo(slots), arena.indices, firstSlot.value() * sizeof(uint32_t));
+  uploadVertexStreams(device, arena, streams, firstVertex.value());
+  if (!meshlets.empty()) {
+    auto const dstOffset = firstMeshlet.value() * VkDeviceSize { sizeof(Meshlet_t) };
+    vonk::uploadBuffer(*device.pUploader, GetDataInfo(meshlets), arena.meshlets, dstOffset);
+  }
+
+  return meshes;
+}
+
+//-------------------------------------
+
+// . A mesh of the file, placed from its own 'firstSlot' / 'firstVertex' / 'firstMeshlet' of the arena
+static Mesh_t placeCookedMesh(
+  Device_t const &        device,
+  GeometryArena_t &       arena,
+  CookedMeshes_t const &  cooked,
+  uint32_t                index,
+  uint32_t                firstSlot,
+  uint32_t                firstVertex,
+  uint32_t                firstMeshlet,
+  std::vector<Meshlet_t> &meshlets)
+{
+  auto const &src = cooked.meshes[index];
+
+  Mesh_t mesh;
+  mesh.indexType    = vonk::meshIndexType(src.vertexCount);
+  mesh.firstIndex   = firstSlot * (4u / vonk::indexSize(mesh.indexType));
+  mesh.indexCount   = src.indexCount;
+  mesh.vertexOffset = static_cast<int32_t>(firstVertex);
+  mesh.vertexCount  = src.vertexCount;
+  if (arena.format == VertexFormat_t::Packed and src.vertexCount > 0) { placeMeshBounds(device, arena, src.bounds, mesh); }
+
+  mesh.lodCount = src.lodCount;
+  mesh.sphere   = src.sphere;
+  for (uint32_t i = 0; i < mesh.lodCount; ++i) {
+    mesh.lods[i] = src.lods[i];
+    mesh.lods[i].firstIndex += mesh.firstIndex;
+  }
+
+  auto const *srcMeshlets = reinterpret_cast<Meshlet_t const *>(cooked.payload(cooked.header->meshletsOffset));
+  encodeMeshlets({ srcMeshlets + src.firstMeshlet, src.meshletCount }, mesh, firstMeshlet, meshlets);
+  return mesh;
+}
+
+//-------------------------------------
+
+// . Straight from the mapping : 'count' vertices of the file from 'srcVertex', and their positions when split
+static void uploadCookedVertices(
+  Device_t const &       device,
+  GeometryArena_t const &arena,
+  CookedMeshes_t const & cooked,
+  uint32_t               srcVertex,
+  uint32_t               count,
+  uint32_t               firstVertex)
+{
+  auto &      uploader = *device.pUploader;
+  auto const &header   = *cooked.header;
+  auto const *vertices = cooked.payload(header.verticesOffset) + VkDeviceSize { srcVertex } * arena.stride;
+  vonk::uploadBuffer(uploader, { arena.stride, count, vertices }, arena.vertices, firstVertex * VkDeviceSize { arena.stride });
+  if (arena.split) {
+    auto const *positions = cooked.payload(header.positionsOffset) + VkDeviceSize { srcVertex } * arena.positionStride;
+    auto const  dstOffset = firstVertex * VkDeviceSize { arena.positionStride };
+    vonk::uploadBuffer(uploader, { arena.positionStride, count, positions }, arena.positions, dstOffset);
+  }
+}
+
+//-------------------------------------
+
+// . 'openCookedMeshes' already turned the other formats away : a mismatch here is a caller's bug
+static void checkCookedFormat(GeometryArena_t const &arena, CookedMeshes_t const &cooked)
+{
+  AbortIfMsg(
+    cooked.header->format != static_cast<uint32_t>(arena.format) or (cooked.header->split != 0u) != arena.split,
+    "Cooked meshes of another vertex format than the geometry arena's!");
+}
+
+//-------------------------------------
+
+std::vector<Mesh_t> createMeshes(Device_t const &device, GeometryArena_t &arena, CookedMeshes_t const &cooked)
+{
+  checkCookedFormat(arena, cooked);
+  auto const &header = *cooked.header;
+
+  // . One range for all of them, laid out as in the file : each payload is a single upload
+  auto const firstSlot    = takeRange(arena.freeIndices, header.indexSlots);
+  auto const firstVertex  = takeRange(arena.freeVertices, header.vertexCount);
+  auto const firstMeshlet = takeRange(arena.freeMeshlets, header.meshletCount);
+  AbortIfMsg(
+    !firstSlot.has_value() or !firstVertex.has_value() or !firstMeshlet.has_value(), "Geometry arena is full!");
+
+  std::vector<Mesh_t>    meshes;
+  std::vector<Meshlet_t> meshlets;
+  meshes.reserve(header.meshCount);
+  meshlets.reserve(header.meshletCount);
+  for (uint32_t i = 0; i < header.meshCount; ++i) {
+    auto const &src = cooked.meshes[i];
+    meshes.push_back(placeCookedMesh(
+      device,
+      arena,
+      cooked,
+      i,
+      firstSlot.value() + src.firstSlot,
+      firstVertex.value() + src.firstVertex,
+      firstMeshlet.value() + src.firstMeshlet,
+      meshlets));
+  }
+
+  auto const *indices = cooked.payload(header.indicesOffset);
+  vonk::uploadBuffer(
+    *device.pUploader, { sizeof(uint32_t), header.indexSlots, indices }, arena.indices, firstSlot.value() * sizeof(uint32_t));
+  uploadCookedVertices(device, arena, cooked, 0u, header.vertexCount, firstVertex.value());
+  if (!meshlets.empty()) {
+    auto const dstOffset = firstMeshlet.value() * VkDeviceSize { sizeof(Meshlet_t) };
+    vonk::uploadBuffer(*device.pUploader, GetDataInfo(meshlets), arena.meshlets, dstOffset);
+  }
+
+  return meshes;
+}
+
+//-------------------------------------
+
+Mesh_t createMesh(Device_t const &device, GeometryArena_t &arena, CookedMeshes_t const &cooked, uint32_t index)
+{
+  checkCookedFormat(arena, cooked);
+  auto const &src        = cooked.meshes[index];
+  auto const  indexSlots = vonk::meshIndexSlots(src.indexCount, src.vertexCount);
+
+  auto const firstSlot    = takeRange(arena.freeIndices, indexSlots);
+  auto const firstVertex  = takeRange(arena.freeVertices, src.vertexCount);
+  auto const firstMeshlet = takeRange(arena.freeMeshlets, src.meshletCount);
+  AbortIfMsg(
+    !firstSlot.has_value() or !firstVertex.has_value() or !firstMeshlet.has_value(), "Geometry arena is full!");
+
+  std::vector<Meshlet_t> meshlets;
+  auto const             mesh =
+    placeCookedMesh(device, arena, cooked, index, firstSlot.value(), firstVertex.value(), firstMeshlet.value(), meshlets);
+
+  auto const *indices = cooked.payload(cooked.header->indicesOffset) + VkDeviceSize { src.firstSlot } * sizeof(uint32_t);
+  vonk::uploadBuffer(
+    *device.pUploader, { sizeof(uint32_t), indexSlots, indices }, arena.indices, firstSlot.value() * sizeof(uint32_t));
+  uploadCookedVertices(device, arena, cooked, src.firstVertex, src.vertexCount, firstVertex.value());
+  if (!meshlets.empty()) {
+    auto const dstOffset = firstMeshlet.value() * VkDeviceSize { sizeof(Meshlet_t) };
+    vonk::uploadBuffer(*device.pUploader, GetDataInfo(meshlets), arena.meshlets, dstOffset);
+  }
+
+  return mesh;
+}
+
+//-------------------------------------
+
+void destroyMesh(GeometryArena_t &arena, Mesh_t &mesh)
+{
+  auto const perSlot = 4u / vonk::indexSize(mesh.indexType);
+  releaseRange(arena.freeIndices, mesh.firstIndex / perSlot, vonk::meshIndexSlots(mesh.indexCount, mesh.vertexCount));
+  releaseRange(arena.freeVertices, static_cast<uint32_t>(mesh.vertexOffset), mesh.vertexCount);
+  releaseRange(arena.freeMeshlets, mesh.firstMeshlet, mesh.meshletCount);
+  if (arena.format == VertexFormat_t::Packed and mesh.vertexCount > 0) { arena.freeBounds.push_back(mesh.bounds); }
+  mesh = Mesh_t {};
+}
+
+//-------------------------------------
+
+//=============================================================================
+
+// === CLUSTER CULLING
+
+//-------------------------------------
+
+ClusterCull_t clusterCull(glm::mat4 const &viewProj, glm::vec3 const &eye, bool cones)
+{
+  // . Gribb-Hartmann, from the rows of 'viewProj' : left, right, bottom, top, near (z >= 0) and far
+  auto const row = [&viewProj](int i) { return glm::vec4(viewProj[0][i], viewProj[1][i], viewProj[2][i], viewProj[3][i]); };
+
+  ClusterCull_t cull;
+  cull.planes[0] = row(3) + row(0);
+  cull.planes[1] = row(3) - row(0);
+  cull.planes[2] = row(3) + row(1);
+  cull.planes[3] = row(3) - row(1);
+  cull.planes[4] = row(2);
+  cull.planes[5] = row(3) - row(2);
+  for (auto &plane : cull.planes) {
+    auto const len = glm::length(glm::vec3(plane));
+    if (len > 0.f) { plane /= len; }
+  }
+  cull.eye = glm::vec4(eye, cones ? 1.f : 0.f);
+  return cull;
+}
+
+//-------------------------------------
+
+bool recordClusterCull(VkCommandBuffer cmd, ComputePipeline_t const &pipeline, GeometryArena_t const &arena, ClusterCull_t cull)
+{
+  // . Up to the last meshlet in use : the free tail of the arena is skipped
+  cull.meshletCount = arena.meshlets.count;
+  if (!arena.freeMeshlets.empty()) {
+    auto const &[offset, count] = *arena.freeMeshlets.rbegin();
+    if (offset + count == arena.meshlets.count) { cull.meshletCount = offset; }
+  }
+  if (cull.meshletCount < 1) return false;
+
+  // . The draws of the previous frames are done reading the commands before they get overwritten
+  VkMemoryBarrier const afterDraws {
+    .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+    .srcAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT,
+    .dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+  };
+  auto const drawStage    = VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT;
+  auto const computeStage = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+  vkCmdPipelineBarrier(cmd, drawStage, computeStage, 0, 1, &afterDraws, 0, nullptr, 0, nullptr);
+
+  vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline.handle);
+  vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline.layout, 0, 1, &pipeline.set, 0, nullptr);
+  vkCmdPushConstants(cmd, pipeline.layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(ClusterCull_t), &cull);
+  vkCmdDispatch(cmd, (cull.meshletCount + 63) / 64, 1, 1);
+
+  // . And this frame's draws read them once written
+  VkMemoryBarrier const beforeDraws {
+    .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+    .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+    .dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT,
+  };
+  vkCmdPipelineBarrier(cmd, computeStage, drawStage, 0, 1, &beforeDraws, 0, nullptr, 0, nullptr);
+  return true;
+}
+
+//-------------------------------------
+
+//=============================================================================
+
+// === DEPTH PYRAMID
+
+//-------------------------------------
+
+DepthPyramid_t createDepthPyramid(Device_t const &device, SwapChain_t const &swapchain, ComputePipeline_t const &pipeline)
+{
+  DepthPyramid_t pyramid;
+  pyramid.extent        = swapchain.extent2D;
+  auto const levelCount = static_cast<uint32_t>(std::bit_width(std::max(pyramid.extent.width, pyramid.extent.height)));
+  bool const stencil    = swapchain.depthFormat >= VK_FORMAT_D16_UNORM_S8_UINT;  // As 'createTexture'
+  pyramid.depthAspect   = VK_IMAGE_ASPECT_DEPTH_BIT | (stencil ? VK_IMAGE_ASPECT_STENCIL_BIT : 0u);
+
+  // . Image : every level written by its dispatch, then sampled by the next one and the occlusion tests
+  VkImageCreateInfo const imageCI {
+    .sType       = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+    .imageType   = VK_IMAGE_TYPE_2D,
+    .format      = VK_FORMAT_R32_SFLOAT,
+    .extent      = { pyramid.extent.width, pyramid.extent.height, 1 },
+    .mipLevels   = levelCount,
+    .arrayLayers = 1,
+    .samples     = VK_SAMPLE_COUNT_1_BIT,
+    .tiling      = VK_IMAGE_TILING_OPTIMAL,
+    .usage       = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+  };
+  VkCheck(vkCreateImage(device.handle, &imageCI, nullptr, &pyramid.image));
+  pyramid.allocation = vonk::allocateImageMemory(
+    *device.pAllocator, pyramid.image, MemoryCategory_t::Attachment, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+  // . Views : all the levels, each one alone, and the depth of the attachment without its stencil
+  auto const createView = [&device](VkImage image, VkFormat format, VkImageAspectFlags aspect, uint32_t level, uint32_t count) {
+    VkImageViewCreateInfo const imageViewCI {
+      .sType                           = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+      .viewType                        = VK_IMAGE_VIEW_TYPE_2D,
+      .image                           = image,
+      .format                          = format,
+      .subresourceRange.baseMipLevel   = level,
+      .subresourceRange.levelCount     = count,
+      .subresourceRange.baseArrayLayer = 0,
+      .subresourceRange.layerCount     = 1,
+      .subresourceRange.aspectMask     = aspect,
+    };
+    VkImageView view;
+    VkCheck(vkCreateImageView(device.handle, &imageViewCI, nullptr, &view));
+    return view;
+  };
+  pyramid.view = createView(pyramid.image, VK_FORMAT_R32_SFLOAT, VK_IMAGE_ASPECT_COLOR_BIT, 0u, levelCount);
+  for (uint32_t level = 0; level < levelCount; ++level) {
+    pyramid.levels.push_back(createView(pyramid.image, VK_FORMAT_R32_SFLOAT, VK_IMAGE_ASPECT_COLOR_BIT, level, 1u));
+  }
+  pyramid.depthView = createView(
+    swapchain.defaultDepthTexture.image, swapchain.depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT, 0u, 1u);
+
+  VkSamplerCreateInfo const samplerCI {
+    .sType        = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO,
+    .magFilter    = VK_FILTER_NEAREST,
+    .minFilter    = VK_FILTER_NEAREST,
+    .mipmapMode   = VK_SAMPLER_MIPMAP_MODE_NEAREST,
+    .addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+    .addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+    .addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+    .maxLod       = VK_LOD_CLAMP_NONE,
+  };
+  VkCheck(vkCreateSampler(device.handle, &samplerCI, nullptr, &pyramid.sampler));
+
+  // . Sets, one per level : the attachment -> level 0, then each level -> the next one
+  VkDescriptorPoolSize const poolSizes[] {
+    { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, levelCount },
+    { VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, levelCount },
+  };
+  VkDescriptorPoolCreateInfo const poolCI {
+    .sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+    .maxSets       = levelCount,
+    .poolSizeCount = 2,
+    .pPoolSizes    = poolSizes,
+  };
+  VkCheck(vkCreateDescriptorPool(device.handle, &poolCI, nullptr, &pyramid.pool));
+
+  std::vector<VkDescriptorSetLayout> const layouts(levelCount, pipeline.setLayout);
+  VkDescriptorSetAllocateInfo const        setAI {
+    .sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+    .descriptorPool     = pyramid.pool,
+    .descriptorSetCount = levelCount,
+    .pSetLayouts        = GetData(layouts),
+  };
+  pyramid.sets.resize(levelCount);
+  VkCheck(vkAllocateDescriptorSets(device.handle, &setAI, GetData(pyramid.sets)));
+
+  for (uint32_t level = 0; level < levelCount; ++level) {
+    auto const srcView   = level == 0 ? pyramid.depthView : pyramid.levels[level - 1];
+    auto const srcLayout = level == 0 ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_GENERAL;
+    auto const sampled   = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    auto const storage   = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    vonk::bindComputeImage(device, pyramid.sets[level], 0u, sampled, { pyramid.sampler, srcView, srcLayout });
+    vonk::bindComputeImage(
+      device, pyramid.sets[level], 1u, storage, { VK_NULL_HANDLE, pyramid.levels[level], VK_IMAGE_LAYOUT_GENERAL });
+  }
+  return pyramid;
+}
+
+//-------------------------------------
+
+void destroyDepthPyramid(Device_t const &device, DepthPyramid_t &pyramid)
+{
+  vkDestroyDescriptorPool(device.handle, pyramid.pool, nullptr);
+  vkDestroySampler(device.handle, pyramid.sampler, nullptr);
+  vkDestroyImageView(device.handle, pyramid.depthView, nullptr);
+  for (auto const view : pyramid.levels) { vkDestroyImageView(device.handle, view, nullptr); }
+  vkDestroyImageView(device.handle, pyramid.view, nullptr);
+  vkDestroyImage(device.handle, pyramid.image, nullptr);
+  vonk::freeMemory(*device.pAllocator, pyramid.allocation);
+  pyramid = DepthPyramid_t {};
+}
+
+//-------------------------------------
+
+bool prepareDepthPyramid(VkCommandBuffer cmd, DepthPyramid_t &pyramid)
+{
+  if (pyramid.prepared) return false;
+  pyramid.prepared = true;
+
+  VkImageMemoryBarrier const general {
+    .sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+    .srcAccessMask       = 0u,
+    .dstAccessMask       = VK_ACCESS_SHADER_READ_BIT,
+    .oldLayout           = VK_IMAGE_LAYOUT_UNDEFINED,
+    .newLayout           = VK_IMAGE_LAYOUT_GENERAL,
+    .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+    .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+    .image               = pyramid.image,
+    .subresourceRange    = { VK_IMAGE_ASPECT_COLOR_BIT, 0u, GetCountU32(pyramid.levels), 0u, 1u },
+  };
+  auto const computeStage = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+  vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, computeStage, 0, 0, nullptr, 0, nullptr, 1, &general);
+  return true;
+}
+
+//-------------------------------------
+
+void recordDepthPyramid(VkCommandBuffer cmd, ComputePipeline_t const &pipeline, DepthPyramid_t const &pyramid, VkImage depth)
+{
+  auto const fragmentTests = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+  auto const computeStage  = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+  auto const levelCount    = GetCountU32(pyramid.levels);
+
+  // . The depth is read once written, and the levels rewritten once the previous occlusion tests are done with them
+  VkImageMemoryBarrier const before[] {
+    {
+      .sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+      .srcAccessMask       = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+      .dstAccessMask       = VK_ACCESS_SHADER_READ_BIT,
+      .oldLayout           = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+      .newLayout           = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL,
+      .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+      .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+      .image               = depth,
+      .subresourceRange    = { pyramid.depthAspect, 0u, 1u, 0u, 1u },
+    },
+    {
+      .sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+      .srcAccessMask       = 0u,
+      .dstAccessMask       = VK_ACCESS_SHADER_WRITE_BIT,
+      .oldLayout           = VK_IMAGE_LAYOUT_UNDEFINED,
+      .newLayout           = VK_IMAGE_LAYOUT_GENERAL,
+      .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+      .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+      .image               = pyramid.image,
+      .subresourceRange    = { VK_IMAGE_ASPECT_COLOR_BIT, 0u, levelCount, 0u, 1u },
+    },
+  };
+  vkCmdPipelineBarrier(cmd, fragmentTests | computeStage, computeStage, 0, 0, nullptr, 0, nullptr, 2, before);
+
+  // . Level 0 the size of the attachment, each one after half the one above : down to a single texel
+  vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline.handle);
+  int32_t width  = static_cast<int32_t>(pyramid.extent.width);
+  int32_t height = static_cast<int32_t>(pyramid.extent.height);
+  for (uint32_t level = 0; level < levelCount; ++level) {
+    int32_t const sizes[4] = {
+      width, height, level == 0 ? width : std::max(width / 2, 1), level == 0 ? height : std::max(height / 2, 1)
+    };
+    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline.layout, 0, 1, &pyramid.sets[level], 0, nullptr);
+    vkCmdPushConstants(cmd, pipeline.layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(sizes), sizes);
+    vkCmdDispatch(cmd, (sizes[2] + 7) / 8, (sizes[3] + 7) / 8, 1);
+    width  = sizes[2];
+    height = sizes[3];
+
+    // . Read by the next level, or by the occlusion tests after the last one
+    VkMemoryBarrier const written {
+      .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+      .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+      .dstAccessMask = VK_ACCESS_SHADER_READ_BIT,
+    };
+    vkCmdPipelineBarrier(cmd, computeStage, computeStage, 0, 1, &written, 0, nullptr, 0, nullptr);
+  }
+
+  // . And back to an attachment, for the render pass after : tested, or cleared and drawn again
+  VkImageMemoryBarrier const after {
+    .sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+    .srcAccessMask       = 0u,
+    .dstAccessMask       = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+    .oldLayout           = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL,
+    .newLayout           = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+    .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+    .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+    .image               = depth,
+    .subresourceRange    = { pyramid.depthAspect, 0u, 1u, 0u, 1u },
+  };
+  vkCmdPipelineBarrier(cmd, computeStage, fragmentTests, 0, 0, nullptr, 0, nullptr, 1, &after);
+}
+
+//-------------------------------------
+
+//=============================================================================
+
+// === INSTANCE DRAWS
+
+//-------------------------------------
+
+InstanceDraws_t createInstanceDraws(Device_t const &device, uint32_t maxInstances, uint32_t maxMeshes, uint32_t frameCount)
+{
+  auto const devProps  = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+  auto const hostProps = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+  auto const category  = MemoryCategory_t::Mesh;
+  auto const inUsage   = VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+  auto const drUsage   = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT;
+  auto const drSize    = sizeof(VkDrawIndexedIndirectCommand);
+  auto const counters  = InstanceDraws_t::sCounters;
+
+  // . Written through 'queueBufferUpdate', the draws, counts and retests only by the GPU (the counts cleared first)
+  InstanceDraws_t draws;
+  draws.meshes    = vonk::createBuffer(device, category, sizeof(DrawMesh_t), maxMeshes, inUsage, devProps);
+  draws.instances = vonk::createBuffer(device, category, sizeof(uint32_t), maxInstances, inUsage, devProps);
+  draws.draws     = vonk::createBuffer(device, category, drSize, 4u * maxInstances, drUsage, devProps);
+  draws.counts    = vonk::createBuffer(
+    device, category, sizeof(uint32_t), counters, drUsage | inUsage | VK_BUFFER_USAGE_TRANSFER_SRC_BIT, devProps);
+  draws.retest = vonk::createBuffer(device, category, sizeof(uint32_t), maxInstances, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, devProps);
+  draws.readback = vonk::createBuffer(
+    device, MemoryCategory_t::Staging, sizeof(uint32_t), counters * frameCount, VK_BUFFER_USAGE_TRANSFER_DST_BIT, hostProps);
+  std::memset(draws.readback.allocation.pMapped, 0, draws.readback.size);
+  return draws;
+}
+
+//-------------------------------------
+
+void destroyInstanceDraws(Device_t const &device, InstanceDraws_t &draws)
+{
+  vonk::destroyBuffer(device, draws.meshes);
+  vonk::destroyBuffer(device, draws.instances);
+  vonk::destroyBuffer(device, draws.draws);
+  vonk::destroyBuffer(device, draws.counts);
+  vonk::destroyBuffer(device, draws.retest);
+  vonk::destroyBuffer(device, draws.readback);
+  draws = InstanceDraws_t {};
+}
+
+//-------------------------------------
+
+DrawMesh_t drawMeshOf(Mesh_t const &mesh, bool packed)
+{
+  DrawMesh_t dm;
+  dm.sphere       = mesh.sphere;
+  dm.vertexOffset = mesh.vertexOffset;
+  dm.lodCount     = std::max(mesh.lodCount, 1u);
+  for (uint32_t l = 0; l < dm.lodCount; ++l) {
+    dm.firstIndex[l] = mesh.lods[l].firstIndex;
+    dm.indexCount[l] = mesh.lods[l].indexCount;
+    dm.lodError[l]   = mesh.lods[l].error;
+  }
+  dm.firstInstance = packed ? mesh.bounds : UINT32_MAX;
+  dm.list          = mesh.indexType == VK_INDEX_TYPE_UINT16 ? 1u : 0u;
+  return dm;
+}
+
+//-------------------------------------
+
+InstanceCull_t instanceCull(glm::mat4 const &viewProj, glm::vec3 const &eye, float pixelsPerUnit, float maxPixels)
+{
+  InstanceCull_t ic;
+  ic.viewProj  = viewProj;
+  ic.lod       = glm::vec4(eye, pixelsPerUnit);
+  ic.maxPixels = maxPixels;
+  return ic;
+}
+
+//-------------------------------------
+
+bool recordInstanceCull(
+  VkCommandBuffer          cmd,
+  ComputePipeline_t const &pipeline,
+  InstanceDraws_t const &  draws,
+  InstanceCull_t           cull,
+  DepthPyramid_t const *   pPyramid)
+{
+  cull.instanceCount = draws.instanceCount;
+  cull.capacity      = draws.instances.count;
+  cull.pyramidSize   = pPyramid ? glm::vec2(pPyramid->extent.width, pPyramid->extent.height) : glm::vec2(0.f);
+  cull.pyramidLevels = pPyramid ? GetCountU32(pPyramid->levels) : 0u;
+  if (cull.instanceCount < 1) return false;
+
+  auto const drawStage     = VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT;
+  auto const transferStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+  auto const computeStage  = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+  if (cull.phase == 0) {
+    // . The previous frames are done with the commands, counts and retests before they get overwritten : their
+    //   draws, stats copies and second phases
+    VkMemoryBarrier const afterDraws {
+      .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+      .srcAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT,
+      .dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+    };
+    auto const previous = drawStage | transferStage | computeStage;
+    vkCmdPipelineBarrier(cmd, previous, transferStage | computeStage, 0, 1, &afterDraws, 0, nullptr, 0, nullptr);
+    vkCmdFillBuffer(cmd, draws.counts.handle, 0u, VK_WHOLE_SIZE, 0u);
+
+    // . The cleared counts, and the instances / meshes 'recordBufferUpdates' copied this frame
+    VkMemoryBarrier const afterCopies {
+      .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+      .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+      .dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+    };
+    vkCmdPipelineBarrier(cmd, transferStage, computeStage, 0, 1, &afterCopies, 0, nullptr, 0, nullptr);
+  } else {
+    // . Phase 1 : the counts and retests of phase 0, kept
+    VkMemoryBarrier const afterPhase0 {
+      .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+      .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+      .dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+    };
+    vkCmdPipelineBarrier(cmd, computeStage, computeStage, 0, 1, &afterPhase0, 0, nullptr, 0, nullptr);
+  }
+
+  vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline.handle);
+  vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline.layout, 0, 1, &pipeline.set, 0, nullptr);
+  vkCmdPushConstants(cmd, pipeline.layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(InstanceCull_t), &cull);
+  vkCmdDispatch(cmd, (cull.instanceCount + 63) / 64, 1, 1);
+
+  // . And this frame's draws read them once written
+  VkMemoryBarrier const beforeDraws {
+    .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+    .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+    .dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT,
+  };
+  vkCmdPipelineBarrier(cmd, computeStage, drawStage, 0, 1, &beforeDraws, 0, nullptr, 0, nullptr);
+  return true;
+}
+
+//-------------------------------------
+
+void recordInstanceStats(VkCommandBuffer cmd, InstanceDraws_t const &draws, uint32_t frame)
+{
+  // . Once the culling of the frame is done counting, and visible to the host once its fence is
+  auto const transferStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+  VkMemoryBarrier const counted {
+    .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+    .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+    .dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT,
+  };
+  vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, transferStage, 0, 1, &counted, 0, nullptr, 0, nullptr);
+
+  VkBufferCopy const region { 0u, VkDeviceSize { frame } * draws.counts.size, draws.counts.size };
+  vkCmdCopyBuffer(cmd, draws.counts.handle, draws.readback.handle, 1, &region);
+
+  VkMemoryBarrier const copied {
+    .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+    .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+    .dstAccessMask = VK_ACCESS_HOST_READ_BIT,
+  };
+  vkCmdPipelineBarrier(cmd, transferStage, VK_PIPELINE_STAGE_HOST_BIT, 0, 1, &copied, 0, nullptr, 0, nullptr);
+}
+
+//-------------------------------------
+
+InstanceStats_t readInstanceStats(InstanceDraws_t const &draws, uint32_t frame)
+{
+  // . As 'assets/shaders/instance_cull.comp' counts them : 4 lists, retest, frustum, occluded
+  auto *const counts = static_cast<uint32_t *>(draws.readback.allocation.pMapped) + frame * InstanceDraws_t::sCounters;
+
+  InstanceStats_t stats;
+  stats.frustum   = counts[5];
+  stats.occluded  = counts[6];
+  stats.late      = counts[2] + counts[3];
+  stats.instances = counts[0] + counts[1] + stats.late + stats.frustum + stats.occluded;
+  std::memset(counts, 0, InstanceDraws_t::sCounters * sizeof(uint32_t));
+  return stats;
 }
 
 //-------------------------------------
@@ -3,6 +3,9 @@
 
 #include "Utils.h"
 
+#include <algorithm>
+#include <string_view>
+
 namespace vonk
 {  //
 
@@ -10,14 +13,48 @@ namespace vonk
 
 uint32_t
   getMemoryType(VkPhysicalDeviceMemoryProperties memProps, uint32_t typeBits, VkMemoryPropertyFlags requestedProps)
+{
+  if (auto const memoryType = findMemoryType(memProps, typeBits, requestedProps); memoryType.has_value()) {
+    return memoryType.value();
+  }
+  Abort("Couldn't get requested memory properties");
+  return 0;
+}
+
+//-----------------------------------------------
+
+std::optional<uint32_t>
+  findMemoryType(VkPhysicalDeviceMemoryProperties const &memProps, uint32_t typeBits, VkMemoryPropertyFlags requestedProps)
 {
   for (uint32_t i = 0; i < memProps.memoryTypeCount; i++) {
     bool const propsMatch = (memProps.memoryTypes[i].propertyFlags & requestedProps) == requestedProps;
     if ((typeBits & 1) == 1 && propsMatch) { return i; }
     typeBits >>= 1;
   }
-  Abort("Couldn't get requested memory properties");
-  return 0;
+  return std::nullopt;
+}
+
+//-----------------------------------------------
+
+bool hasHostVisibleVram(VkPhysicalDeviceMemoryProperties const &memProps)
+{
+  // . UMA / ReBAR : the host can write the biggest device-local heap, not just the small 256MB BAR window
+  auto const vramProps = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+  auto const hostProps = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+
+  VkDeviceSize biggestVram = 0u;
+  for (uint32_t i = 0; i < memProps.memoryHeapCount; i++) {
+    if (memProps.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) {
+      biggestVram = std::max(biggestVram, memProps.memoryHeaps[i].size);
+    }
+  }
+
+  for (uint32_t i = 0; i < memProps.memoryTypeCount; i++) {
+    auto const &type = memProps.memoryTypes[i];
+    if ((type.propertyFlags & (vramProps | hostProps)) != (vramProps | hostProps)) continue;
+    if (memProps.memoryHeaps[type.heapIndex].size >= biggestVram) return true;
+  }
+  return false;
 }
 
 //-----------------------------------------------
@@ -53,8 +90,9 @@ SurfaceSupport_t getSurfaceSupport(VkPhysicalDevice gpu, VkSurfaceKHR surface)
                         VK_FORMAT_D16_UNORM }) {
     VkFormatProperties formatProps;
     vkGetPhysicalDeviceFormatProperties(gpu, format, &formatProps);
-    // Format must support depth stencil attachment for optimal tiling
-    if (formatProps.optimalTilingFeatures & VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT) { SS.depthFormat = format; }
+    // Format must support depth stencil attachment for optimal tiling, and be sampled for the depth pyramid
+    auto const required = VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT;
+    if ((formatProps.optimalTilingFeatures & required) == required) { SS.depthFormat = format; }
   }
 
   return SS;
@@ -79,6 +117,20 @@ bool checkGpuExtensionsSupport(Gpu_t const &gpu)
 
 //-----------------------------------------------
 
+bool checkGpuExtensionSupport(VkPhysicalDevice gpu, char const *ext)
+{
+  uint32_t count;
+  vkEnumerateDeviceExtensionProperties(gpu, nullptr, &count, nullptr);
+  std::vector<VkExtensionProperties> available(count);
+  vkEnumerateDeviceExtensionProperties(gpu, nullptr, &count, available.data());
+
+  return std::any_of(available.begin(), available.end(), [ext](auto const &item) {
+    return std::string_view { item.extensionName } == ext;
+  });
+}
+
+//-----------------------------------------------
+
 bool checkValidationLayersSupport(std::vector<char const *> const &layers)
 {
   if (layers.empty()) return true;
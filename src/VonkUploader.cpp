@@ -0,0 +1,324 @@
+#include "VonkUploader.h"
+#include "VonkResources.h"
+
+#include <chrono>
+
+namespace vonk
+{ //
+
+//=============================================================================
+
+// === HELPERs
+
+//-------------------------------------
+
+namespace
+{
+StagingSlice_t stageUpload(Uploader_t &uploader, DataInfo_t di)
+{
+    auto const &device = *uploader.pDevice;
+    auto       &batch  = uploader.recording;
+    auto const  bytes  = VkDeviceSize{di.elemSize} * di.count;
+
+    // . Open the batch on its first copy
+    if (!batch.cmd)
+    {
+        VkCommandBufferAllocateInfo const allocInfo{
+            .sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+            .commandPool        = uploader.pool,
+            .level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+            .commandBufferCount = 1,
+        };
+        VkCheck(vkAllocateCommandBuffers(device.handle, &allocInfo, &batch.cmd));
+
+        VkCommandBufferBeginInfo const beginInfo{
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+            .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+        };
+        VkCheck(vkBeginCommandBuffer(batch.cmd, &beginInfo));
+    }
+
+    // . Stage : on the frame ring when it has room, on a buffer of its own otherwise
+    auto *const ring  = uploader.pStagingRing;
+    auto        slice = ring ? vonk::allocateStaging(*ring, bytes) : StagingSlice_t{};
+    if (slice.pData)
+    {
+        ring->uploadTickets[ring->frame] = batch.ticket;
+    }
+    else
+    {
+        auto const hostUsage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+        auto const hostProps = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+        auto const category  = MemoryCategory_t::Staging;
+        auto const staging   = vonk::createBuffer(device, category, di.elemSize, di.count, hostUsage, hostProps);
+        batch.stagings.push_back(staging);
+        batch.stageBytes += bytes;
+        slice = {staging.handle, 0u, bytes, staging.allocation.pMapped};
+    }
+    memcpy(slice.pData, di.data, bytes);
+
+    uploader.stats.stagedCount += 1;
+    uploader.stats.stagedBytes += bytes;
+    return slice;
+}
+
+//---
+
+UploadTicket_t closeUpload(Uploader_t &uploader)
+{
+    // . Big batches go out right away, the rest wait for the next flush
+    auto      &batch  = uploader.recording;
+    auto const ticket = batch.ticket;
+    batch.copyCount += 1;
+    if (batch.copyCount >= Uploader_t::sMaxCopiesPerBatch || batch.stageBytes >= Uploader_t::sMaxBytesPerBatch)
+        flushUploads(uploader);
+
+    return ticket;
+}
+} // namespace
+
+//-------------------------------------
+
+//=============================================================================
+
+// === UPLOADER
+
+//-------------------------------------
+
+Uploader_t createUploader(Device_t const &device)
+{
+    auto const &gpu = *device.pGpu;
+    AbortIfMsg(!gpu.features12.timelineSemaphore, "Timeline semaphores are required by the uploader");
+
+    Uploader_t uploader;
+
+    // . Transfer queue when available, the graphics one otherwise
+    bool const hasTransfer = gpu.queueFamily.transfer.has_value();
+    auto const family      = hasTransfer ? gpu.queueFamily.transfer.value() : gpu.queueFamily.graphics.value();
+    uploader.queue         = hasTransfer ? device.queue.transfer : device.queue.graphics;
+    uploader.pool          = vonk::createCommandPool(device, family);
+
+    // . Timeline : its value is the last completed ticket
+    VkSemaphoreTypeCreateInfo const timelineCI{
+        .sType         = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+        .semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE,
+        .initialValue  = 0u,
+    };
+    VkSemaphoreCreateInfo const semaphoreCI{
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+        .pNext = &timelineCI,
+    };
+    VkCheck(vkCreateSemaphore(device.handle, &semaphoreCI, nullptr, &uploader.timeline));
+
+    uploader.recording.ticket = 1u;
+    uploader.pDevice          = &device;
+    return uploader;
+}
+
+//-------------------------------------
+
+void destroyUploader(Uploader_t &uploader)
+{
+    auto const device = uploader.pDevice->handle;
+
+    waitAllUploads(uploader);
+    vkDestroySemaphore(device, uploader.timeline, nullptr);
+    vkDestroyCommandPool(device, uploader.pool, nullptr);
+
+    uploader = Uploader_t{};
+}
+
+//-------------------------------------
+
+UploadTicket_t uploadBuffer(Uploader_t &uploader, DataInfo_t di, Buffer_t const &dst, VkDeviceSize dstOffset)
+{
+    auto const bytes = VkDeviceSize{di.elemSize} * di.count;
+    if (bytes < 1)
+        return uploader.completedTicket;
+
+    using Clock      = std::chrono::steady_clock;
+    using Seconds    = std::chrono::duration<double>;
+    auto const start = Clock::now();
+
+    // . Direct : the destination is host-visible (UMA / ReBAR), write it in place
+    if (dst.allocation.pMapped)
+    {
+        memcpy(static_cast<char *>(dst.allocation.pMapped) + dstOffset, di.data, bytes);
+        uploader.stats.directCount += 1;
+        uploader.stats.directBytes += bytes;
+        uploader.stats.directSeconds += Seconds(Clock::now() - start).count();
+        return uploader.completedTicket;
+    }
+
+    auto const slice = stageUpload(uploader, di);
+
+    // . Record the copy
+    VkBufferCopy const copyRegion{
+        .srcOffset = slice.offset,
+        .dstOffset = dstOffset,
+        .size      = bytes,
+    };
+    vkCmdCopyBuffer(uploader.recording.cmd, slice.buffer, dst.handle, 1, &copyRegion);
+
+    uploader.stats.stagedSeconds += Seconds(Clock::now() - start).count();
+    return closeUpload(uploader);
+}
+
+//-------------------------------------
+
+UploadTicket_t uploadImage(Uploader_t &uploader, DataInfo_t di, VkImage dst, VkExtent2D extent)
+{
+    if (VkDeviceSize{di.elemSize} * di.count < 1)
+        return uploader.completedTicket;
+
+    using Clock      = std::chrono::steady_clock;
+    using Seconds    = std::chrono::duration<double>;
+    auto const start = Clock::now();
+
+    // . Always staged : optimal tiling can't be written from the host
+    auto const slice = stageUpload(uploader, di);
+    auto const cmd   = uploader.recording.cmd;
+
+    // . Its previous content is dropped, then it is left for the shaders : the graphics queue waits on the ticket
+    VkImageMemoryBarrier barrier{
+        .sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+        .srcAccessMask       = 0u,
+        .dstAccessMask       = VK_ACCESS_TRANSFER_WRITE_BIT,
+        .oldLayout           = VK_IMAGE_LAYOUT_UNDEFINED,
+        .newLayout           = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .image               = dst,
+        .subresourceRange    = {VK_IMAGE_ASPECT_COLOR_BIT, 0u, 1u, 0u, 1u},
+    };
+    vkCmdPipelineBarrier(
+        cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+    VkBufferImageCopy const copyRegion{
+        .bufferOffset     = slice.offset,
+        .imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0u, 0u, 1u},
+        .imageExtent      = {extent.width, extent.height, 1u},
+    };
+    vkCmdCopyBufferToImage(cmd, slice.buffer, dst, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copyRegion);
+
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = 0u;
+    barrier.oldLayout     = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout     = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    vkCmdPipelineBarrier(
+        cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+    uploader.stats.stagedSeconds += Seconds(Clock::now() - start).count();
+    return closeUpload(uploader);
+}
+
+//-------------------------------------
+
+void flushUploads(Uploader_t &uploader)
+{
+    auto &batch = uploader.recording;
+    if (!batch.cmd)
+        return;
+
+    VkCheck(vkEndCommandBuffer(batch.cmd));
+
+    VkTimelineSemaphoreSubmitInfo const timelineSI{
+        .sType                     = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO,
+        .signalSemaphoreValueCount = 1,
+        .pSignalSemaphoreValues    = &batch.ticket,
+    };
+    VkSubmitInfo const submitInfo{
+        .sType                = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        .pNext                = &timelineSI,
+        .commandBufferCount   = 1,
+        .pCommandBuffers      = &batch.cmd,
+        .signalSemaphoreCount = 1,
+        .pSignalSemaphores    = &uploader.timeline,
+    };
+    VkCheck(vkQueueSubmit(uploader.queue, 1, &submitInfo, VK_NULL_HANDLE));
+
+    uploader.submittedTicket = batch.ticket;
+    uploader.inFlight.push_back(std::move(batch));
+    uploader.recording = UploadBatch_t{.ticket = uploader.submittedTicket + 1};
+}
+
+//-------------------------------------
+
+void pollUploads(Uploader_t &uploader)
+{
+    auto const &device = *uploader.pDevice;
+    VkCheck(vkGetSemaphoreCounterValue(device.handle, uploader.timeline, &uploader.completedTicket));
+
+    // . Release what the GPU is done with
+    while (!uploader.inFlight.empty() && uploader.inFlight.front().ticket <= uploader.completedTicket)
+    {
+        auto &batch = uploader.inFlight.front();
+        for (auto &staging : batch.stagings)
+            vonk::destroyBuffer(device, staging);
+        vkFreeCommandBuffers(device.handle, uploader.pool, 1, &batch.cmd);
+        uploader.inFlight.pop_front();
+    }
+}
+
+//-------------------------------------
+
+bool isUploadDone(Uploader_t &uploader, UploadTicket_t ticket)
+{
+    if (ticket > uploader.completedTicket)
+        pollUploads(uploader);
+    return ticket <= uploader.completedTicket;
+}
+
+//-------------------------------------
+
+void waitUpload(Uploader_t &uploader, UploadTicket_t ticket)
+{
+    if (ticket <= uploader.completedTicket)
+        return;
+
+    // . Still recording : it has to go out before waiting on it
+    if (ticket > uploader.submittedTicket)
+        flushUploads(uploader);
+
+    VkSemaphoreWaitInfo const waitInfo{
+        .sType          = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+        .semaphoreCount = 1,
+        .pSemaphores    = &uploader.timeline,
+        .pValues        = &ticket,
+    };
+    VkCheck(vkWaitSemaphores(uploader.pDevice->handle, &waitInfo, UINT64_MAX));
+    pollUploads(uploader);
+}
+
+//-------------------------------------
+
+void waitAllUploads(Uploader_t &uploader)
+{
+    flushUploads(uploader);
+    waitUpload(uploader, uploader.submittedTicket);
+}
+
+//-------------------------------------
+
+void logUploadStats(Uploader_t const &uploader)
+{
+    static auto const toMBps = [](VkDeviceSize bytes, double seconds) {
+        return seconds > 0.0 ? static_cast<double>(bytes) / (1024.0 * 1024.0) / seconds : 0.0;
+    };
+
+    auto const &stats = uploader.stats;
+    LogInfof(
+        "UPLOADS -> direct: {} ({}KB, {:.1f}MB/s) / staged: {} ({}KB, {:.1f}MB/s on cpu side)",
+        stats.directCount,
+        stats.directBytes / 1024,
+        toMBps(stats.directBytes, stats.directSeconds),
+        stats.stagedCount,
+        stats.stagedBytes / 1024,
+        toMBps(stats.stagedBytes, stats.stagedSeconds));
+}
+
+//-------------------------------------
+
+//=============================================================================
+
+} // namespace vonk
@@ -0,0 +1,160 @@
+#include "VonkVertex.h"
+
+#include <glm/gtc/packing.hpp>
+
+#include <cfloat>
+
+namespace vonk
+{ //
+
+//=============================================================================
+
+// === OCTAHEDRAL
+
+//-------------------------------------
+
+glm::vec2 octEncode(glm::vec3 n)
+{
+    auto const l1 = std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+    if (l1 <= 0.f)
+        return glm::vec2(0.f);
+
+    n /= l1;
+    auto e = glm::vec2(n.x, n.y);
+    if (n.z < 0.f)
+    {
+        // . Lower half : folded over the diagonals
+        auto const sign = glm::vec2(e.x >= 0.f ? 1.f : -1.f, e.y >= 0.f ? 1.f : -1.f);
+        e               = (1.f - glm::abs(glm::vec2(e.y, e.x))) * sign;
+    }
+    return e;
+}
+
+//-------------------------------------
+
+glm::vec3 octDecode(glm::vec2 e)
+{
+    auto       n = glm::vec3(e.x, e.y, 1.f - std::abs(e.x) - std::abs(e.y));
+    auto const t = std::max(-n.z, 0.f);
+    n.x += n.x >= 0.f ? -t : t;
+    n.y += n.y >= 0.f ? -t : t;
+    return glm::normalize(n);
+}
+
+//-------------------------------------
+
+//=============================================================================
+
+// === PACKING
+
+//-------------------------------------
+
+MeshBounds_t computeBounds(std::vector<Vertex_t> const &vertices)
+{
+    if (vertices.empty())
+        return {};
+
+    glm::vec3 lo(FLT_MAX), hi(-FLT_MAX);
+    for (auto const &v : vertices)
+    {
+        lo = glm::min(lo, v.vertex);
+        hi = glm::max(hi, v.vertex);
+    }
+    return {.min = lo, .extent = hi - lo};
+}
+
+//-------------------------------------
+
+PackedVertex_t packVertex(Vertex_t const &vertex, MeshBounds_t const &bounds)
+{
+    // . Flat axes (extent 0) decode to 'min' whatever is stored
+    auto const scale = glm::vec3(
+        bounds.extent.x > 0.f ? 1.f / bounds.extent.x : 0.f,
+        bounds.extent.y > 0.f ? 1.f / bounds.extent.y : 0.f,
+        bounds.extent.z > 0.f ? 1.f / bounds.extent.z : 0.f);
+    auto const unorm = glm::clamp((vertex.vertex - bounds.min) * scale, 0.f, 1.f);
+    auto const sign  = glm::dot(glm::cross(vertex.normal, vertex.tangent), vertex.bitangent) < 0.f ? 0.f : 1.f;
+
+    return {
+        .position = glm::packUnorm4x16(glm::vec4(unorm, sign)),
+        .uv       = glm::packHalf2x16(vertex.uv),
+        .normal   = glm::packSnorm2x16(octEncode(vertex.normal)),
+        .tangent  = glm::packSnorm2x16(octEncode(vertex.tangent)),
+        .color    = glm::packUnorm4x8(glm::vec4(glm::clamp(vertex.color, 0.f, 1.f), 1.f)),
+    };
+}
+
+//-------------------------------------
+
+std::vector<PackedVertex_t> packVertices(std::vector<Vertex_t> const &vertices, MeshBounds_t const &bounds)
+{
+    std::vector<PackedVertex_t> packed;
+    packed.reserve(vertices.size());
+    for (auto const &v : vertices)
+        packed.push_back(packVertex(v, bounds));
+    return packed;
+}
+
+//-------------------------------------
+
+Vertex_t unpackVertex(PackedVertex_t const &packed, MeshBounds_t const &bounds)
+{
+    auto const position = glm::unpackUnorm4x16(packed.position);
+
+    Vertex_t vertex;
+    vertex.vertex    = bounds.min + glm::vec3(position) * bounds.extent;
+    vertex.uv        = glm::unpackHalf2x16(packed.uv);
+    vertex.normal    = octDecode(glm::unpackSnorm2x16(packed.normal));
+    vertex.tangent   = octDecode(glm::unpackSnorm2x16(packed.tangent));
+    vertex.bitangent = glm::cross(vertex.normal, vertex.tangent) * (position.w * 2.f - 1.f);
+    vertex.color     = glm::vec3(glm::unpackUnorm4x8(packed.color));
+    return vertex;
+}
+
+//-------------------------------------
+
+void encodeVertices(
+    std::vector<Vertex_t> const &vertices,
+    VertexFormat_t               format,
+    bool                         split,
+    MeshBounds_t const          &bounds,
+    VertexStreams_t             &streams)
+{
+    auto const append = [](std::vector<char> &dst, auto const &value) {
+        auto const *bytes = reinterpret_cast<char const *>(&value);
+        dst.insert(dst.end(), bytes, bytes + sizeof(value));
+    };
+
+    streams.vertices.reserve(streams.vertices.size() + vertices.size() * vertexStride(format, split));
+    streams.positions.reserve(streams.positions.size() + vertices.size() * positionStride(format, split));
+
+    for (auto const &v : vertices)
+    {
+        if (format == VertexFormat_t::Packed)
+        {
+            auto const p = packVertex(v, bounds);
+            if (!split)
+            {
+                append(streams.vertices, p);
+                continue;
+            }
+            append(streams.positions, PackedPositionStream_t{p.position});
+            append(streams.vertices, PackedAttributeStream_t{p.uv, p.normal, p.tangent, p.color});
+        }
+        else if (split)
+        {
+            append(streams.positions, PositionStream_t{v.vertex});
+            append(streams.vertices, AttributeStream_t{v.uv, v.normal, v.tangent, v.bitangent, v.color});
+        }
+        else
+        {
+            append(streams.vertices, v);
+        }
+    }
+}
+
+//-------------------------------------
+
+//=============================================================================
+
+} // namespace vonk
@@ -0,0 +1,304 @@
+#include "VonkCooked.h"
+#include "VonkImport.h"
+#include "VonkMeshOps.h"
+
+#include "Macros.h"
+#include "Utils.h"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <json.hpp> // glTF buffers, for the hash
+
+//
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-
+// ::: COOKER
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-
+/*
+
+Cooks every glTF under the assets folder into 'Vonk::readCookedFile' files, one asset per worker thread.
+
+  Cooker [assetsDir = assets] [cookedDir = <assetsDir>/cooked] [options]
+    --level N   Optimization level, as 'read3DFile' (3)
+    --lods N    LOD levels, the base one included (4)
+    --uvs / --normals / --tangents   Regenerate them
+    --packed    Quantized 24-byte vertices, the arena has to be packed too
+    --split     Positions on their own stream, the arena has to be split too
+    --force     Cook everything again
+
+'<cookedDir>/manifest.txt' keeps, per source, the hash of its content (glTF buffers included) and of the
+settings it was cooked with : only the sources where any of them changed are cooked again.
+
+*/
+//-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-
+//
+
+namespace fs = std::filesystem;
+
+namespace
+{ //
+
+struct Settings_t
+{
+    uint32_t             optimizationLevel = 3u;
+    uint32_t             lodLevels         = vonk::sMaxMeshLods;
+    bool                 uvs               = false;
+    bool                 normals           = false;
+    bool                 tangents          = false;
+    vonk::VertexFormat_t format            = vonk::VertexFormat_t::Full;
+    bool                 split             = false;
+    bool                 force             = false;
+
+    // . What the output depends on : the cooked format version included
+    uint64_t hash() const
+    {
+        uint32_t const fields[] = {
+            vonk::sCookedVersion,
+            optimizationLevel,
+            lodLevels,
+            uvs,
+            normals,
+            tangents,
+            static_cast<uint32_t>(format),
+            split,
+        };
+        return vo::algo::hash64(fields, sizeof(fields));
+    }
+};
+
+struct Entry_t
+{
+    uint64_t contentHash  = 0u;
+    uint64_t settingsHash = 0u;
+};
+
+enum class Result_t
+{
+    UpToDate,
+    Cooked,
+    Failed,
+};
+
+//---
+
+// . Source, relative to the assets folder -> entry
+std::map<std::string, Entry_t> readManifest(fs::path const &path)
+{
+    std::map<std::string, Entry_t> manifest;
+    std::ifstream                  file{path};
+    std::string                    line;
+    while (std::getline(file, line))
+    {
+        if (line.empty() || line.front() == '#')
+            continue;
+
+        // . '<content> <settings> <source>' : the source last, it may have spaces
+        std::istringstream stream{line};
+        Entry_t            entry;
+        std::string        source;
+        stream >> std::hex >> entry.contentHash >> entry.settingsHash;
+        stream.ignore(1);
+        std::getline(stream, source);
+        if (stream && !source.empty())
+            manifest[source] = entry;
+    }
+    return manifest;
+}
+
+bool writeManifest(fs::path const &path, std::map<std::string, Entry_t> const &manifest)
+{
+    auto const tmpPath = fs::path{path}.concat(".tmp");
+    {
+        std::ofstream file{tmpPath, std::ios::trunc};
+        file << "# content settings source\n";
+        for (auto const &[source, entry] : manifest)
+            file << fmt::format("{:016x} {:016x} {}\n", entry.contentHash, entry.settingsHash, source);
+        if (!file)
+            return false;
+    }
+    std::error_code error;
+    fs::rename(tmpPath, path, error);
+    return !error;
+}
+
+//---
+
+// . The file and, for '.gltf', the external buffers it points to
+uint64_t hashSource(fs::path const &path)
+{
+    auto const mapping = vo::files::map(path.string());
+    auto       hash    = vo::algo::hash64(mapping.data(), mapping.size());
+    if (path.extension() != ".gltf" || !mapping)
+        return hash;
+
+    auto const gltf = nlohmann::json::parse(mapping.data(), mapping.data() + mapping.size(), nullptr, false);
+    if (gltf.is_discarded() || !gltf.contains("buffers"))
+        return hash;
+    for (auto const &buffer : gltf["buffers"])
+    {
+        auto const uri = buffer.value("uri", std::string{});
+        if (uri.empty() || uri.rfind("data:", 0) == 0)
+            continue;
+        auto const bin = vo::files::map((path.parent_path() / uri).string());
+        hash           = vo::algo::hash64(bin.data(), bin.size(), hash);
+    }
+    return hash;
+}
+
+//---
+
+fs::path cookedPathOf(fs::path const &cookedDir, std::string const &source)
+{
+    return fs::path{cookedDir / source}.concat(".vkm");
+}
+
+Result_t cook(fs::path const &assetsDir, fs::path const &cookedDir, std::string const &source, Settings_t const &settings)
+{
+    auto meshes = vonk::importGltf((assetsDir / source).string());
+    if (meshes.empty())
+        return Result_t::Failed;
+
+    vonk::prepareMeshes(
+        meshes,
+        settings.optimizationLevel,
+        settings.uvs,
+        settings.normals,
+        settings.tangents,
+        settings.lodLevels);
+
+    auto const      cookedPath = cookedPathOf(cookedDir, source);
+    std::error_code error;
+    fs::create_directories(cookedPath.parent_path(), error);
+    return vonk::cookMeshes(cookedPath.string(), meshes, settings.format, settings.split) ? Result_t::Cooked
+                                                                                         : Result_t::Failed;
+}
+
+} // namespace
+
+//---------------------------------------------------------------------------------------------------------------------
+
+int main(int argc, char **argv)
+{
+    using Clock      = std::chrono::steady_clock;
+    using Seconds    = std::chrono::duration<double>;
+    auto const start = Clock::now();
+
+    // === Arguments
+
+    Settings_t               settings;
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string const arg  = argv[i];
+        auto const        next = [&]() { return i + 1 < argc ? static_cast<uint32_t>(std::stoul(argv[++i])) : 0u; };
+        if (arg == "--level")
+            settings.optimizationLevel = next();
+        else if (arg == "--lods")
+            settings.lodLevels = std::max(next(), 1u);
+        else if (arg == "--uvs")
+            settings.uvs = true;
+        else if (arg == "--normals")
+            settings.normals = true;
+        else if (arg == "--tangents")
+            settings.tangents = true;
+        else if (arg == "--packed")
+            settings.format = vonk::VertexFormat_t::Packed;
+        else if (arg == "--split")
+            settings.split = true;
+        else if (arg == "--force")
+            settings.force = true;
+        else
+            paths.push_back(arg);
+    }
+    fs::path const assetsDir = paths.size() > 0 ? fs::path{paths[0]} : fs::path{"assets"};
+    fs::path const cookedDir = paths.size() > 1 ? fs::path{paths[1]} : assetsDir / "cooked";
+    if (!fs::is_directory(assetsDir))
+    {
+        LogErrorf("COOKER -> '{}' is not a folder", assetsDir.string());
+        return 1;
+    }
+
+    // === Scan : the cooked folder may live inside the assets one
+
+    std::vector<std::string> sources;
+    auto const               cookedAbs = fs::weakly_canonical(cookedDir);
+    for (auto it = fs::recursive_directory_iterator(assetsDir); it != fs::recursive_directory_iterator(); ++it)
+    {
+        if (it->is_directory() && fs::weakly_canonical(it->path()) == cookedAbs)
+        {
+            it.disable_recursion_pending();
+            continue;
+        }
+        auto ext = it->path().extension().string();
+        std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return std::tolower(c); });
+        if (it->is_regular_file() && (ext == ".gltf" || ext == ".glb"))
+            sources.push_back(fs::relative(it->path(), assetsDir).generic_string());
+    }
+    std::sort(sources.begin(), sources.end());
+
+    // === Cook : one source per worker thread, hashing included
+
+    auto const            manifestPath = cookedDir / "manifest.txt";
+    auto const            previous     = readManifest(manifestPath);
+    auto const            settingsHash = settings.hash();
+    std::vector<Entry_t>  entries(sources.size());
+    std::vector<Result_t> results(sources.size(), Result_t::Failed);
+
+    vo::jobs::parallelFor(sources.size(), [&](size_t i) {
+        auto const &source = sources[i];
+        entries[i]         = {hashSource(assetsDir / source), settingsHash};
+
+        auto const it = previous.find(source);
+        if (!settings.force && it != previous.end() && it->second.contentHash == entries[i].contentHash
+            && it->second.settingsHash == settingsHash && fs::exists(cookedPathOf(cookedDir, source)))
+        {
+            results[i] = Result_t::UpToDate;
+            return;
+        }
+        results[i] = cook(assetsDir, cookedDir, source, settings);
+        if (results[i] == Result_t::Failed)
+            LogErrorf("COOKER -> '{}' : failed", source);
+    });
+
+    // === Manifest : failed sources stay out, so the next run tries them again. Gone ones lose their output
+
+    std::map<std::string, Entry_t> manifest;
+    size_t                         counts[3] = {};
+    for (size_t i = 0; i < sources.size(); ++i)
+    {
+        ++counts[static_cast<size_t>(results[i])];
+        if (results[i] != Result_t::Failed)
+            manifest[sources[i]] = entries[i];
+    }
+    for (auto const &[source, entry] : previous)
+    {
+        if (!std::binary_search(sources.begin(), sources.end(), source))
+        {
+            std::error_code error;
+            fs::remove(cookedPathOf(cookedDir, source), error);
+        }
+    }
+
+    std::error_code error;
+    fs::create_directories(cookedDir, error);
+    if (!writeManifest(manifestPath, manifest))
+    {
+        LogErrorf("COOKER -> '{}' can't be written", manifestPath.string());
+        return 1;
+    }
+
+    LogInfof(
+        "COOKER -> {} sources : {} cooked, {} up to date, {} failed : {:.2f}s",
+        sources.size(),
+        counts[static_cast<size_t>(Result_t::Cooked)],
+        counts[static_cast<size_t>(Result_t::UpToDate)],
+        counts[static_cast<size_t>(Result_t::Failed)],
+        Seconds(Clock::now() - start).count());
+    return counts[static_cast<size_t>(Result_t::Failed)] > 0 ? 1 : 0;
+}